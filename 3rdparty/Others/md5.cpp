@@ -282,6 +282,34 @@ string md5(const void* dat, size_t len) {
     return res;
 }
 
+static_assert(sizeof(md5_state) >= sizeof(MD5_CTX), "md5_state is too small for MD5_CTX");
+
+void md5_init(md5_state* ctx) {
+    MD5_Init(reinterpret_cast<MD5_CTX*>(ctx));
+}
+
+void md5_update(md5_state* ctx, const void* dat, size_t len) {
+    const unsigned long max_chunk = 0x40000000; // MD5_Update takes 32-bit size on Windows
+    const unsigned char* ptr = static_cast<const unsigned char*>(dat);
+    while (len > 0) {
+        const unsigned long n = len > max_chunk ? max_chunk : static_cast<unsigned long>(len);
+        MD5_Update(reinterpret_cast<MD5_CTX*>(ctx), ptr, n);
+        ptr += n;
+        len -= n;
+    }
+}
+
+std::string md5_final(md5_state* ctx) {
+    string res;
+    unsigned char out[16];
+    MD5_Final(out, reinterpret_cast<MD5_CTX*>(ctx));
+    for(size_t i = 0; i < 16; ++ i) {
+        res.push_back(hb2hex(out[i] >> 4));
+        res.push_back(hb2hex(out[i]));
+    }
+    return res;
+}
+
 std::string md5(std::string dat){
 	return md5(dat.c_str(), dat.length());
 }
@@ -13,4 +13,17 @@ std::string md5file(std::FILE* file);
 std::string md5sum6(std::string dat);
 std::string md5sum6(const void* dat, size_t len);
 
+// Streaming (the data can be fed chunk by chunk)
+
+struct md5_state {
+	unsigned int lo, hi;
+	unsigned int a, b, c, d;
+	unsigned char buffer[64];
+	unsigned int block[16];
+};
+
+void md5_init(md5_state* ctx);
+void md5_update(md5_state* ctx, const void* dat, size_t len);
+std::string md5_final(md5_state* ctx);
+
 #endif // end of MD5_H
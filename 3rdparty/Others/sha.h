@@ -2,12 +2,14 @@
 #define SHA_H
 
 #include <cstdlib>
+#include <cstdint>
 
 // SHA-1
 
 namespace sha_1
 {
   void sha1(const void* data, size_t len, char* hash);
+  void sha1_iteration(const uint8_t* data, uint32_t h[]); // one 64-byte block
 } // sha1
 
 // SHA-2
@@ -20,6 +22,7 @@ namespace sha_2_224
 namespace sha_2_256
 {
   void sha2(const void* data, size_t len, char* hash);
+  void sha2_iteration(const uint8_t* data, uint32_t hi[]); // one 64-byte block
 } // sha_2_256
 
 namespace sha_2_384
@@ -30,6 +33,7 @@ namespace sha_2_384
 namespace sha_2_512
 {
   void sha2(const void* data, size_t len, char* hash);
+  void sha2_iteration(const uint8_t* data, uint64_t hi[]); // one 128-byte block
 } // sha_2_512
 
 // SHA-3
@@ -10,7 +10,7 @@ void sha3(const void* data, size_t len, char* hash)
 {
   sha3_state ctx = { 0 };
   sha3_init(&ctx, SHA3_224_DIGEST_SIZE);
-  sha3_update(&ctx, (uint8_t*)data, uint32_t(len));
+  sha3_update(&ctx, (const uint8_t*)data, len);
   sha3_final(&ctx, (uint8_t*)hash);
 }
 
@@ -23,7 +23,7 @@ void sha3(const void* data, size_t len, char* hash)
 {
   sha3_state ctx = { 0 };
   sha3_init(&ctx, SHA3_256_DIGEST_SIZE);
-  sha3_update(&ctx, (uint8_t*)data, uint32_t(len));
+  sha3_update(&ctx, (const uint8_t*)data, len);
   sha3_final(&ctx, (uint8_t*)hash);
 }
 
@@ -36,7 +36,7 @@ void sha3(const void* data, size_t len, char* hash)
 {
   sha3_state ctx = { 0 };
   sha3_init(&ctx, SHA3_384_DIGEST_SIZE);
-  sha3_update(&ctx, (uint8_t*)data, uint32_t(len));
+  sha3_update(&ctx, (const uint8_t*)data, len);
   sha3_final(&ctx, (uint8_t*)hash);
 }
 
@@ -49,7 +49,7 @@ void sha3(const void* data, size_t len, char* hash)
 {
   sha3_state ctx = { 0 };
   sha3_init(&ctx, SHA3_512_DIGEST_SIZE);
-  sha3_update(&ctx, (uint8_t*)data, uint32_t(len));
+  sha3_update(&ctx, (const uint8_t*)data, len);
   sha3_final(&ctx, (uint8_t*)hash);
 }
 
@@ -3,12 +3,18 @@
 	Written by Jeff Garzik <jeff@garzik.org> for module of GNU/Linux kernel from https://lwn.net/Articles/518415/
 	LICENSE GPL
 	Originally from linux-4.11/crypto/sha3_generic.c SHA3_256:9a0a3fecbb5a1791895a854ddaae802308f1e75ad42f6e973fa2a43f38e2216f
+	Modified: unrolled/lane-complemented permutation, 4-way AVX2, incremental absorb, SHAKE
+	The round layout & lane complementing follow the Keccak team's "Keccak implementation overview" (section 2.2)
 */
 
 #include <stdint.h>
 #include <string.h>
 #include "sha3_impl.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #define KECCAK_ROUNDS 24
 
 #define ROTL64(x, y) (((x) << (y)) | ((x) >> (64 - (y))))
@@ -21,120 +27,386 @@ static const uint64_t keccakf_rndc[24] =
 	0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
 };
 
-static const int keccakf_rotc[24] = 
+static inline uint64_t load64(const uint8_t* p)
 {
-	1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14, 
-	27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44
-};
+	uint64_t v;
+	memcpy(&v, p, sizeof(v)); // little-endian lanes, unaligned safe
+	return v;
+}
+
+/*
+	One round from the lanes A?? into the lanes E?? (Theta, Rho, Pi, Chi, Iota).
+	The lanes be, bi, go, ki, mi, sa are kept complemented, that turns most of the NOT of Chi into OR.
+*/
+#define KECCAK_ROUND(A, E, rc) \
+	Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+	Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+	Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+	Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+	Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+	Da = Cu ^ ROTL64(Ce, 1); \
+	De = Ca ^ ROTL64(Ci, 1); \
+	Di = Ce ^ ROTL64(Co, 1); \
+	Do = Ci ^ ROTL64(Cu, 1); \
+	Du = Co ^ ROTL64(Ca, 1); \
+	\
+	Ba = A##ba ^ Da; \
+	Be = ROTL64(A##ge ^ De, 44); \
+	Bi = ROTL64(A##ki ^ Di, 43); \
+	Bo = ROTL64(A##mo ^ Do, 21); \
+	Bu = ROTL64(A##su ^ Du, 14); \
+	E##ba = Ba ^ (Be | Bi) ^ (rc); \
+	E##be = Be ^ ((~Bi) | Bo); \
+	E##bi = Bi ^ (Bo & Bu); \
+	E##bo = Bo ^ (Bu | Ba); \
+	E##bu = Bu ^ (Ba & Be); \
+	\
+	Ba = ROTL64(A##bo ^ Do, 28); \
+	Be = ROTL64(A##gu ^ Du, 20); \
+	Bi = ROTL64(A##ka ^ Da, 3); \
+	Bo = ROTL64(A##me ^ De, 45); \
+	Bu = ROTL64(A##si ^ Di, 61); \
+	E##ga = Ba ^ (Be | Bi); \
+	E##ge = Be ^ (Bi & Bo); \
+	E##gi = Bi ^ (Bo | (~Bu)); \
+	E##go = Bo ^ (Bu | Ba); \
+	E##gu = Bu ^ (Ba & Be); \
+	\
+	Ba = ROTL64(A##be ^ De, 1); \
+	Be = ROTL64(A##gi ^ Di, 6); \
+	Bi = ROTL64(A##ko ^ Do, 25); \
+	Bo = ROTL64(A##mu ^ Du, 8); \
+	Bu = ROTL64(A##sa ^ Da, 18); \
+	E##ka = Ba ^ (Be | Bi); \
+	E##ke = Be ^ (Bi & Bo); \
+	E##ki = Bi ^ ((~Bo) & Bu); \
+	E##ko = (~Bo) ^ (Bu | Ba); \
+	E##ku = Bu ^ (Ba & Be); \
+	\
+	Ba = ROTL64(A##bu ^ Du, 27); \
+	Be = ROTL64(A##ga ^ Da, 36); \
+	Bi = ROTL64(A##ke ^ De, 10); \
+	Bo = ROTL64(A##mi ^ Di, 15); \
+	Bu = ROTL64(A##so ^ Do, 56); \
+	E##ma = Ba ^ (Be & Bi); \
+	E##me = Be ^ (Bi | Bo); \
+	E##mi = Bi ^ ((~Bo) | Bu); \
+	E##mo = (~Bo) ^ (Bu & Ba); \
+	E##mu = Bu ^ (Ba | Be); \
+	\
+	Ba = ROTL64(A##bi ^ Di, 62); \
+	Be = ROTL64(A##go ^ Do, 55); \
+	Bi = ROTL64(A##ku ^ Du, 39); \
+	Bo = ROTL64(A##ma ^ Da, 41); \
+	Bu = ROTL64(A##se ^ De, 2); \
+	E##sa = Ba ^ ((~Be) & Bi); \
+	E##se = (~Be) ^ (Bi | Bo); \
+	E##si = Bi ^ (Bo & Bu); \
+	E##so = Bo ^ (Bu | Ba); \
+	E##su = Bu ^ (Ba & Be);
 
-static const int keccakf_piln[24] = 
+#define KECCAK_LANES(P, OP, st) \
+	OP(P##ba, st[ 0]) OP(P##be, st[ 1]) OP(P##bi, st[ 2]) OP(P##bo, st[ 3]) OP(P##bu, st[ 4]) \
+	OP(P##ga, st[ 5]) OP(P##ge, st[ 6]) OP(P##gi, st[ 7]) OP(P##go, st[ 8]) OP(P##gu, st[ 9]) \
+	OP(P##ka, st[10]) OP(P##ke, st[11]) OP(P##ki, st[12]) OP(P##ko, st[13]) OP(P##ku, st[14]) \
+	OP(P##ma, st[15]) OP(P##me, st[16]) OP(P##mi, st[17]) OP(P##mo, st[18]) OP(P##mu, st[19]) \
+	OP(P##sa, st[20]) OP(P##se, st[21]) OP(P##si, st[22]) OP(P##so, st[23]) OP(P##su, st[24])
+
+#define LANE_LOAD(v, m)  v = m;
+#define LANE_STORE(v, m) m = v;
+
+// the lanes kept complemented inside the permutation
+#define KECCAK_COMPLEMENT(st) \
+	st[1] = ~st[1]; st[2] = ~st[2]; st[8] = ~st[8]; st[12] = ~st[12]; st[17] = ~st[17]; st[20] = ~st[20];
+
+// update the state with 24 rounds
+void keccakf1600(uint64_t st[25])
 {
-	10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4, 
-	15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1
-};
+	uint64_t Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku;
+	uint64_t Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+	uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+	uint64_t Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+	uint64_t Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+	int round;
+
+	KECCAK_COMPLEMENT(st)
+	KECCAK_LANES(A, LANE_LOAD, st)
+
+	for (round = 0; round < KECCAK_ROUNDS; round += 2) {
+		KECCAK_ROUND(A, E, keccakf_rndc[round + 0])
+		KECCAK_ROUND(E, A, keccakf_rndc[round + 1])
+	}
+
+	KECCAK_LANES(A, LANE_STORE, st)
+	KECCAK_COMPLEMENT(st)
+}
+
+#if defined(__AVX2__)
+
+/*
+	The same round over four states, lane j of the state k lives in the 64-bit element k of a 256-bit register.
+	ANDNOT is native here, so the 4-way round uses the plain Chi without lane complementing.
+*/
+
+#define V_XOR(a, b)   _mm256_xor_si256(a, b)
+#define V_ROTL(x, y)  _mm256_or_si256(_mm256_slli_epi64(x, y), _mm256_srli_epi64(x, 64 - (y)))
+#define V_CHI(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+
+#define KECCAK_ROUND_X4(A, E, rc) \
+	Ca = V_XOR(V_XOR(V_XOR(V_XOR(A##ba, A##ga), A##ka), A##ma), A##sa); \
+	Ce = V_XOR(V_XOR(V_XOR(V_XOR(A##be, A##ge), A##ke), A##me), A##se); \
+	Ci = V_XOR(V_XOR(V_XOR(V_XOR(A##bi, A##gi), A##ki), A##mi), A##si); \
+	Co = V_XOR(V_XOR(V_XOR(V_XOR(A##bo, A##go), A##ko), A##mo), A##so); \
+	Cu = V_XOR(V_XOR(V_XOR(V_XOR(A##bu, A##gu), A##ku), A##mu), A##su); \
+	Da = V_XOR(Cu, V_ROTL(Ce, 1)); \
+	De = V_XOR(Ca, V_ROTL(Ci, 1)); \
+	Di = V_XOR(Ce, V_ROTL(Co, 1)); \
+	Do = V_XOR(Ci, V_ROTL(Cu, 1)); \
+	Du = V_XOR(Co, V_ROTL(Ca, 1)); \
+	\
+	Ba = V_XOR(A##ba, Da); \
+	Be = V_ROTL(V_XOR(A##ge, De), 44); \
+	Bi = V_ROTL(V_XOR(A##ki, Di), 43); \
+	Bo = V_ROTL(V_XOR(A##mo, Do), 21); \
+	Bu = V_ROTL(V_XOR(A##su, Du), 14); \
+	E##ba = V_XOR(V_CHI(Ba, Be, Bi), _mm256_set1_epi64x((long long)(rc))); \
+	E##be = V_CHI(Be, Bi, Bo); \
+	E##bi = V_CHI(Bi, Bo, Bu); \
+	E##bo = V_CHI(Bo, Bu, Ba); \
+	E##bu = V_CHI(Bu, Ba, Be); \
+	\
+	Ba = V_ROTL(V_XOR(A##bo, Do), 28); \
+	Be = V_ROTL(V_XOR(A##gu, Du), 20); \
+	Bi = V_ROTL(V_XOR(A##ka, Da), 3); \
+	Bo = V_ROTL(V_XOR(A##me, De), 45); \
+	Bu = V_ROTL(V_XOR(A##si, Di), 61); \
+	E##ga = V_CHI(Ba, Be, Bi); \
+	E##ge = V_CHI(Be, Bi, Bo); \
+	E##gi = V_CHI(Bi, Bo, Bu); \
+	E##go = V_CHI(Bo, Bu, Ba); \
+	E##gu = V_CHI(Bu, Ba, Be); \
+	\
+	Ba = V_ROTL(V_XOR(A##be, De), 1); \
+	Be = V_ROTL(V_XOR(A##gi, Di), 6); \
+	Bi = V_ROTL(V_XOR(A##ko, Do), 25); \
+	Bo = V_ROTL(V_XOR(A##mu, Du), 8); \
+	Bu = V_ROTL(V_XOR(A##sa, Da), 18); \
+	E##ka = V_CHI(Ba, Be, Bi); \
+	E##ke = V_CHI(Be, Bi, Bo); \
+	E##ki = V_CHI(Bi, Bo, Bu); \
+	E##ko = V_CHI(Bo, Bu, Ba); \
+	E##ku = V_CHI(Bu, Ba, Be); \
+	\
+	Ba = V_ROTL(V_XOR(A##bu, Du), 27); \
+	Be = V_ROTL(V_XOR(A##ga, Da), 36); \
+	Bi = V_ROTL(V_XOR(A##ke, De), 10); \
+	Bo = V_ROTL(V_XOR(A##mi, Di), 15); \
+	Bu = V_ROTL(V_XOR(A##so, Do), 56); \
+	E##ma = V_CHI(Ba, Be, Bi); \
+	E##me = V_CHI(Be, Bi, Bo); \
+	E##mi = V_CHI(Bi, Bo, Bu); \
+	E##mo = V_CHI(Bo, Bu, Ba); \
+	E##mu = V_CHI(Bu, Ba, Be); \
+	\
+	Ba = V_ROTL(V_XOR(A##bi, Di), 62); \
+	Be = V_ROTL(V_XOR(A##go, Do), 55); \
+	Bi = V_ROTL(V_XOR(A##ku, Du), 39); \
+	Bo = V_ROTL(V_XOR(A##ma, Da), 41); \
+	Bu = V_ROTL(V_XOR(A##se, De), 2); \
+	E##sa = V_CHI(Ba, Be, Bi); \
+	E##se = V_CHI(Be, Bi, Bo); \
+	E##si = V_CHI(Bi, Bo, Bu); \
+	E##so = V_CHI(Bo, Bu, Ba); \
+	E##su = V_CHI(Bu, Ba, Be);
+
+#define LANE_LOAD_X4(v, j)  v = _mm256_set_epi64x((long long)st[3][j], (long long)st[2][j], (long long)st[1][j], (long long)st[0][j]);
+#define LANE_STORE_X4(v, j) _mm256_storeu_si256((__m256i*)t, v); st[0][j] = t[0]; st[1][j] = t[1]; st[2][j] = t[2]; st[3][j] = t[3];
 
-// update the state with given number of rounds
-static void keccakf(uint64_t st[25], int rounds)
+#define KECCAK_LANES_X4(P, OP) \
+	OP(P##ba,  0) OP(P##be,  1) OP(P##bi,  2) OP(P##bo,  3) OP(P##bu,  4) \
+	OP(P##ga,  5) OP(P##ge,  6) OP(P##gi,  7) OP(P##go,  8) OP(P##gu,  9) \
+	OP(P##ka, 10) OP(P##ke, 11) OP(P##ki, 12) OP(P##ko, 13) OP(P##ku, 14) \
+	OP(P##ma, 15) OP(P##me, 16) OP(P##mi, 17) OP(P##mo, 18) OP(P##mu, 19) \
+	OP(P##sa, 20) OP(P##se, 21) OP(P##si, 22) OP(P##so, 23) OP(P##su, 24)
+
+void keccakf1600_x4(uint64_t* st[4])
 {
-	int i, j, round;
-	uint64_t t, bc[5];
+	__m256i Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku;
+	__m256i Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+	__m256i Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+	__m256i Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+	__m256i Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+	uint64_t t[4];
+	int round;
 
-	for (round = 0; round < rounds; round++) {
+	KECCAK_LANES_X4(A, LANE_LOAD_X4)
 
-		// Theta
-		for (i = 0; i < 5; i++) {
-			bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
-		}
+	for (round = 0; round < KECCAK_ROUNDS; round += 2) {
+		KECCAK_ROUND_X4(A, E, keccakf_rndc[round + 0])
+		KECCAK_ROUND_X4(E, A, keccakf_rndc[round + 1])
+	}
 
-		for (i = 0; i < 5; i++) {
-			t = bc[(i + 4) % 5] ^ ROTL64(bc[(i + 1) % 5], 1);
-			for (j = 0; j < 25; j += 5) {
-				st[j + i] ^= t;
-			}
+	KECCAK_LANES_X4(A, LANE_STORE_X4)
+}
+
+#else  // __AVX2__
+
+void keccakf1600_x4(uint64_t* st[4])
+{
+	keccakf1600(st[0]);
+	keccakf1600(st[1]);
+	keccakf1600(st[2]);
+	keccakf1600(st[3]);
+}
+
+#endif // __AVX2__
+
+static void keccak_init(struct sha3_state *sctx, unsigned int capacity_sz, uint8_t pad)
+{
+	memset(sctx, 0, sizeof(*sctx));
+	sctx->rsiz = 200 - capacity_sz;
+	sctx->rsizw = sctx->rsiz / 8;
+	sctx->pad = pad;
+}
+
+// pad the last block & run the final permutation of the absorbing phase
+static void keccak_pad(struct sha3_state *sctx)
+{
+	uint8_t *st = (uint8_t *) sctx->st;
+
+	st[sctx->partial] ^= sctx->pad;
+	st[sctx->rsiz - 1] ^= 0x80;
+
+	keccakf1600(sctx->st);
+
+	sctx->partial = 0;
+	sctx->squeezing = 1;
+}
+
+void sha3_init(struct sha3_state *sctx, unsigned int digest_sz)
+{
+	keccak_init(sctx, 2 * digest_sz, SHA3_DOMAIN_PADDING);
+	sctx->md_len = digest_sz;
+}
+
+void sha3_update(struct sha3_state *sctx, const uint8_t *data, size_t len)
+{
+	uint8_t *st = (uint8_t *) sctx->st;
+	unsigned int i;
+
+	if (sctx->squeezing) {
+		return;
+	}
+
+	// complete the pending block first
+	if (sctx->partial) {
+		while (len != 0 && sctx->partial < sctx->rsiz) {
+			st[sctx->partial++] ^= *data++;
+			len--;
 		}
 
-		// Rho Pi
-		t = st[1];
-		for (i = 0; i < 24; i++) {
-			j = keccakf_piln[i];
-			bc[0] = st[j];
-			st[j] = ROTL64(t, keccakf_rotc[i]);
-			t = bc[0];
+		if (sctx->partial < sctx->rsiz) {
+			return;
 		}
 
-		//  Chi
-		for (j = 0; j < 25; j += 5) {
-			for (i = 0; i < 5; i++) {
-				bc[i] = st[j + i];
-			}
-			for (i = 0; i < 5; i++) {
-				st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
-			}
+		keccakf1600(sctx->st);
+		sctx->partial = 0;
+	}
+
+	// absorb the full blocks directly from the input
+	while (len >= sctx->rsiz) {
+		for (i = 0; i < sctx->rsizw; i++) {
+			sctx->st[i] ^= load64(data + 8 * i);
 		}
 
-		//  Iota
-		st[0] ^= keccakf_rndc[round];
+		keccakf1600(sctx->st);
+
+		data += sctx->rsiz;
+		len  -= sctx->rsiz;
 	}
+
+	// keep the tail in the state until the next call
+	for (i = 0; i < len; i++) {
+		st[i] ^= data[i];
+	}
+
+	sctx->partial = (unsigned int) len;
 }
 
-void sha3_init(struct sha3_state *sctx, unsigned int digest_sz)
+void sha3_final(struct sha3_state *sctx, uint8_t *out)
 {
+	if (!sctx->squeezing) {
+		keccak_pad(sctx);
+	}
+
+	memcpy(out, sctx->st, sctx->md_len);
+
 	memset(sctx, 0, sizeof(*sctx));
-	sctx->md_len = digest_sz;
-	sctx->rsiz = 200 - 2 * digest_sz;
-	sctx->rsizw = sctx->rsiz / 8;
 }
 
-void sha3_update(struct sha3_state *sctx, const uint8_t *data, unsigned int len)
+void sha3_x4(const uint8_t *data[4], const size_t len[4], unsigned int digest_sz, uint8_t *out[4])
 {
-	unsigned int done;
-	const uint8_t *src;
+	struct sha3_state ctx[4];
+	uint64_t *st[4] = { ctx[0].st, ctx[1].st, ctx[2].st, ctx[3].st };
+	const uint8_t *src[4] = { data[0], data[1], data[2], data[3] };
+	size_t remain[4] = { len[0], len[1], len[2], len[3] };
+	unsigned int i, k;
 
-	done = 0;
-	src = data;
+	for (k = 0; k < 4; k++) {
+		sha3_init(&ctx[k], digest_sz);
+	}
 
-	if ((sctx->partial + len) > (sctx->rsiz - 1)) {
-		if (sctx->partial) {
-			done = sctx->partial; // done = -sctx->partial;
-			memcpy(sctx->buf + sctx->partial, data, done + sctx->rsiz);
-			src = sctx->buf;
-		}
+	const unsigned int rsiz = ctx[0].rsiz, rsizw = ctx[0].rsizw;
 
-		do {
-			unsigned int i;
+	// lock-step while every message still has a full block
+	while (remain[0] >= rsiz && remain[1] >= rsiz && remain[2] >= rsiz && remain[3] >= rsiz) {
+		for (k = 0; k < 4; k++) {
+			for (i = 0; i < rsizw; i++) {
+				st[k][i] ^= load64(src[k] + 8 * i);
+			}
 
-			for (i = 0; i < sctx->rsizw; i++) {
-				sctx->st[i] ^= ((uint64_t *) src)[i];
-            }
-			keccakf(sctx->st, KECCAK_ROUNDS);
+			src[k] += rsiz;
+			remain[k] -= rsiz;
+		}
 
-			done += sctx->rsiz;
-			src = data + done;
-		} while (done + (sctx->rsiz - 1) < len);
+		keccakf1600_x4(st);
+	}
 
-		sctx->partial = 0;
+	for (k = 0; k < 4; k++) {
+		sha3_update(&ctx[k], src[k], remain[k]);
+		sha3_final(&ctx[k], out[k]);
 	}
-	memcpy(sctx->buf + sctx->partial, src, len - done);
-	sctx->partial += (len - done);
 }
 
-void sha3_final(struct sha3_state *sctx, uint8_t *out)
+void shake_init(struct sha3_state *sctx, unsigned int security_sz)
 {
-	unsigned int i, inlen = sctx->partial;
+	keccak_init(sctx, 2 * security_sz, SHAKE_DOMAIN_PADDING);
+}
 
-	sctx->buf[inlen++] = 0x06; // sha3 standart
-	memset(sctx->buf + inlen, 0, sctx->rsiz - inlen);
-	sctx->buf[sctx->rsiz - 1] |= 0x80;
+void shake_squeeze(struct sha3_state *sctx, uint8_t *out, size_t len)
+{
+	const uint8_t *st = (const uint8_t *) sctx->st;
+	size_t n;
 
-	for (i = 0; i < sctx->rsizw; i++)
-		sctx->st[i] ^= ((uint64_t *) sctx->buf)[i];
+	if (!sctx->squeezing) {
+		keccak_pad(sctx);
+	}
 
-	keccakf(sctx->st, KECCAK_ROUNDS);
+	while (len != 0) {
+		if (sctx->partial == sctx->rsiz) {
+			keccakf1600(sctx->st);
+			sctx->partial = 0;
+		}
 
-//	for (i = 0; i < sctx->rsizw; i++)
-//		sctx->st[i] = cpu_to_le64(sctx->st[i]);
+		n = sctx->rsiz - sctx->partial;
+		if (n > len) {
+			n = len;
+		}
 
-	memcpy(out, sctx->st, sctx->md_len);
+		memcpy(out, st + sctx->partial, n);
 
-	memset(sctx, 0, sizeof(*sctx));
+		sctx->partial += (unsigned int) n;
+		out += n;
+		len -= n;
+	}
 }
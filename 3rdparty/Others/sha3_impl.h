@@ -3,11 +3,13 @@
 	Written by Jeff Garzik <jeff@garzik.org> for module of GNU/Linux kernel from https://lwn.net/Articles/518415/
 	LICENSE GPL
 	Originaly from linux-4.11/include/crypto/sha3.h SHA3_256:c96944b92955652521900dfdf798d942cc917f3d4903d98a1cda637980c55d8f
+	Modified: unrolled/lane-complemented permutation, 4-way AVX2, incremental absorb, SHAKE
 */
 
 #ifndef __CRYPTO_SHA3_H__
 #define __CRYPTO_SHA3_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define SHA3_224_DIGEST_SIZE	(224 / 8)
@@ -22,10 +24,23 @@
 #define SHA3_512_DIGEST_SIZE	(512 / 8)
 #define SHA3_512_BLOCK_SIZE	(200 - 2 * SHA3_512_DIGEST_SIZE)
 
+#define SHAKE128_SECURITY_SIZE	(128 / 8)
+#define SHAKE128_BLOCK_SIZE	(200 - 2 * SHAKE128_SECURITY_SIZE)
+
+#define SHAKE256_SECURITY_SIZE	(256 / 8)
+#define SHAKE256_BLOCK_SIZE	(200 - 2 * SHAKE256_SECURITY_SIZE)
+
+#define SHA3_DOMAIN_PADDING	0x06
+#define SHAKE_DOMAIN_PADDING	0x1F
+
 # ifdef __cplusplus
 extern "C" {
 # endif
 
+/*
+	The sponge absorbs directly into the state (little-endian lanes), so `partial` is the
+	byte position inside the current block while absorbing and while squeezing.
+*/
 struct sha3_state {
 	uint64_t		st[25];
 	unsigned int	md_len;
@@ -33,13 +48,24 @@ struct sha3_state {
 	unsigned int	rsizw;
 
 	unsigned int	partial;
-	uint8_t			buf[SHA3_224_BLOCK_SIZE];
+	uint8_t			pad;
+	uint8_t			squeezing;
 };
 
+/* Keccak-f[1600] on one state / on four independent states (AVX2 when built with __AVX2__) */
+void keccakf1600   (uint64_t st[25]);
+void keccakf1600_x4(uint64_t* st[4]);
+
 void sha3_init  (struct sha3_state *sctx, unsigned int digest_sz);
-void sha3_update(struct sha3_state *sctx, const uint8_t *data, unsigned int len);
+void sha3_update(struct sha3_state *sctx, const uint8_t *data, size_t len);
 void sha3_final (struct sha3_state *sctx, uint8_t *out);
 
+/* SHA-3 of four messages at once, the common full blocks are absorbed by the 4-way permutation */
+void sha3_x4(const uint8_t *data[4], const size_t len[4], unsigned int digest_sz, uint8_t *out[4]);
+
+void shake_init   (struct sha3_state *sctx, unsigned int security_sz);
+void shake_squeeze(struct sha3_state *sctx, uint8_t *out, size_t len);
+
 # ifdef __cplusplus
 }
 # endif
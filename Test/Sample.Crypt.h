@@ -45,6 +45,34 @@ DEF_SAMPLE(Crypt)
   std::tcout << ts("sha3-384-file -> ") << vu::crypt_sha_file(file_path, vu::sha_version::_3, vu::crypt_bits::_384) << std::endl;
   std::tcout << ts("sha3-512-file -> ") << vu::crypt_sha_file(file_path, vu::sha_version::_3, vu::crypt_bits::_512) << std::endl;
 
+  std::tcout << ts("Crypt - SHA-3 & SHAKE (Incremental)") << std::endl;
+
+  {
+    std::vector<vu::byte> hash;
+
+    vu::SHA3 sha3(vu::crypt_bits::_256);
+    sha3.update(data);
+    sha3.update(data);
+    sha3.finalize(hash);
+    std::tcout << ts("sha3-256-incremental -> ") << vu::to_hex_string(hash.data(), hash.size()) << std::endl;
+
+    vu::SHAKE shake(vu::crypt_bits::_128);
+    shake.update(data);
+    shake.squeeze(hash, 16);
+    std::tcout << ts("shake-128 (16) -> ") << vu::to_hex_string(hash.data(), hash.size());
+    shake.squeeze(hash, 16);
+    std::tcout << vu::to_hex_string(hash.data(), hash.size()) << std::endl;
+
+    std::tcout << ts("shake-256 (64) -> ") << vu::crypt_shake_text(text, vu::crypt_bits::_256, 64) << std::endl;
+
+    std::vector<std::vector<vu::byte>> messages(6, data), hashes;
+    vu::crypt_sha3_buffers(messages, vu::crypt_bits::_256, hashes);
+    for (const auto& e : hashes)
+    {
+      std::tcout << ts("sha3-256-batch -> ") << vu::to_hex_string(e.data(), e.size()) << std::endl;
+    }
+  }
+
   std::tcout << ts("Crypt - B64") << std::endl;
 
   text.clear();
@@ -90,5 +118,41 @@ DEF_SAMPLE(Crypt)
   #define crc_we    64, 0x42f0e1eba9ea3693, 0xffffffffffffffff, false, false, 0xffffffffffffffff, 0x62ec59e3f1a4f00a
   std::tcout << ts("crc64 we   -> ") << std::hex << vu::crypt_crc_buffer(data, crc_we) << std::endl;
 
+  std::tcout << ts("Crypt - FastCDC") << std::endl;
+
+  vu::FastCDC cdc(2 * KiB, 8 * KiB, 64 * KiB);
+  cdc.set_digest(vu::sha_version::_2, vu::crypt_bits::_256);
+
+  {
+    vu::ScopeStopWatch ssw(ts("cdc-file -> "), vu::ScopeStopWatch::console);
+
+    auto chunks = cdc.chunk_file(file_path);
+    for (const auto& chunk : chunks)
+    {
+      std::tcout
+        << std::hex << ts("offset=") << chunk.offset
+        << std::dec << ts(" size=") << chunk.size
+        << std::hex << ts(" xxh64=") << chunk.hash << std::endl;
+    }
+  }
+
+  std::tcout << ts("Crypt - Fuzzy Hashing") << std::endl;
+
+  {
+    vu::FuzzyHash hash_explorer, hash_notepad;
+    vu::crypt_fuzzy_file(file_path, hash_explorer);
+    vu::crypt_fuzzy_file(ts("C:\\Windows\\notepad.exe"), hash_notepad);
+
+    std::tcout << ts("fuzzy-explorer -> ") << vu::crypt_fuzzy_to_string(hash_explorer) << std::endl;
+    std::tcout << ts("fuzzy-notepad  -> ") << vu::crypt_fuzzy_to_string(hash_notepad) << std::endl;
+    std::tcout << ts("fuzzy-distance -> ") << std::dec << vu::crypt_fuzzy_compare(hash_explorer, hash_notepad) << std::endl;
+
+    std::vector<vu::FuzzyHash> corpus(1000000, hash_notepad);
+    std::vector<int> distances;
+
+    vu::ScopeStopWatch ssw(ts("fuzzy-compare-1M -> "), vu::ScopeStopWatch::console);
+    vu::crypt_fuzzy_compare(hash_explorer, corpus, distances);
+  }
+
   return vu::VU_OK;
 }
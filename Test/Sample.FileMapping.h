@@ -42,5 +42,21 @@ DEF_SAMPLE(FileMapping)
     }
   }
 
+  // Iterate the file in sliding windows
+
+  vu::FileMapping fm_views;
+
+  if (fm_views.create_within_file(ts("C:\\Windows\\explorer.exe"), 0, 0,
+    vu::fs_generic::FG_READ, vu::fs_share::FS_READ, vu::fs_mode::FM_OPENEXISTING,
+    vu::fs_attribute(vu::fs_attribute::FA_NORMAL | vu::fs_attribute::FA_SEQUENTIALSCAN),
+    vu::page_protection::PP_READ_ONLY) == vu::VU_OK)
+  {
+    fm_views.iterate_views([](const void* ptr, const size_t size, const vu::uint64 offset) -> bool
+    {
+      std::tcout << std::hex << ts("View at ") << ptr << ts(" offset ") << offset << ts(" size ") << size << std::endl;
+      return true;
+    }, 1 * MiB);
+  }
+
   return vu::VU_OK;
 }
@@ -10,6 +10,48 @@ DEF_SAMPLE(Misc)
   // vu::msg_box(vu::get_console_window(), ts("I'm %s. I'm %d years old."), ts("Vic P"), 26);
   // vu::msg_debug(ts("I'm %s. I'm %d years old."), ts("Vic P"), 26);
 
+  std::tcout << vu::format_text(ts("I'm {}. I'm {} years old. {:08X}"), ts("Vic P"), 26, 0xC0FFEE) << std::endl;
+
+  {
+    vu::ScopeStopWatch ssw(ts("format (1M) -> "), vu::ScopeStopWatch::console);
+    for (int i = 0; i < 1000000; i++) vu::format(ts("I'm %s. I'm %d years old. %08X"), ts("Vic P"), i, i);
+  }
+
+  {
+    vu::ScopeStopWatch ssw(ts("format_text (1M) -> "), vu::ScopeStopWatch::console);
+    for (int i = 0; i < 1000000; i++) vu::format_text(ts("I'm {}. I'm {} years old. {:08X}"), ts("Vic P"), i, i);
+  }
+
+  {
+    vu::InternedStringT<char, true> l("KERNEL32.dll"), r("kernel32.DLL");
+    std::cout << l.str() << " == " << r.str() << " -> " << (l == r) << " (" << l.handle() << ")" << std::endl;
+  }
+
+  {
+    int number = 0;
+    const auto result = vu::string_to_number(ts(" -26 "), number);
+    std::tcout << result.ok() << ts(" ") << number << ts(" ") << vu::number_to_string(0.1) << std::endl;
+
+    vu::ScopeStopWatch ssw(ts("number_to_string + string_to_number (1M) -> "), vu::ScopeStopWatch::console);
+    for (int i = 0; i < 1000000; i++) vu::string_to_number(vu::number_to_string(i), number);
+  }
+
+  {
+    vu::HexDumpOptions options;
+    options.address = 0x00400000;
+    options.address_digits = 8;
+    options.uppercase = true;
+
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+    vu::hex_dump(text.data(), text.size(), std::cout, options);
+
+    std::vector<vu::byte> data(16 * MiB);
+    std::string result;
+
+    vu::ScopeStopWatch ssw(ts("hex_dump (16 MiB) -> "), vu::ScopeStopWatch::console);
+    vu::hex_dump(data.data(), data.size(), result);
+  }
+
   std::tcout << vu::lower_string(ts("I Love You")) << std::endl;
   std::tcout << vu::upper_string(ts("I Love You")) << std::endl;
 
@@ -24,6 +66,35 @@ DEF_SAMPLE(Misc)
   for (auto e : l) std::tcout << e << ts("|");
   std::tcout << std::endl;
 
+  std::vector<vu::StringView> views;
+  vu::split_string_view(ts("THIS,IS,,A,SPLIT,VIEW"), ts(","), views, true);
+  for (const auto& e : views) std::tcout << vu::trim_string_view(e).str() << ts("|");
+  std::tcout << std::endl;
+
+  for (const auto& e : vu::Tokenizer(ts(" THIS \t IS A\r\nLAZY  TOKENIZER "), ts(""), vu::split_type::ST_WHITESPACE, true))
+  {
+    std::tcout << e.str() << ts("|");
+  }
+  std::tcout << std::endl;
+
+  {
+    std::string line;
+    for (int i = 0; i < 100000; i++) line += "field,";
+
+    {
+      vu::ScopeStopWatch ssw(ts("split_string -> "), vu::ScopeStopWatch::console);
+      auto n = vu::split_string_A(line, ",").size();
+      std::tcout << n << ts(" ");
+    }
+
+    {
+      vu::ScopeStopWatch ssw(ts("tokenizer -> "), vu::ScopeStopWatch::console);
+      size_t n = 0;
+      for (const auto& e : vu::TokenizerA(line, ",", vu::split_type::ST_CHAR)) n += e.size() != 0;
+      std::tcout << n << ts(" ");
+    }
+  }
+
   l.clear();
   l = vu::multi_string_to_list(ts("THIS\0IS\0A\0MULTI\0STRING\0\0"));
   for (auto& e : l) std::tcout << e << ts("|");
@@ -31,9 +102,26 @@ DEF_SAMPLE(Misc)
 
   std::tcout << vu::date_time_to_string(time(NULL)) << std::endl;
 
+  {
+    vu::DateTimeFormatter formatter(ts("%Y-%m-%d %H:%M:%S.%L %z"));
+    std::tcout << formatter.now() << std::endl;
+
+    vu::tchar buffer[64];
+    vu::ScopeStopWatch ssw(ts("DateTimeFormatter (1M) -> "), vu::ScopeStopWatch::console);
+    for (int i = 0; i < 1000000; i++) formatter.now(buffer, sizeof(buffer) / sizeof(buffer[0]));
+  }
+
   std::cout << vu::to_string_A(L"THIS IS A WIDE STRING") << std::endl;
   std::wcout << vu::to_string_W("THIS IS AN ANSI STRING") << std::endl;
 
+  {
+    std::wstring utf16;
+    std::string utf8 = "UTF-8 \xE2\x86\x92 UTF-16 \xF0\x9F\x98\x80";
+    std::tcout << ts("utf8_to_utf16 -> ") << vu::utf8_to_utf16(utf8, utf16) << ts(" ") << utf16.size() << std::endl;
+    std::tcout << ts("utf16_to_utf8 -> ") << vu::utf16_to_utf8(utf16, utf8) << ts(" ") << utf8.size() << std::endl;
+    std::tcout << ts("utf8_validate -> ") << vu::utf8_validate("\xC0\x80", 2) << std::endl; // overlong
+  }
+
   std::tcout << ts("Environment `PATH`") << std::endl;
   std::tstring envValue = vu::get_env(ts("PATH"));
   auto env = vu::split_string(envValue, ts(";"));
@@ -55,6 +143,19 @@ DEF_SAMPLE(Misc)
   std::tcout << vu::compare_string(ts("C++"), ts("c++"), false) << std::endl;
   std::tcout << vu::compare_string(ts("C++"), ts("c++"), true)  << std::endl;
 
+  {
+    vu::Regex re(ts("C\\+\\+"));
+    std::tcout << re.replace(ts("Written in C++ and for C++"), ts("Cpp")) << std::endl;
+
+    for (int i = 0; i < 1000; i++)
+    {
+      vu::regex_match_string(ts("log-2024-01-01.txt"), ts("log-\\d{4}-\\d{2}-\\d{2}\\.txt"));
+    }
+
+    auto statistics = vu::Regex::get_cache_statistics();
+    std::tcout << ts("regex-cache -> hits=") << statistics.hits << ts(" misses=") << statistics.misses << std::endl;
+  }
+
   std::vector<vu::ulong> pids;
   pids.clear();
 
@@ -95,7 +196,8 @@ DEF_SAMPLE(Misc)
     auto file_path = fso.directory + fso.name;
     auto data = vu::FileSystem::quick_read_as_buffer(file_path);
 
-    auto result = vu::determine_encoding_type(data.get_ptr(), data.get_size());
+    auto detection = vu::detect_encoding(data.get_ptr(), data.get_size());
+    auto result = detection.type;
     auto es = result == vu::encoding_type::ET_UNKNOWN ? L"Unknown" : LES[int(result)];
     auto el = result == vu::encoding_type::ET_UNKNOWN ? L"Unknown" : LEL[int(result)];
 
@@ -105,6 +207,8 @@ DEF_SAMPLE(Misc)
       << " | "
       << std::setw(25) << el
       << " | "
+      << std::setw(4) << detection.confidence
+      << " | "
       << fso.name.c_str()
       << std::endl;
 
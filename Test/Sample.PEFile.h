@@ -72,6 +72,14 @@ DEF_SAMPLE(PEFile)
 
   SEPERATOR()
 
+  auto entropies = pe.get_section_entropies();
+  for (size_t i = 0; i < sections.size(); i++)
+  {
+    printf("%+10s entropy = %.4f\n", sections[i]->Name, entropies[i]);
+  }
+
+  SEPERATOR()
+
   auto ptr_pe_header = pe.get_ptr_pe_header();
   assert(ptr_pe_header != nullptr);
 
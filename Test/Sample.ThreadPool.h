@@ -36,6 +36,298 @@ DEF_SAMPLE(ThreadPool)
 
   logger.log(ts("Taken : "));
 
+  // Tiny Tasks (Shared-Queue vs Work-Stealing)
+
+  const auto benchmark = [](vu::thread_pool_type type, const long n_tasks, const bool from_worker) -> double
+  {
+    std::atomic<long> counter(0);
+    const auto tiny_task = [&counter]() { counter.fetch_add(1, std::memory_order_relaxed); };
+
+    vu::ThreadPool pool(MAX_NTHREADS, type);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (from_worker) // added by a worker, go to its own deque for the work-stealing pool
+    {
+      pool.add_task([&]() { for (long i = 0; i < n_tasks; i++) pool.add_task(tiny_task); });
+    }
+    else // added by an outside thread, go to the injection queue for the work-stealing pool
+    {
+      for (long i = 0; i < n_tasks; i++) pool.add_task(tiny_task);
+    }
+
+    pool.launch();
+
+    // threadpool11 may strand the last task that is posted while its workers go idle (a race in
+    // its postWork), the work-stealing pool must have run all of them here
+
+    while (type == vu::thread_pool_type::TP_SHARED_QUEUE && counter < n_tasks)
+    {
+      pool.add_task([]() {});
+      pool.launch();
+    }
+
+    assert(counter == n_tasks);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return n_tasks / elapsed.count();
+  };
+
+  const long n_tiny_tasks = 1000000;
+
+  const bool from_workers[] = { false, true };
+
+  for (const auto from_worker : from_workers)
+  {
+    std::tcout << (from_worker ? ts("Tiny tasks added by a worker") : ts("Tiny tasks added by the caller")) << std::endl;
+    std::tcout << ts("  Shared-Queue  : ") << long(benchmark(vu::thread_pool_type::TP_SHARED_QUEUE, n_tiny_tasks, from_worker)) << ts(" tasks/s") << std::endl;
+    std::tcout << ts("  Work-Stealing : ") << long(benchmark(vu::thread_pool_type::TP_WORK_STEALING, n_tiny_tasks, from_worker)) << ts(" tasks/s") << std::endl;
+  }
+
+  // Stress (each batch ends with a single task added from outside the pool, a stranded task
+  // would hang the launch)
+
+  {
+    vu::ThreadPool pool;
+
+    std::atomic<long> counter(0);
+    long expected = 0;
+
+    for (int batch = 0; batch < 10000; batch++)
+    {
+      const int n_tasks = batch % 8;
+
+      for (int i = 0; i < n_tasks; i++)
+      {
+        pool.add_task([&]() { counter++; });
+      }
+
+      pool.add_task([&]() { counter++; });
+      pool.launch();
+
+      expected += n_tasks + 1;
+      assert(counter == expected);
+    }
+
+    std::cout << "stress -> " << counter << " tasks" << std::endl;
+  }
+
+  // Statistics
+
+  {
+    vu::ThreadPool pool;
+    pool.enable_timing();
+
+    for (int i = 0; i < 1000; i++)
+    {
+      pool.add_task([&pool]()
+      {
+        for (int j = 0; j < 100; j++)
+        {
+          pool.add_task([]() { std::this_thread::sleep_for(std::chrono::microseconds(10)); });
+        }
+      });
+    }
+
+    pool.launch();
+
+    const auto stats = pool.statistics();
+
+    std::cout << "tasks : submitted " << stats.tasks_submitted << ", completed " << stats.tasks_completed;
+    std::cout << ", steals " << stats.steals << std::endl;
+
+    for (size_t i = 0; i < stats.workers.size(); i++)
+    {
+      const auto& worker = stats.workers[i];
+      std::cout << "worker " << i << " : completed " << worker.tasks_completed << ", steals " << worker.steals;
+      std::cout << ", idle " << worker.idle_time.count() / 1000 << "us" << std::endl;
+    }
+
+    typedef vu::ThreadPoolStatistics Statistics;
+    std::cout << "queue wait : p50 " << Statistics::percentile(stats.queue_wait_histogram, 50).count();
+    std::cout << "ns, p99 " << Statistics::percentile(stats.queue_wait_histogram, 99).count() << "ns" << std::endl;
+    std::cout << "run time : p50 " << Statistics::percentile(stats.run_time_histogram, 50).count();
+    std::cout << "ns, p99 " << Statistics::percentile(stats.run_time_histogram, 99).count() << "ns" << std::endl;
+  }
+
+  // NUMA Sub-Pools
+
+  {
+    vu::ThreadPoolOptions options;
+    options.affinity = vu::thread_pool_affinity::TA_CORE;
+    options.numa_sub_pools = true;
+
+    vu::ThreadPool pool(options);
+
+    std::cout << "workers " << pool.worker_count() << " on " << pool.numa_node_count() << " node(s)" << std::endl;
+
+    std::mutex mutex;
+    std::map<size_t, int> runs;
+
+    for (int i = 0; i < 1000; i++)
+    {
+      pool.add_task([&]()
+      {
+        std::lock_guard<std::mutex> lg(mutex);
+        runs[pool.numa_node()]++;
+      }, 0); // a hint to run on the node 0
+    }
+
+    pool.launch();
+
+    for (const auto& e : runs)
+    {
+      std::cout << "node " << e.first << " : " << e.second << " tasks" << std::endl;
+    }
+  }
+
+  // Futures
+
+  {
+    vu::ThreadPool pool;
+
+    auto f = pool.submit([]() { return 20; }).then([](int v) { return v + 1; }); // 21
+
+    std::vector<vu::TaskFutureT<int>> futures;
+    for (int i = 1; i <= 10; i++)
+    {
+      futures.push_back(pool.submit([i]() { return i * i; }));
+    }
+
+    auto sum = vu::when_all(futures).then([](const std::vector<int>& v)
+    {
+      return std::accumulate(v.cbegin(), v.cend(), 0); // 385
+    });
+
+    auto name = pool.submit([]() { return std::string("Vic P"); });
+    auto both = vu::when_all(f, name); // std::tuple<int, std::string>
+
+    auto failed = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+
+    std::cout << "then -> " << f.get() << std::endl;
+    std::cout << "when_all -> " << sum.get() << std::endl;
+    std::cout << "when_all -> " << std::get<1>(both.get()) << " " << std::get<0>(both.get()) << std::endl;
+    std::cout << "when_any -> " << vu::when_any(futures).get() << std::endl;
+
+    try
+    {
+      failed.then([](int v) { return v * 2; }).get();
+    }
+    catch (const std::exception& e)
+    {
+      std::cout << "exception -> " << e.what() << std::endl;
+    }
+  }
+
+  // Parallel For / Reduce
+
+  {
+    std::vector<int> numbers(10000000);
+    vu::parallel_for(size_t(0), numbers.size(), [&](size_t i) { numbers[i] = int(i % 100); });
+
+    const auto sum = vu::parallel_reduce(size_t(0), numbers.size(), 0LL,
+      [&](size_t i) { return (long long)numbers[i]; },
+      [](long long l, long long r) { return l + r; });
+
+    std::cout << "parallel_reduce -> " << sum << std::endl;
+
+    std::atomic<size_t> found(0);
+    const bool completed = vu::parallel_for_each(numbers.cbegin(), numbers.cend(), [&](int v)
+    {
+      return v == 99 && ++found == 10 ? vu::return_type::Break : vu::return_type::Ok;
+    });
+
+    std::cout << "parallel_for_each -> " << (completed ? "completed" : "stopped") << std::endl;
+  }
+
+  // Parallel Algorithms (vs STL)
+
+  {
+    const auto measure = [](const std::function<void()>& fn) -> long long
+    {
+      const auto start = std::chrono::steady_clock::now();
+      fn();
+      return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<vu::uint64> items(20000000);
+    vu::uint64 seed = 88172645463325252ULL; // xorshift64
+    std::generate(items.begin(), items.end(), [&]() { seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; return seed; });
+
+    auto std_items = items;
+    auto par_items = items;
+    std::vector<vu::uint64> std_output(items.size());
+    std::vector<vu::uint64> par_output(items.size());
+
+    std::cout << "sort : std " << measure([&]() { std::sort(std_items.begin(), std_items.end()); }) << "ms";
+    std::cout << ", parallel " << measure([&]() { vu::parallel_sort(par_items.begin(), par_items.end()); }) << "ms";
+    std::cout << (std_items == par_items ? "" : " (mismatched)") << std::endl;
+
+    std::cout << "scan : std " << measure([&]() { std::partial_sum(items.cbegin(), items.cend(), std_output.begin()); }) << "ms";
+    std::cout << ", parallel " << measure([&]() { vu::parallel_inclusive_scan(items.cbegin(), items.cend(), par_output.begin()); }) << "ms";
+    std::cout << (std_output == par_output ? "" : " (mismatched)") << std::endl;
+
+    const auto square = [](vu::uint64 v) { return v * v; };
+    std::cout << "transform : std " << measure([&]() { std::transform(items.cbegin(), items.cend(), std_output.begin(), square); }) << "ms";
+    std::cout << ", parallel " << measure([&]() { vu::parallel_transform(items.cbegin(), items.cend(), par_output.begin(), square); }) << "ms";
+    std::cout << (std_output == par_output ? "" : " (mismatched)") << std::endl;
+
+    const auto odd = [](vu::uint64 v) { return (v & 1) != 0; };
+    std::vector<vu::uint64>::iterator std_end, par_end;
+    std::cout << "copy_if : std " << measure([&]() { std_end = std::copy_if(items.cbegin(), items.cend(), std_output.begin(), odd); }) << "ms";
+    std::cout << ", parallel " << measure([&]() { par_end = vu::parallel_copy_if(items.cbegin(), items.cend(), par_output.begin(), odd); }) << "ms";
+    std::cout << (std::equal(std_output.begin(), std_end, par_output.begin()) ? "" : " (mismatched)") << std::endl;
+  }
+
+  // Task Graph
+
+  {
+    const auto work = [](int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+
+    std::atomic<int> n_signatures(0);
+
+    vu::TaskGraph graph;
+
+    auto parse   = graph.add("parse",   [&]() { work(20); });
+    auto hash    = graph.add("hash",    [&]() { work(10); });
+    auto imports = graph.add("imports", [&]() { work(30); });
+    auto scan    = graph.add_dynamic("scan", [&](vu::TaskGraph::Context& context)
+    {
+      for (int i = 0; i < 8; i++)
+      {
+        context.spawn([&]() { work(5); n_signatures++; });
+      }
+    });
+    auto report  = graph.add("report",  [&]() { work(5); });
+
+    graph.precede(parse, hash);
+    graph.precede(parse, imports);
+    graph.precede(parse, scan);
+    graph.succeed(report, hash);
+    graph.succeed(report, imports);
+    graph.succeed(report, scan);
+
+    graph.enable_timing();
+
+    for (int i = 0; i < 3; i++)
+    {
+      graph.run();
+    }
+
+    for (const auto& e : graph.timings())
+    {
+      std::cout << e.name << " : start " << e.start.count() / 1000 << "us, taken " << e.duration.count() / 1000 << "us" << std::endl;
+    }
+
+    std::chrono::nanoseconds length;
+    std::cout << "critical path :";
+    for (auto node : graph.critical_path(&length))
+    {
+      std::cout << " " << graph.name(node);
+    }
+    std::cout << " (" << length.count() / 1000 << "us), signatures " << n_signatures << std::endl;
+  }
+
   // STL Multi-threading
 
   class SampleTask : public vu::STLThreadT<std::vector<int>>
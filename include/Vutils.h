@@ -81,17 +81,25 @@
 #endif // _WIN_SVC_
 
 #include <set>
+#include <map>
 #include <cmath>
 #include <ctime>
 #include <mutex>
 #include <regex>
+#include <tuple>
 #include <string>
 #include <vector>
 #include <thread>
 #include <memory>
+#include <limits>
+#include <chrono>
+#include <atomic>
+#include <iterator>
 #include <numeric>
 #include <sstream>
 #include <cassert>
+#include <algorithm>
+#include <exception>
 #include <functional>
 #include <type_traits>
 #include <unordered_map>
@@ -134,6 +142,10 @@ namespace threadpool11
 
 using namespace threadpool11;
 
+// Keccak (SHA-3 & SHAKE)
+
+struct sha3_state;
+
 // BigInt
 
 #include "3rdparty/BI/BigInt.hpp"
@@ -201,6 +213,36 @@ intptr vuapi gcd(ulongptr count, ...); // UCLN
 intptr vuapi lcm(ulongptr count, ...); // BCNN
 void vuapi hex_dump(const void* data, int size);
 
+// Hex Dump
+
+struct HexDumpOptions
+{
+  size_t width;          // the number of the bytes per line
+  size_t group;          // the number of the bytes per group (0 for no grouping)
+  bool   ascii;          // the ASCII gutter
+  bool   uppercase;      // the uppercase hex digits
+  uint64 address;        // the address of the first byte
+  size_t address_digits; // the minimum number of the digits of the addresses
+
+  HexDumpOptions() : width(16), group(8), ascii(true), uppercase(false), address(0), address_digits(4) {}
+};
+
+void vuapi hex_dump(const void* ptr, const size_t size, std::string& result, const HexDumpOptions& options = HexDumpOptions());
+void vuapi hex_dump(const void* ptr, const size_t size, Buffer& result, const HexDumpOptions& options = HexDumpOptions());
+void vuapi hex_dump(const void* ptr, const size_t size, std::ostream& stream, const HexDumpOptions& options = HexDumpOptions());
+
+// Byte Histogram & Entropy
+
+void vuapi byte_histogram(const void* ptr, const size_t size, uint64 (&histogram)[256], const bool accumulate = false);
+double vuapi shannon_entropy(const uint64 (&histogram)[256]); // bits per byte, in [0, 8]
+double vuapi shannon_entropy(const void* ptr, const size_t size);
+double vuapi shannon_entropy(const std::vector<byte>& data);
+double vuapi shannon_entropy(const Buffer& data);
+double vuapi chi_square(const uint64 (&histogram)[256]); // against the uniform distribution
+double vuapi chi_square(const void* ptr, const size_t size);
+double vuapi chi_square(const std::vector<byte>& data);
+double vuapi chi_square(const Buffer& data);
+
 #include "template/math.tpl"
 
 /**
@@ -243,6 +285,18 @@ std::wstring vuapi format_date_time_W(const time_t t, const std::wstring format)
 std::string vuapi date_time_to_string_A(const time_t t);
 std::wstring vuapi date_time_to_string_W(const time_t t);
 encoding_type vuapi determine_encoding_type(const void* data, const size_t size);
+
+struct EncodingDetection
+{
+  encoding_type type;
+  float confidence; // In [0, 1]
+  size_t bom_size;  // The size of the BOM, 0 if no BOM
+  EncodingDetection() : type(encoding_type::ET_UNKNOWN), confidence(0.F), bom_size(0) {}
+};
+
+// Detects the encoding by the BOM, else by the null bytes (UTF-16) & by validating the UTF-8 of the data
+// (the first max_scan_size bytes or the whole data if it's 0). Only the bytes in [data, data + size) are read.
+EncodingDetection vuapi detect_encoding(const void* data, const size_t size, const size_t max_scan_size = 0);
 std::string vuapi format_bytes_A(long long bytes, data_unit_type dut = data_unit_type::IEC, int digits = 2);
 std::wstring vuapi format_bytes_W(long long bytes, data_unit_type dut = data_unit_type::IEC, int digits = 2);
 std::string vuapi to_hex_string_A(const byte* ptr, const size_t size);
@@ -253,6 +307,116 @@ void vuapi url_encode_A(const std::string& text, std::string& result);
 void vuapi url_encode_W(const std::wstring& text, std::wstring& result);
 void vuapi url_decode_A(const std::string& text, std::string& result);
 void vuapi url_decode_W(const std::wstring& text, std::wstring& result);
+void vuapi url_decode_in_place_A(std::string& text);
+void vuapi url_decode_in_place_W(std::wstring& text);
+
+/**
+ * Unicode Transcoding (UTF-8, UTF-16 & UTF-32)
+ * The inputs are strictly validated, the overlong forms, the lone surrogates & the code points
+ * out of range are rejected (the result is empty & the functions return false).
+ */
+
+bool vuapi is_ascii(const void* ptr, const size_t size);
+bool vuapi utf8_validate(const void* ptr, const size_t size);
+bool vuapi utf8_to_utf16(const std::string& text, std::wstring& result);
+bool vuapi utf16_to_utf8(const std::wstring& text, std::string& result);
+bool vuapi utf8_to_utf32(const std::string& text, std::u32string& result);
+bool vuapi utf32_to_utf8(const std::u32string& text, std::string& result);
+bool vuapi utf16_to_utf32(const std::wstring& text, std::u32string& result);
+bool vuapi utf32_to_utf16(const std::u32string& text, std::wstring& result);
+
+/**
+ * DateTimeFormatterT
+ * The formatter of the date/time for the hot paths (eg. the timestamps of the log lines).
+ * The format is parsed once, the output is cached per second and the time-zone offset per hour
+ * (except the hours that change the offset), so formatting a time in the same second is a copy
+ * and a few digits.
+ * The fields are the same as strftime (the uncommon ones are formatted by strftime), plus
+ *   %L - the milliseconds (000-999)
+ *   %f - the microseconds (000000-999999)
+ * It's not thread-safe, use an instance per thread.
+ * Eg.
+ *   vu::DateTimeFormatterA formatter("%Y-%m-%d %H:%M:%S.%L");
+ *   char buffer[64];
+ *   formatter.now(buffer, sizeof(buffer)); // "2021-04-01 13:45:07.123"
+ */
+
+template <typename char_t>
+class DateTimeFormatterT
+{
+public:
+  typedef std::basic_string<char_t> std_string_t;
+
+  DateTimeFormatterT(const std_string_t& format, const bool utc = false);
+  virtual ~DateTimeFormatterT();
+
+  /**
+   * Formats a time into the buffer (null-terminated), returns the number of the written characters
+   * without the null terminator, or 0 if the buffer is too small.
+   */
+  size_t format(char_t* ptr, const size_t size, const time_t t, const uint32 microseconds = 0);
+  size_t format(char_t* ptr, const size_t size, const std::chrono::system_clock::time_point& time);
+  size_t now(char_t* ptr, const size_t size);
+
+  std_string_t format(const time_t t, const uint32 microseconds = 0);
+  std_string_t format(const std::chrono::system_clock::time_point& time);
+  std_string_t now();
+
+private:
+  enum token_type
+  {
+    TT_TEXT,
+    TT_YEAR,
+    TT_YEAR_2,
+    TT_MONTH,
+    TT_DAY,
+    TT_DAY_OF_YEAR,
+    TT_HOUR,
+    TT_HOUR_12,
+    TT_MINUTE,
+    TT_SECOND,
+    TT_AM_PM,
+    TT_WEEKDAY_NAME,
+    TT_WEEKDAY_SHORT_NAME,
+    TT_MONTH_NAME,
+    TT_MONTH_SHORT_NAME,
+    TT_ZONE_OFFSET,
+    TT_MILLISECOND,
+    TT_MICROSECOND,
+    TT_STRFTIME,
+  };
+
+  struct Token
+  {
+    token_type type;
+    size_t first; // the text or the strftime field in m_text
+    size_t size;
+  };
+
+  struct Patch
+  {
+    token_type type;
+    size_t offset;
+  };
+
+  void parse(const std_string_t& format);
+  void update(const time_t t);
+  void update_offset(const time_t t);
+  long local_offset(const time_t t) const;
+
+private:
+  bool m_utc;
+  std_string_t m_text;
+  std::vector<Token> m_tokens;
+  time_t m_second;
+  time_t m_hour;
+  long m_offset;
+  std_string_t m_cache;
+  std::vector<Patch> m_patches;
+};
+
+typedef DateTimeFormatterT<char>  DateTimeFormatterA;
+typedef DateTimeFormatterT<wchar> DateTimeFormatterW;
 
 /**
  * String Working
@@ -269,8 +433,8 @@ std::string vuapi lower_string_A(const std::string& string);
 std::wstring vuapi lower_string_W(const std::wstring& string);
 std::string vuapi upper_string_A(const std::string& string);
 std::wstring vuapi upper_string_W(const std::wstring& string);
-std::string vuapi to_string_A(const std::wstring& string);
-std::wstring vuapi to_string_W(const std::string& string);
+std::string vuapi to_string_A(const std::wstring& string);  // UTF-16 -> ANSI
+std::wstring vuapi to_string_W(const std::string& string);  // ANSI -> UTF-16
 std::vector<std::string> vuapi split_string_A(
   const std::string& string, const std::string& separator, bool remove_empty = false);
 std::vector<std::wstring> vuapi split_string_W(
@@ -295,6 +459,14 @@ std::string vuapi replace_string_A(
   const std::string& text, const std::string& from, const std::string& to);
 std::wstring vuapi replace_string_W(
   const std::wstring& text, const std::wstring& from, const std::wstring& to);
+std::string vuapi replace_all_A(
+  const std::string& text, const std::map<std::string, std::string>& replacements);
+std::wstring vuapi replace_all_W(
+  const std::wstring& text, const std::map<std::wstring, std::wstring>& replacements);
+bool vuapi replace_all_in_place_A(
+  std::string& text, const std::map<std::string, std::string>& replacements);
+bool vuapi replace_all_in_place_W(
+  std::wstring& text, const std::map<std::wstring, std::wstring>& replacements);
 bool vuapi starts_with_A(const std::string& text, const std::string& with, bool ignore_case = false);
 bool vuapi starts_with_W(const std::wstring& text, const std::wstring& with, bool ignore_case = false);
 bool vuapi ends_with_A(const std::string& text, const std::string& with, bool ignore_case = false);
@@ -314,6 +486,305 @@ std::wstring vuapi regex_replace_string_W(
   const std::wstring& replacement,
   std::regex_constants::match_flag_type flags = std::regex_constants::match_default);
 
+/**
+ * String View Working
+ * The allocation-free versions of the string working, the results are the views into the inputs
+ * or are written into the buffers of the callers (their capacities are reused).
+ */
+
+enum class split_type
+{
+  ST_CHAR       = 0, // the first character of the delimiter
+  ST_STRING     = 1, // the whole delimiter
+  ST_ANY_OF     = 2, // any character of the delimiter
+  ST_WHITESPACE = 3, // any whitespace character (the delimiter is unused)
+};
+
+const char* vuapi find_char(const char* ptr, const size_t size, const char c);
+const wchar* vuapi find_char(const wchar* ptr, const size_t size, const wchar c);
+bool vuapi equal_ignore_case(const char* left, const char* right, const size_t size);
+bool vuapi equal_ignore_case(const wchar* left, const wchar* right, const size_t size);
+const char* vuapi find_ignore_case(const char* text, const size_t text_size, const char* test, const size_t test_size);
+const wchar* vuapi find_ignore_case(const wchar* text, const size_t text_size, const wchar* test, const size_t test_size);
+
+#include "template/strview.tpl"
+
+void vuapi split_string_view_A(
+  const StringViewA& string,
+  const StringViewA& separator,
+  std::vector<StringViewA>& parts,
+  bool remove_empty = false);
+void vuapi split_string_view_W(
+  const StringViewW& string,
+  const StringViewW& separator,
+  std::vector<StringViewW>& parts,
+  bool remove_empty = false);
+void vuapi join_string_view_A(
+  const std::vector<StringViewA>& parts, const StringViewA& separator, std::string& result);
+void vuapi join_string_view_W(
+  const std::vector<StringViewW>& parts, const StringViewW& separator, std::wstring& result);
+StringViewA vuapi trim_string_view_A(
+  const StringViewA& string,
+  const trim_type& type = trim_type::TS_BOTH,
+  const StringViewA& chars = " \t\n\r\f\v");
+StringViewW vuapi trim_string_view_W(
+  const StringViewW& string,
+  const trim_type& type = trim_type::TS_BOTH,
+  const StringViewW& chars = L" \t\n\r\f\v");
+void vuapi replace_string_view_A(
+  const StringViewA& text, const StringViewA& from, const StringViewA& to, std::string& result);
+void vuapi replace_string_view_W(
+  const StringViewW& text, const StringViewW& from, const StringViewW& to, std::wstring& result);
+bool vuapi starts_with_view_A(const StringViewA& text, const StringViewA& with, bool ignore_case = false);
+bool vuapi starts_with_view_W(const StringViewW& text, const StringViewW& with, bool ignore_case = false);
+bool vuapi ends_with_view_A(const StringViewA& text, const StringViewA& with, bool ignore_case = false);
+bool vuapi ends_with_view_W(const StringViewW& text, const StringViewW& with, bool ignore_case = false);
+bool vuapi contains_string_view_A(const StringViewA& text, const StringViewA& test, bool ignore_case = false);
+bool vuapi contains_string_view_W(const StringViewW& text, const StringViewW& test, bool ignore_case = false);
+bool vuapi compare_string_view_A(const StringViewA& vl, const StringViewA& vr, bool ignore_case = false);
+bool vuapi compare_string_view_W(const StringViewW& vl, const StringViewW& vr, bool ignore_case = false);
+
+/**
+ * String Pool Working
+ * The interned strings are stored once in a pool and are referred by the stable 32-bit handles,
+ * so the equal strings share a single copy and are compared by their handles. In a case-insensitive
+ * pool, the strings that are equal ignoring case share a handle (the first spelling is kept).
+ * The handle 0 is always the empty string. The handles are valid until the pool is destroyed.
+ * A pool holds up to 4M strings, so don't intern the untrusted strings into the global pools.
+ */
+
+template <typename char_t>
+class StringPoolT
+{
+public:
+  typedef uint32 handle_t;
+  typedef std::basic_string<char_t> std_string_t;
+  typedef StringViewT<char_t> string_view_t;
+
+  static const handle_t INVALID_HANDLE = handle_t(-1);
+
+  StringPoolT(const bool ignore_case = false);
+  virtual ~StringPoolT();
+
+  /**
+   * Gets the handle of a string, the string is added to the pool if it's not interned yet.
+   * Returns INVALID_HANDLE if the pool is full.
+   */
+  handle_t intern(const string_view_t& string);
+
+  /**
+   * Gets the handle of a string without adding it, returns INVALID_HANDLE if it's not interned.
+   */
+  handle_t find(const string_view_t& string) const;
+
+  /**
+   * Gets the string of a handle, it's lock-free for the handles that are returned by the pool.
+   */
+  const std_string_t& get(const handle_t handle) const;
+
+  size_t size() const;
+  bool ignore_case() const;
+
+  /**
+   * The shared pools for the whole process (case-sensitive and case-insensitive).
+   */
+  static StringPoolT& global(const bool ignore_case = false);
+
+private:
+  StringPoolT(const StringPoolT&);
+  StringPoolT& operator=(const StringPoolT&);
+
+  struct Hasher
+  {
+    bool ignore_case;
+    Hasher(const bool ignore_case) : ignore_case(ignore_case) {}
+    size_t operator()(const string_view_t& v) const;
+  };
+
+  struct Equaler
+  {
+    bool ignore_case;
+    Equaler(const bool ignore_case) : ignore_case(ignore_case) {}
+    bool operator()(const string_view_t& l, const string_view_t& r) const;
+  };
+
+  static const size_t CHUNK_SIZE = 1024;
+  static const size_t MAX_CHUNKS = 4096;
+
+  bool m_ignore_case;
+  mutable std::mutex m_mutex;
+  handle_t m_size;
+  std_string_t m_empty;
+  std::unique_ptr<std::unique_ptr<std_string_t[]>[]> m_chunks;
+  std::unordered_map<string_view_t, handle_t, Hasher, Equaler> m_handles;
+};
+
+typedef StringPoolT<char>  StringPoolA;
+typedef StringPoolT<wchar> StringPoolW;
+
+/**
+ * InternedStringT
+ * The string that is interned in a global pool, it's a 32-bit handle that is compared by value.
+ * Eg.
+ *   vu::InternedStringT<char, true> l("KERNEL32.dll"), r("kernel32.DLL");
+ *   l == r; // true, the handles are the same
+ */
+
+template <typename char_t, bool ignore_case = false>
+class InternedStringT
+{
+public:
+  typedef StringPoolT<char_t> pool_t;
+  typedef typename pool_t::handle_t handle_t;
+  typedef typename pool_t::std_string_t std_string_t;
+  typedef typename pool_t::string_view_t string_view_t;
+
+  InternedStringT() : m_handle(0) {}
+  InternedStringT(const char_t* string) : m_handle(intern(string)) {}
+  InternedStringT(const std_string_t& string) : m_handle(intern(string)) {}
+  InternedStringT(const string_view_t& string) : m_handle(intern(string)) {}
+
+  handle_t handle() const { return m_handle; }
+
+  const std_string_t& str() const { return pool().get(m_handle); }
+  operator const std_string_t&() const { return this->str(); }
+  string_view_t view() const { return string_view_t(this->str()); }
+
+  const char_t* c_str() const { return this->str().c_str(); }
+  size_t size() const { return this->str().size(); }
+  bool empty() const { return m_handle == 0; }
+
+  bool operator==(const InternedStringT& right) const { return m_handle == right.m_handle; }
+  bool operator!=(const InternedStringT& right) const { return m_handle != right.m_handle; }
+  bool operator<(const InternedStringT& right) const { return m_handle < right.m_handle; } // not lexicographical
+
+  /**
+   * Finds an interned string without adding it to the pool, returns false if it's not interned
+   * (so it's not equal to any InternedStringT).
+   */
+  static bool find(const string_view_t& string, InternedStringT& result)
+  {
+    const auto handle = pool().find(string);
+    if (handle == pool_t::INVALID_HANDLE)
+    {
+      return false;
+    }
+
+    result.m_handle = handle;
+    return true;
+  }
+
+  static pool_t& pool() { return pool_t::global(ignore_case); }
+
+private:
+  static handle_t intern(const string_view_t& string)
+  {
+    const auto handle = pool().intern(string);
+    if (handle == pool_t::INVALID_HANDLE)
+    {
+      throw "the string pool is full";
+    }
+
+    return handle;
+  }
+
+  handle_t m_handle;
+};
+
+typedef InternedStringT<char>  InternedStringA;
+typedef InternedStringT<wchar> InternedStringW;
+
+/**
+ * Regular Expression Working
+ * The compiled regular expressions are shared by a bounded LRU cache that is keyed by the pattern
+ * and the syntax flags, so constructing a Regex with a pattern that was used recently is cheap.
+ */
+
+struct RegexCacheStatistics
+{
+  uint64 hits;
+  uint64 misses;
+  size_t size;
+  size_t capacity;
+
+  RegexCacheStatistics() : hits(0), misses(0), size(0), capacity(0) {}
+};
+
+template <typename char_t>
+class RegexT
+{
+public:
+  typedef std::basic_string<char_t> std_string_t;
+  typedef std::basic_regex<char_t> std_regex_t;
+  typedef std::match_results<typename std_string_t::const_iterator> match_t;
+  typedef std::regex_constants::syntax_option_type syntax_t;
+  typedef std::regex_constants::match_flag_type flags_t;
+
+  RegexT();
+  RegexT(const std_string_t& pattern, const syntax_t syntax = std::regex_constants::ECMAScript);
+  RegexT(const char_t* pattern, const syntax_t syntax = std::regex_constants::ECMAScript);
+  RegexT(const RegexT& right);
+  virtual ~RegexT();
+
+  const RegexT& operator=(const RegexT& right);
+  operator const std_regex_t&() const;
+
+  bool valid() const;
+  const std_string_t& pattern() const;
+  const std_regex_t& get() const;
+
+  bool match(const std_string_t& text, const flags_t flags = std::regex_constants::match_default) const;
+  bool search(const std_string_t& text, const flags_t flags = std::regex_constants::match_default) const;
+  size_t search_all(
+    const std_string_t& text,
+    std::vector<match_t>& matches,
+    const flags_t flags = std::regex_constants::match_default) const;
+  std_string_t replace(
+    const std_string_t& text,
+    const std_string_t& replacement,
+    const flags_t flags = std::regex_constants::match_default) const;
+
+  static void set_cache_capacity(const size_t capacity);
+  static void clear_cache();
+  static RegexCacheStatistics get_cache_statistics();
+
+private:
+  std_string_t m_pattern;
+  std::shared_ptr<const std_regex_t> m_ptr_regex;
+};
+
+typedef RegexT<char>  RegexA;
+typedef RegexT<wchar> RegexW;
+
+std::string vuapi regex_replace_string_A(
+  const std::string& text,
+  const std::string& pattern,
+  const std::string& replacement,
+  std::regex_constants::match_flag_type flags = std::regex_constants::match_default);
+std::wstring vuapi regex_replace_string_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  const std::wstring& replacement,
+  std::regex_constants::match_flag_type flags = std::regex_constants::match_default);
+bool vuapi regex_match_string_A(
+  const std::string& text,
+  const std::string& pattern,
+  std::regex_constants::syntax_option_type syntax = std::regex_constants::ECMAScript);
+bool vuapi regex_match_string_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  std::regex_constants::syntax_option_type syntax = std::regex_constants::ECMAScript);
+size_t vuapi regex_search_all_A(
+  const std::string& text,
+  const std::string& pattern,
+  std::vector<std::smatch>& matches,
+  std::regex_constants::syntax_option_type syntax = std::regex_constants::ECMAScript);
+size_t vuapi regex_search_all_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  std::vector<std::wsmatch>& matches,
+  std::regex_constants::syntax_option_type syntax = std::regex_constants::ECMAScript);
+
 /**
  * Process Working
  */
@@ -663,6 +1134,7 @@ enum class crypt_bits : int
   _32  = 32,  // CRC-32/HDLC, CRC-32/ADCCP, CRC-32/V-42, CRC-32/XZ, PKZIP
   _64  = 64,  // CRC-64/ECMA-182
 
+  _128 = 128, // SHAKE128 (security strength)
   _160 = 160, // SHA-1   (20 bytes)
   _224 = 224, // SHA-1   (28 bytes)
   _256 = 256, // SHA-256 (32 bytes)
@@ -704,6 +1176,30 @@ void vuapi crypt_sha_buffer(
   const sha_version version,
   const crypt_bits bits,
   std::vector<byte>& hash);
+void vuapi crypt_sha_buffer(
+  const void* ptr,
+  const size_t size,
+  const sha_version version,
+  const crypt_bits bits,
+  std::vector<byte>& hash);
+
+// Note: The SHA-3 of 4 messages are computed at once by the 4-way Keccak permutation (AVX2 when built with it)
+void vuapi crypt_sha3_buffers(
+  const std::vector<std::vector<byte>>& data,
+  const crypt_bits bits,
+  std::vector<std::vector<byte>>& hashes);
+
+// SHAKE (SHA-3 XOF)
+
+void vuapi crypt_shake_buffer(
+  const std::vector<byte>& data,
+  const crypt_bits bits,
+  const size_t size,
+  std::vector<byte>& output);
+std::string vuapi crypt_shake_text_A(
+  const std::string& text, const crypt_bits bits, const size_t size);
+std::wstring vuapi crypt_shake_text_W(
+  const std::wstring& text, const crypt_bits bits, const size_t size);
 
 /*----------- The definition of common function(s) which compatible both ANSI & UNICODE ----------*/
 
@@ -715,6 +1211,10 @@ void vuapi crypt_sha_buffer(
 #define find_pattern find_pattern_W
 /* String Formatting */
 #define format format_W
+#define format_text format_text_W
+#define append_format append_format_W
+#define number_to_string number_to_string_W
+#define string_to_number string_to_number_W
 #define msg_debug msg_debug_W
 #define msg_box msg_box_W
 #define get_last_error get_last_error_W
@@ -725,6 +1225,7 @@ void vuapi crypt_sha_buffer(
 #define to_hex_bytes to_hex_bytes_W
 #define url_encode url_encode_W
 #define url_decode url_decode_W
+#define url_decode_in_place url_decode_in_place_W
 /* String Working */
 #define lower_string lower_string_W
 #define upper_string upper_string_W
@@ -735,11 +1236,23 @@ void vuapi crypt_sha_buffer(
 #define load_rs_string load_rs_string_W
 #define trim_string trim_string_W
 #define replace_string replace_string_W
+#define replace_all replace_all_W
+#define replace_all_in_place replace_all_in_place_W
 #define starts_with starts_with_W
 #define ends_with ends_with_W
 #define contains_string contains_string_W
 #define compare_string compare_string_W
 #define regex_replace_string regex_replace_string_W
+#define regex_match_string regex_match_string_W
+#define regex_search_all regex_search_all_W
+#define split_string_view split_string_view_W
+#define join_string_view join_string_view_W
+#define trim_string_view trim_string_view_W
+#define replace_string_view replace_string_view_W
+#define starts_with_view starts_with_view_W
+#define ends_with_view ends_with_view_W
+#define contains_string_view contains_string_view_W
+#define compare_string_view compare_string_view_W
 /* Window Working */
 #define get_font get_font_W
 #define get_monitors get_monitors_W
@@ -779,6 +1292,10 @@ void vuapi crypt_sha_buffer(
 #define crypt_crc_file crypt_crc_file_W
 #define crypt_sha_text crypt_sha_text_W
 #define crypt_sha_file crypt_sha_file_W
+#define crypt_shake_text crypt_shake_text_W
+#define crypt_fuzzy_file crypt_fuzzy_file_W
+#define crypt_fuzzy_to_string crypt_fuzzy_to_string_W
+#define crypt_fuzzy_from_string crypt_fuzzy_from_string_W
 #else // _UNICODE
 /* Misc Working */
 #define set_privilege set_privilege_A
@@ -787,6 +1304,10 @@ void vuapi crypt_sha_buffer(
 #define find_pattern find_pattern_A
 /* String Formatting */
 #define format format_A
+#define format_text format_text_A
+#define append_format append_format_A
+#define number_to_string number_to_string_A
+#define string_to_number string_to_number_A
 #define msg_debug msg_debug_A
 #define msg_box msg_box_A
 #define get_last_error get_last_error_A
@@ -797,6 +1318,7 @@ void vuapi crypt_sha_buffer(
 #define to_hex_bytes to_hex_bytes_A
 #define url_encode url_encode_A
 #define url_decode url_decode_A
+#define url_decode_in_place url_decode_in_place_A
 /* String Working */
 #define lower_string lower_string_A
 #define upper_string upper_string_A
@@ -806,11 +1328,23 @@ void vuapi crypt_sha_buffer(
 #define load_rs_string load_rs_string_A
 #define trim_string trim_string_A
 #define replace_string replace_string_A
+#define replace_all replace_all_A
+#define replace_all_in_place replace_all_in_place_A
 #define starts_with starts_with_A
 #define ends_with ends_with_A
 #define contains_string contains_string_A
 #define compare_string compare_string_A
 #define regex_replace_string regex_replace_string_A
+#define regex_match_string regex_match_string_A
+#define regex_search_all regex_search_all_A
+#define split_string_view split_string_view_A
+#define join_string_view join_string_view_A
+#define trim_string_view trim_string_view_A
+#define replace_string_view replace_string_view_A
+#define starts_with_view starts_with_view_A
+#define ends_with_view ends_with_view_A
+#define contains_string_view contains_string_view_A
+#define compare_string_view compare_string_view_A
 /* Window Working */
 #define get_font get_font_A
 #define get_monitors get_monitors_A
@@ -850,6 +1384,10 @@ void vuapi crypt_sha_buffer(
 #define crypt_crc_file crypt_crc_file_A
 #define crypt_sha_text crypt_sha_text_A
 #define crypt_sha_file crypt_sha_file_A
+#define crypt_shake_text crypt_shake_text_A
+#define crypt_fuzzy_file crypt_fuzzy_file_A
+#define crypt_fuzzy_to_string crypt_fuzzy_to_string_A
+#define crypt_fuzzy_from_string crypt_fuzzy_from_string_A
 #endif
 
 /* -------------------------------------- Public Class(es) -------------------------------------- */
@@ -1025,6 +1563,158 @@ private:
   size_t m_size;
 };
 
+/**
+ * Type-Safe String Format
+ */
+
+#include "template/strfmt.tpl"
+
+/**
+ * Keccak - SHA-3 & SHAKE (Incremental)
+ */
+
+class KeccakX
+{
+public:
+  KeccakX(const KeccakX& right);
+  virtual ~KeccakX();
+
+  const KeccakX& operator=(const KeccakX& right);
+
+  void vuapi update(const void* ptr, const size_t size);
+  void vuapi update(const std::vector<byte>& data);
+  void vuapi update(const Buffer& data);
+
+protected:
+  KeccakX();
+
+protected:
+  sha3_state* m_ptr_state;
+};
+
+class SHA3 : public KeccakX
+{
+public:
+  SHA3(const crypt_bits bits = crypt_bits::_256); // 224, 256, 384, 512
+  virtual ~SHA3();
+
+  void vuapi reset();
+  void vuapi finalize(std::vector<byte>& hash); // the context is reset after finalizing
+
+private:
+  crypt_bits m_bits;
+};
+
+class SHAKE : public KeccakX
+{
+public:
+  SHAKE(const crypt_bits bits = crypt_bits::_256); // 128, 256
+  virtual ~SHAKE();
+
+  void vuapi reset();
+  void vuapi squeeze(void* ptr, const size_t size); // can be called many times to extend the output
+  void vuapi squeeze(std::vector<byte>& data, const size_t size);
+
+private:
+  crypt_bits m_bits;
+};
+
+/**
+ * Content-Defined Chunking (FastCDC)
+ * The chunk boundaries are picked by the Gear rolling hash with the normalized chunking,
+ * so they survive the insertions & deletions in the data.
+ */
+
+struct CDCChunk
+{
+  uint64 offset;            // The offset of the chunk in the whole data
+  size_t size;              // The size of the chunk
+  uint64 hash;              // The fast hash (XXH64) of the chunk
+  std::vector<byte> digest; // The SHA digest of the chunk (empty if it's not enabled)
+  CDCChunk() : offset(0), size(0), hash(0) {}
+};
+
+class FastCDC
+{
+public:
+  // The chunk data is only valid inside the callback, return false to stop chunking.
+  typedef std::function<bool(const CDCChunk& chunk, const byte* ptr)> fn_chunk_t;
+
+  FastCDC(const size_t min_size = 2 * KiB, const size_t avg_size = 8 * KiB, const size_t max_size = 64 * KiB);
+  virtual ~FastCDC();
+
+  void vuapi set_digest(const sha_version version, const crypt_bits bits);
+  void vuapi reset();
+
+  bool vuapi update(const void* ptr, const size_t size, const fn_chunk_t fn);
+  bool vuapi finalize(const fn_chunk_t fn);
+
+  std::vector<CDCChunk> vuapi chunk(const void* ptr, const size_t size);
+  std::vector<CDCChunk> vuapi chunk(const Buffer& data);
+  std::vector<CDCChunk> vuapi chunk_file(const std::string&  file_path);
+  std::vector<CDCChunk> vuapi chunk_file(const std::wstring& file_path);
+  bool vuapi chunk_file(const std::string&  file_path, const fn_chunk_t fn);
+  bool vuapi chunk_file(const std::wstring& file_path, const fn_chunk_t fn);
+
+private:
+  size_t vuapi cut(const byte* ptr, const size_t size, bool& found) const;
+  bool vuapi emit(const byte* ptr, const size_t size, const fn_chunk_t& fn);
+
+  template <class file_mapping_t, typename std_string_t>
+  bool chunk_file_T(const std_string_t& file_path, const fn_chunk_t& fn);
+
+private:
+  size_t m_min_size;
+  size_t m_avg_size;
+  size_t m_max_size;
+  uint64 m_mask_s;
+  uint64 m_mask_l;
+  sha_version m_digest_version;
+  crypt_bits m_digest_bits;
+  uint64 m_offset;
+  std::vector<byte> m_pending;
+};
+
+/**
+ * Fuzzy Hashing (TLSH-style locality-sensitive hashing)
+ * The similar data have the close hashes, the distance is 0 for the same & grows with the differences.
+ * The distance depends on the data, eg. changing 1% of the bytes of 1 MiB scores about 1-15 for
+ * the structured data & 20-35 for the random data, the unrelated data score about 300.
+ * The hashes are fixed-size PODs, so a corpus is stored contiguously & compared in a linear scan.
+ */
+
+struct FuzzyHash
+{
+  static const size_t BUCKETS   = 128; // The number of the buckets of the triplets
+  static const size_t MIN_SIZE  = 50;  // The minimum size of the data to be hashed
+  static const size_t TEXT_SIZE = 72;  // The length of the text form
+
+  uint64 body_hi[2]; // The high bits of the 2-bit quartile codes of the buckets
+  uint64 body_lo[2]; // The low bits of the 2-bit quartile codes of the buckets
+  byte checksum;
+  byte lvalue;       // The logarithmic length of the data
+  byte q1_ratio;
+  byte q2_ratio;
+  byte reserved[4];
+};
+
+bool vuapi crypt_fuzzy_buffer(const void* ptr, const size_t size, FuzzyHash& hash);
+bool vuapi crypt_fuzzy_buffer(const std::vector<byte>& data, FuzzyHash& hash);
+bool vuapi crypt_fuzzy_buffer(const Buffer& data, FuzzyHash& hash);
+bool vuapi crypt_fuzzy_file_A(const std::string& file_path, FuzzyHash& hash);
+bool vuapi crypt_fuzzy_file_W(const std::wstring& file_path, FuzzyHash& hash);
+
+std::string  vuapi crypt_fuzzy_to_string_A(const FuzzyHash& hash);
+std::wstring vuapi crypt_fuzzy_to_string_W(const FuzzyHash& hash);
+bool vuapi crypt_fuzzy_from_string_A(const std::string& text, FuzzyHash& hash);
+bool vuapi crypt_fuzzy_from_string_W(const std::wstring& text, FuzzyHash& hash);
+
+int  vuapi crypt_fuzzy_compare(const FuzzyHash& left, const FuzzyHash& right);
+void vuapi crypt_fuzzy_compare(
+  const FuzzyHash& hash, const FuzzyHash* hashes, const size_t count, int* distances);
+void vuapi crypt_fuzzy_compare(
+  const FuzzyHash& hash, const std::vector<FuzzyHash>& hashes, std::vector<int>& distances);
+
 /**
  * Library
  */
@@ -1556,6 +2246,7 @@ enum fs_attribute
   FA_OFFLINE          = 0x00001000,   // FILE_ATTRIBUTE_OFFLINE              = $00001000;
   FANOTCONTENTINDEXED = 0x00002000,   // FILE_ATTRIBUTE_NOT_CONTENT_INDEXED  = $00002000;
   FAENCRYPTED         = 0x00004000,   // FILE_ATTRIBUTE_ENCRYPTED            = $00004000;
+  FA_SEQUENTIALSCAN   = 0x08000000,   // FILE_FLAG_SEQUENTIAL_SCAN           = $08000000;
 };
 
 enum fs_share
@@ -1862,8 +2553,20 @@ public:
   );
 
   ulong vuapi get_file_size();
+  uint64 vuapi get_file_size_ex(); // For the large file (>= 4 GiB)
   void vuapi close();
 
+  /**
+   * Maps the file one window after another (the window size is aligned to the allocation granularity),
+   * each window is prefetched (Windows 8+) and unmapped right after the callback returns.
+   * The callback returns false to stop iterating.
+   */
+  VUResult vuapi iterate_views(
+    const std::function<bool(const void* ptr, const size_t size, const uint64 offset)> fn,
+    const size_t window_size = 64 * MiB,
+    desired_access the_desired_access = desired_access::DA_READ
+  );
+
 protected:
   bool valid(HANDLE handle);
 
@@ -2546,10 +3249,13 @@ typedef ThunkData32  ThunkData, *PThunkData;
 typedef PEHeader32   PEHeader,  *PPEHeader;
 #endif
 
+// The name handles are in the name pools of the PE file (the module names are case-insensitive)
+
 struct ImportDescriptorEx
 {
   ulong iid_id;
   std::string name;
+  StringPoolA::handle_t name_handle;
   PImportDescriptor ptr_iid;
 };
 
@@ -2557,6 +3263,7 @@ struct ImportModule
 {
   ulong iid_id;
   std::string name;
+  StringPoolA::handle_t name_handle;
   // ulong number_of_functions;
 };
 
@@ -2565,6 +3272,7 @@ struct ImportFunctionT
 {
   ulong iid_id;
   std::string name;
+  StringPoolA::handle_t name_handle;
   T ordinal;
   ushort hint;
   T rva;
@@ -2603,6 +3311,7 @@ public:
   T vuapi offset_to_rva(T Offset, bool in_cache = true);
 
   const std::vector<PSectionHeader>& vuapi get_setion_headers(bool in_cache = true);
+  const std::vector<double> vuapi get_section_entropies(bool in_cache = true); // same order as the section headers
 
   const std::vector<PImportDescriptor>& vuapi get_import_descriptors(bool in_cache = true);
   const std::vector<ImportModule> vuapi get_import_modules(bool in_cache = true);
@@ -2626,6 +3335,7 @@ protected:
   bool m_initialized;
 
   void* m_ptr_base;
+  uint64 m_size;
 
   DOSHeader* m_ptr_dos_header;
   TPEHeaderT<T>* m_ptr_pe_header;
@@ -2641,6 +3351,10 @@ private:
   std::vector<ImportFunctionT<T>> m_import_functions;
   std::vector<RelocationEntryT<T>> m_relocation_entries;
 
+  // shared by the copies, the handles of a copy stay valid
+  std::shared_ptr<StringPoolA> m_ptr_module_names;
+  std::shared_ptr<StringPoolA> m_ptr_function_names;
+
 protected:
   const std::vector<ImportDescriptorEx>& vuapi get_ex_iids(bool in_cache = true);
 };
@@ -2686,13 +3400,13 @@ public:
   virtual ~FundamentalA();
 
   template<typename T>
-  friend FundamentalA& operator<<(FundamentalA& stream, T v)
+  friend FundamentalA& operator<<(FundamentalA& stream, const T& v)
   {
-    stream.m_data << v;
+    stream.append(v);
     return stream;
   }
 
-  std::stringstream& vuapi data();
+  std::string& vuapi data();
   std::string vuapi to_string() const;
   int vuapi to_integer() const;
   long vuapi to_long() const;
@@ -2701,7 +3415,19 @@ public:
   double vuapi to_double() const;
 
 private:
-  std::stringstream m_data;
+  void append(const std::string& v) { m_data.append(v); }
+  void append(const StringViewA& v) { m_data.append(v.data(), v.size()); }
+  void append(const char* v) { m_data.append(v == nullptr ? "" : v); }
+  void append(const char v)  { m_data.push_back(v); }
+
+  template<typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value>::type append(const T v)
+  {
+    m_data.append(number_to_string_A(v));
+  }
+
+private:
+  std::string m_data;
 };
 
 class FundamentalW
@@ -2711,13 +3437,13 @@ public:
   virtual ~FundamentalW();
 
   template<typename T>
-  friend FundamentalW& operator<<(FundamentalW& stream, T v)
+  friend FundamentalW& operator<<(FundamentalW& stream, const T& v)
   {
-    stream.m_data << v;
+    stream.append(v);
     return stream;
   }
 
-  std::wstringstream& vuapi data();
+  std::wstring& vuapi data();
   std::wstring vuapi to_string() const;
   int vuapi to_integer() const;
   long vuapi to_long() const;
@@ -2726,7 +3452,19 @@ public:
   double vuapi to_double() const;
 
 private:
-  std::wstringstream m_data;
+  void append(const std::wstring& v) { m_data.append(v); }
+  void append(const StringViewW& v) { m_data.append(v.data(), v.size()); }
+  void append(const wchar* v) { m_data.append(v == nullptr ? L"" : v); }
+  void append(const wchar v)  { m_data.push_back(v); }
+
+  template<typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value>::type append(const T v)
+  {
+    m_data.append(number_to_string_W(v));
+  }
+
+private:
+  std::wstring m_data;
 };
 
 /**
@@ -3124,27 +3862,352 @@ private:
  */
 
 #define MAX_NTHREADS -1
+#define ANY_NUMA_NODE -1
+
+enum class thread_pool_type
+{
+  TP_SHARED_QUEUE  = 0, // threadpool11, a single locked queue shared by all workers
+  TP_WORK_STEALING = 1, // a Chase-Lev deque per worker, idle workers steal from random victims
+};
+
+enum class thread_pool_affinity
+{
+  TA_NONE      = 0, // the workers run on any processor
+  TA_CORE      = 1, // each worker is pinned to a logical processor
+  TA_NUMA_NODE = 2, // each worker is pinned to the processors of a NUMA node
+};
+
+/**
+ * ThreadPoolOptions
+ * The workers are spread over the NUMA nodes in turn, and over the processors of each node.
+ * With `numa_sub_pools` the work-stealing pool keeps an injection queue per node. A task that's
+ * added by an outside thread goes to the queue of the node that runs the thread (or the node of
+ * its hint), and a worker takes the tasks of its own node before it steals from the other nodes.
+ * The workers of a sub-pool are pinned to their node at least, else they could drift off it.
+ * The affinity is applied only to the work-stealing pool, threadpool11 doesn't expose its threads.
+ */
+
+struct ThreadPoolOptions
+{
+  size_t n_threads;
+  thread_pool_type type;
+  thread_pool_affinity affinity;
+  bool numa_sub_pools;
+
+  ThreadPoolOptions(
+    size_t n_threads = MAX_NTHREADS,
+    thread_pool_type type = thread_pool_type::TP_WORK_STEALING,
+    thread_pool_affinity affinity = thread_pool_affinity::TA_NONE,
+    bool numa_sub_pools = false);
+};
+
+class ThreadPoolImpl;
+
+template <typename T>
+class TaskFutureT;
+
+/**
+ * ThreadPoolStatistics
+ * A snapshot of the counters of a pool. The counters are kept per worker by the worker itself
+ * without any lock, so taking a snapshot is cheap and doesn't slow down the workers, but the
+ * values of the different counters may be a few tasks apart.
+ * The histograms are in log2 buckets of nanoseconds, the bucket `i` counts the durations in
+ * [2^i, 2^(i+1)) ns. They are filled only while the timing is enabled.
+ */
+
+struct ThreadPoolStatistics
+{
+  static const size_t NUM_BUCKETS = 40;
+
+  struct Worker
+  {
+    uint64 tasks_submitted; // by the tasks that run on this worker
+    uint64 tasks_completed;
+    uint64 steals;
+    std::chrono::nanoseconds idle_time;
+  };
+
+  uint64 tasks_submitted;
+  uint64 tasks_completed;
+  uint64 steals;
+  std::vector<Worker> workers; // empty for the shared-queue pool
+
+  uint64 queue_wait_histogram[NUM_BUCKETS];
+  uint64 run_time_histogram[NUM_BUCKETS];
+
+  ThreadPoolStatistics();
+
+  uint64 tasks_pending() const;
+
+  /**
+   * The upper bound of the bucket that reaches the `percent` of the samples (eg. 99 for p99).
+   */
+  static std::chrono::nanoseconds percentile(const uint64 (&histogram)[NUM_BUCKETS], double percent);
+};
+
+/**
+ * ThreadPool
+ * The work-stealing backend is the default, the tasks added by a worker of the pool go to its own
+ * deque (LIFO), the tasks added by other threads go to a lock-free injection queue (FIFO).
+ * The destructor waits for the pending tasks before stopping the workers, so the pool must not be
+ * destroyed by one of its own tasks.
+ */
 
 class ThreadPool
 {
 public:
-  ThreadPool(size_t n_threads = MAX_NTHREADS);
+  ThreadPool(size_t n_threads = MAX_NTHREADS, thread_pool_type type = thread_pool_type::TP_WORK_STEALING);
+  ThreadPool(const ThreadPoolOptions& options);
   virtual ~ThreadPool();
 
+  thread_pool_type type() const;
+
   void add_task(fn_task_t&& fn);
   void launch();
 
+  /**
+   * Adds a task with a hint of the NUMA node (the number of the system) that it should run on,
+   * eg. the node that holds its data. It's ignored if the pool has no sub-pool per node.
+   */
+  void add_task(fn_task_t&& fn, size_t numa_node);
+
+  /**
+   * Adds a task and returns its future, that holds the result or the exception of the task.
+   */
+  template <typename fn_t>
+  TaskFutureT<typename std::result_of<fn_t()>::type> submit(fn_t fn);
+
+  template <typename fn_t>
+  TaskFutureT<typename std::result_of<fn_t()>::type> submit(fn_t fn, size_t numa_node);
+
+  /**
+   * Runs a pending task on the calling thread, returns false if there is none to run.
+   * The shared-queue pool has no task to share this way so it always returns false.
+   */
+  bool run_pending_task();
+
+  /**
+   * Checks the calling thread is a worker of this pool.
+   */
+  bool in_worker_thread() const;
+
+  /**
+   * Gets the index of the calling worker in [0, worker_count()), or -1 if it's not a worker.
+   */
+  size_t worker_index() const;
+
+  /**
+   * Gets the number of the tasks that wait in the calling worker's own deque (the tasks that the
+   * idle workers can steal from it), or in the injection queue for the other threads.
+   */
+  size_t local_task_count() const;
+
+  /**
+   * The default pool of the parallel algorithms, it's created on the first use and lives until
+   * the process exits.
+   */
+  static ThreadPool& global();
+
+  /**
+   * Gets the number of the sub-pools (one per NUMA node), or 1 if the pool has none.
+   */
+  size_t numa_node_count() const;
+
+  /**
+   * Gets the NUMA node (the number of the system) of the calling worker's sub-pool, or -1 if
+   * it's not a worker or the pool has no sub-pool per node.
+   */
+  size_t numa_node() const;
+
   size_t worker_count() const;
   size_t work_queue_count() const;
 
   size_t active_worker_count() const;
   size_t inactive_worker_count() const;
 
+  /**
+   * Takes a snapshot of the counters, it's cheap enough to be sampled periodically.
+   */
+  ThreadPoolStatistics statistics() const;
+
+  /**
+   * Records the queue wait and the run time of each task into the histograms (off by default),
+   * it costs a few clock reads per task.
+   */
+  void enable_timing(bool state = true);
+
+private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+  void initialize(ThreadPoolOptions options);
+
 private:
-  Pool* m_ptr_impl;
+  thread_pool_type m_type;
+  ThreadPoolImpl* m_ptr_impl;
 };
 
+/**
+ * TaskState
+ * The completion state that is shared by a submitted task and its futures. The waiting and the
+ * continuations take a lock (striped by the address of the state) only if someone observes the
+ * task before it is completed, so a task that nobody waits for completes without any lock.
+ * A worker of the work-stealing pool runs the pending tasks while waiting instead of blocking.
+ */
+
+class TaskState
+{
+public:
+  TaskState(ThreadPool* ptr_pool);
+  virtual ~TaskState();
+
+  ThreadPool* pool() const;
+
+  bool ready() const;
+  bool failed() const;
+
+  void wait() const;
+  bool wait_for(const std::chrono::milliseconds& timeout) const;
+
+  /**
+   * Runs `fn` right away if the task is completed, else by the thread that completes the task.
+   */
+  void on_ready(fn_task_t&& fn);
+
+  void set_exception(std::exception_ptr ptr_exception);
+
+protected:
+  void set_ready();
+  void rethrow_if_failed() const;
+
+private:
+  TaskState(const TaskState&);
+  TaskState& operator=(const TaskState&);
+
+private:
+  ThreadPool* m_ptr_pool;
+  std::atomic<bool> m_ready;
+  mutable std::atomic<uint> m_observers;
+  std::exception_ptr m_ptr_exception;
+  std::vector<fn_task_t> m_continuations;
+};
+
+#include "template/future.tpl"
 #include "template/stlthread.tpl"
+#include "template/parallel.tpl"
+
+/**
+ * TaskGraph
+ * A graph of tasks (DAG) that runs on a thread pool. A task is started as soon as all of the tasks
+ * that precede it are done, so the independent branches overlap instead of waiting at a barrier.
+ * A task that is added by `add_dynamic()` gets a context to spawn sub-tasks, it's done only when
+ * all of its sub-tasks are done too. The graph is kept after a run so it can be run again (but
+ * not twice at the same time), and it must not be changed or destroyed while it's running.
+ * If a task throws, the tasks that are not started yet are skipped and the run fails with it.
+ * Eg.
+ *   vu::TaskGraph graph;
+ *   auto parse  = graph.add("parse",  []() { ... });
+ *   auto hash   = graph.add("hash",   []() { ... });
+ *   auto scan   = graph.add("scan",   []() { ... });
+ *   auto report = graph.add("report", []() { ... });
+ *   graph.precede(parse, hash);
+ *   graph.precede(parse, scan);
+ *   graph.succeed(report, hash);
+ *   graph.succeed(report, scan);
+ *   graph.run();
+ */
+
+class TaskGraphImpl;
+
+class TaskGraph
+{
+public:
+  typedef size_t node_t;
+
+  static const node_t INVALID_NODE = node_t(-1);
+
+  /**
+   * The context of a running task, it's cheap to copy so a sub-task can take it to spawn more.
+   */
+  class Context
+  {
+  public:
+    Context(TaskGraphImpl& graph, node_t node);
+
+    node_t node() const;
+    void spawn(fn_task_t&& fn);
+
+  private:
+    TaskGraphImpl* m_ptr_graph;
+    node_t m_node;
+  };
+
+  typedef std::function<void(Context& context)> fn_node_t;
+
+  struct Timing
+  {
+    node_t node;
+    std::string name;
+    std::chrono::nanoseconds start;    // since the run was started
+    std::chrono::nanoseconds duration; // including its sub-tasks
+  };
+
+  TaskGraph();
+  virtual ~TaskGraph();
+
+  node_t add(const std::string& name, fn_task_t fn);
+  node_t add_dynamic(const std::string& name, fn_node_t fn);
+
+  /**
+   * `successor` runs after `node` (and `node` runs before `successor`).
+   */
+  void precede(node_t node, node_t successor);
+  void succeed(node_t node, node_t predecessor);
+
+  void clear();
+  size_t size() const;
+  const std::string& name(node_t node) const;
+
+  /**
+   * Checks the graph has no cycle, a graph with a cycle can't be run.
+   */
+  bool acyclic() const;
+  bool running() const;
+
+  /**
+   * Runs the graph on the pool (the global pool by default) and waits for it, rethrows the
+   * exception of the first failed task. Returns false without running anything if it has a cycle.
+   */
+  bool run(ThreadPool* ptr_pool = nullptr);
+
+  /**
+   * Starts the graph on the pool and returns the future of the run.
+   */
+  TaskFutureT<void> run_async(ThreadPool* ptr_pool = nullptr);
+
+  /**
+   * Records the start and the duration of each task of the next runs (off by default).
+   */
+  void enable_timing(bool state = true);
+
+  /**
+   * The timing of the tasks of the last completed run (the skipped tasks are not included).
+   */
+  std::vector<Timing> timings() const;
+
+  /**
+   * The chain of dependent tasks that has the longest total duration in the last completed run,
+   * that bounds the duration of the whole run however many workers there are.
+   */
+  std::vector<node_t> critical_path(std::chrono::nanoseconds* ptr_length = nullptr) const;
+
+private:
+  TaskGraph(const TaskGraph&);
+  TaskGraph& operator=(const TaskGraph&);
+
+private:
+  TaskGraphImpl* m_ptr_impl;
+};
 
 /**
  * Path
@@ -3487,6 +4550,10 @@ private:
 #define Fundamental FundamentalW
 #define Picker PickerW
 #define RESTClient RESTClientW
+#define StringView StringViewW
+#define Tokenizer TokenizerW
+#define Regex RegexW
+#define DateTimeFormatter DateTimeFormatterW
 #else // _UNICODE
 #define UIDGlobal GUIDA
 #define INLHooking INLHookingA
@@ -3506,6 +4573,10 @@ private:
 #define Fundamental FundamentalA
 #define Picker PickerA
 #define RESTClient RESTClientA
+#define StringView StringViewA
+#define Tokenizer TokenizerA
+#define Regex RegexA
+#define DateTimeFormatter DateTimeFormatterA
 #endif // _UNICODE
 
 } // namespace vu
@@ -0,0 +1,503 @@
+/**
+ * @file   future.tpl
+ * @author Vic P.
+ * @brief  Template for Task Future
+ */
+
+/**
+ * TaskStateT
+ * The completion state with the result of a task.
+ */
+
+template <typename T>
+class TaskStateT : public TaskState
+{
+public:
+  typedef const T& result_t;
+
+  TaskStateT(ThreadPool* ptr_pool) : TaskState(ptr_pool), m_has_value(false) {}
+
+  virtual ~TaskStateT()
+  {
+    if (m_has_value)
+    {
+      reinterpret_cast<T*>(&m_storage)->~T();
+    }
+  }
+
+  template <typename V>
+  void set_value(V&& value)
+  {
+    new (&m_storage) T(std::forward<V>(value));
+    m_has_value = true;
+    this->set_ready();
+  }
+
+  const T& get() const
+  {
+    this->wait();
+    this->rethrow_if_failed();
+    return *reinterpret_cast<const T*>(&m_storage);
+  }
+
+private:
+  typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type m_storage;
+  bool m_has_value;
+};
+
+template <>
+class TaskStateT<void> : public TaskState
+{
+public:
+  typedef void result_t;
+
+  TaskStateT(ThreadPool* ptr_pool) : TaskState(ptr_pool) {}
+
+  void set_value()
+  {
+    this->set_ready();
+  }
+
+  void get() const
+  {
+    this->wait();
+    this->rethrow_if_failed();
+  }
+};
+
+/**
+ * TaskRunnerT
+ * Runs a function and stores its result or its exception into a task state.
+ */
+
+template <typename R>
+struct TaskRunnerT
+{
+  template <typename fn_t>
+  static void run(TaskStateT<R>& state, fn_t& fn)
+  {
+    try
+    {
+      state.set_value(fn());
+    }
+    catch (...)
+    {
+      state.set_exception(std::current_exception());
+    }
+  }
+};
+
+template <>
+struct TaskRunnerT<void>
+{
+  template <typename fn_t>
+  static void run(TaskStateT<void>& state, fn_t& fn)
+  {
+    try
+    {
+      fn();
+      state.set_value();
+    }
+    catch (...)
+    {
+      state.set_exception(std::current_exception());
+    }
+  }
+};
+
+/**
+ * TaskContinuationT
+ * Calls a continuation with the result of its antecedent task.
+ */
+
+template <typename T>
+struct TaskContinuationT
+{
+  template <typename fn_t>
+  struct result
+  {
+    typedef typename std::result_of<fn_t(const T&)>::type type;
+  };
+
+  template <typename fn_t>
+  static typename result<fn_t>::type invoke(fn_t& fn, const TaskStateT<T>& antecedent)
+  {
+    return fn(antecedent.get());
+  }
+};
+
+template <>
+struct TaskContinuationT<void>
+{
+  template <typename fn_t>
+  struct result
+  {
+    typedef typename std::result_of<fn_t()>::type type;
+  };
+
+  template <typename fn_t>
+  static typename result<fn_t>::type invoke(fn_t& fn, const TaskStateT<void>& antecedent)
+  {
+    antecedent.get();
+    return fn();
+  }
+};
+
+/**
+ * TaskFutureT
+ * The handle of a submitted task, it's cheap to copy and all copies refer to the same task.
+ * The result is kept by the future so `get()` can be called many times, and it rethrows the
+ * exception of the task. A continuation that is added by `then()` runs on the pool with the
+ * result of this task, if this task failed then the continuation is skipped and its future
+ * fails with the same exception.
+ * Eg.
+ *   auto f = pool.submit([]() { return 1; }).then([](int v) { return v + 1; });
+ *   f.get(); // 2
+ */
+
+template <typename T>
+class TaskFutureT
+{
+public:
+  typedef T value_type;
+  typedef TaskStateT<T> state_t;
+
+  TaskFutureT() {}
+  TaskFutureT(const std::shared_ptr<state_t>& ptr_state) : m_ptr_state(ptr_state) {}
+
+  bool valid() const
+  {
+    return m_ptr_state != nullptr;
+  }
+
+  bool ready() const
+  {
+    assert(this->valid());
+    return m_ptr_state->ready();
+  }
+
+  bool failed() const
+  {
+    assert(this->valid());
+    return m_ptr_state->failed();
+  }
+
+  void wait() const
+  {
+    assert(this->valid());
+    m_ptr_state->wait();
+  }
+
+  bool wait_for(const std::chrono::milliseconds& timeout) const
+  {
+    assert(this->valid());
+    return m_ptr_state->wait_for(timeout);
+  }
+
+  typename state_t::result_t get() const
+  {
+    assert(this->valid());
+    return m_ptr_state->get();
+  }
+
+  template <typename fn_t>
+  TaskFutureT<typename TaskContinuationT<T>::template result<fn_t>::type> then(fn_t fn) const
+  {
+    assert(this->valid());
+
+    typedef typename TaskContinuationT<T>::template result<fn_t>::type result_t;
+
+    auto ptr_antecedent = m_ptr_state;
+    auto ptr_pool = ptr_antecedent->pool();
+    std::shared_ptr<TaskStateT<result_t>> ptr_state(new TaskStateT<result_t>(ptr_pool));
+
+    fn_task_t continuation = [ptr_antecedent, ptr_state, fn]() mutable
+    {
+      auto invoker = [&]() { return TaskContinuationT<T>::invoke(fn, *ptr_antecedent); };
+      TaskRunnerT<result_t>::run(*ptr_state, invoker);
+    };
+
+    if (ptr_pool == nullptr) // eg. when_all of nothing, run it by the thread that completes this task
+    {
+      ptr_antecedent->on_ready(std::move(continuation));
+    }
+    else
+    {
+      ptr_antecedent->on_ready([ptr_pool, continuation]() mutable
+      {
+        ptr_pool->add_task(std::move(continuation));
+      });
+    }
+
+    return TaskFutureT<result_t>(ptr_state);
+  }
+
+  const std::shared_ptr<state_t>& state() const
+  {
+    return m_ptr_state;
+  }
+
+private:
+  std::shared_ptr<state_t> m_ptr_state;
+};
+
+/**
+ * ThreadPool::submit
+ */
+
+template <typename fn_t>
+TaskFutureT<typename std::result_of<fn_t()>::type> ThreadPool::submit(fn_t fn)
+{
+  return this->submit(fn, size_t(ANY_NUMA_NODE));
+}
+
+template <typename fn_t>
+TaskFutureT<typename std::result_of<fn_t()>::type> ThreadPool::submit(fn_t fn, size_t numa_node)
+{
+  typedef typename std::result_of<fn_t()>::type result_t;
+
+  std::shared_ptr<TaskStateT<result_t>> ptr_state(new TaskStateT<result_t>(this));
+
+  this->add_task([ptr_state, fn]() mutable
+  {
+    TaskRunnerT<result_t>::run(*ptr_state, fn);
+  }, numa_node);
+
+  return TaskFutureT<result_t>(ptr_state);
+}
+
+/**
+ * when_all
+ * The future that is completed when all of the futures are completed, with their results in order.
+ * It fails with the exception of the first failed future (in order).
+ */
+
+template <typename T>
+struct WhenAllT
+{
+  typedef std::vector<T> result_t;
+
+  static void complete(TaskStateT<result_t>& state, const std::vector<TaskFutureT<T>>& futures)
+  {
+    result_t results;
+    results.reserve(futures.size());
+
+    for (const auto& e : futures)
+    {
+      results.push_back(e.get());
+    }
+
+    state.set_value(std::move(results));
+  }
+};
+
+template <>
+struct WhenAllT<void>
+{
+  typedef void result_t;
+
+  static void complete(TaskStateT<result_t>& state, const std::vector<TaskFutureT<void>>& futures)
+  {
+    for (const auto& e : futures)
+    {
+      e.get();
+    }
+
+    state.set_value();
+  }
+};
+
+template <typename T>
+TaskFutureT<typename WhenAllT<T>::result_t> when_all(const std::vector<TaskFutureT<T>>& futures)
+{
+  typedef typename WhenAllT<T>::result_t result_t;
+
+  auto ptr_pool = futures.empty() ? nullptr : futures.front().state()->pool();
+  std::shared_ptr<TaskStateT<result_t>> ptr_state(new TaskStateT<result_t>(ptr_pool));
+
+  auto ptr_futures = std::make_shared<std::vector<TaskFutureT<T>>>(futures);
+  auto ptr_remaining = std::make_shared<std::atomic<size_t>>(futures.size() + 1);
+
+  fn_task_t fn_complete = [ptr_state, ptr_futures, ptr_remaining]()
+  {
+    if (ptr_remaining->fetch_sub(1) == 1)
+    {
+      try
+      {
+        WhenAllT<T>::complete(*ptr_state, *ptr_futures);
+      }
+      catch (...)
+      {
+        ptr_state->set_exception(std::current_exception());
+      }
+    }
+  };
+
+  for (const auto& e : futures)
+  {
+    assert(e.valid());
+    auto fn = fn_complete;
+    e.state()->on_ready(std::move(fn));
+  }
+
+  fn_complete(); // the extra count, so it can't be completed while the continuations are being added
+
+  return TaskFutureT<result_t>(ptr_state);
+}
+
+template <typename T>
+struct IsTaskFutureT : std::false_type {};
+
+template <typename T>
+struct IsTaskFutureT<TaskFutureT<T>> : std::true_type {};
+
+template <typename iterator_t, bool is_future = IsTaskFutureT<iterator_t>::value>
+struct WhenAllRangeT
+{
+  typedef typename std::iterator_traits<iterator_t>::value_type future_t;
+  typedef typename WhenAllT<typename future_t::value_type>::result_t result_t;
+};
+
+template <typename iterator_t>
+struct WhenAllRangeT<iterator_t, true> {}; // two futures are not a range, it's the variadic when_all
+
+template <typename iterator_t>
+TaskFutureT<typename WhenAllRangeT<iterator_t>::result_t> when_all(iterator_t first, iterator_t last)
+{
+  typedef typename WhenAllRangeT<iterator_t>::future_t future_t;
+  return when_all(std::vector<future_t>(first, last));
+}
+
+/**
+ * when_all (variadic)
+ * The future of the tuple of the results of the futures (of any types), a void future is a nullptr
+ * in the tuple. It's a void future if all of the futures are void.
+ * Eg.
+ *   auto f = vu::when_all(pool.submit(fn_int), pool.submit(fn_string)); // TaskFutureT<std::tuple<int, std::string>>
+ */
+
+template <typename T>
+struct WhenAllValueT
+{
+  typedef T type;
+  static T get(const TaskFutureT<T>& future) { return future.get(); }
+};
+
+template <>
+struct WhenAllValueT<void>
+{
+  typedef std::nullptr_t type;
+  static std::nullptr_t get(const TaskFutureT<void>& future) { future.get(); return nullptr; }
+};
+
+template <typename... T>
+struct WhenAllVoidT;
+
+template <>
+struct WhenAllVoidT<> : std::true_type {};
+
+template <typename T, typename... R>
+struct WhenAllVoidT<T, R...> : std::integral_constant<bool, std::is_void<T>::value && WhenAllVoidT<R...>::value> {};
+
+template <bool all_void, typename... T>
+struct WhenAllTupleT
+{
+  typedef std::tuple<typename WhenAllValueT<T>::type...> result_t;
+
+  static void complete(TaskStateT<result_t>& state, const TaskFutureT<T>&... futures)
+  {
+    state.set_value(result_t { WhenAllValueT<T>::get(futures)... }); // the braced list is evaluated in order
+  }
+};
+
+template <typename... T>
+struct WhenAllTupleT<true, T...>
+{
+  typedef void result_t;
+
+  static void complete(TaskStateT<result_t>& state, const TaskFutureT<T>&... futures)
+  {
+    const int order[] = { (futures.get(), 0)... };
+    UNREFERENCED_PARAMETER(order);
+    state.set_value();
+  }
+};
+
+template <typename... T>
+struct WhenAllOfT : WhenAllTupleT<WhenAllVoidT<T...>::value, T...> {};
+
+template <typename T, typename... R>
+TaskFutureT<typename WhenAllOfT<T, R...>::result_t> when_all(const TaskFutureT<T>& first, const TaskFutureT<R>&... rest)
+{
+  typedef WhenAllOfT<T, R...> when_all_t;
+  typedef typename when_all_t::result_t result_t;
+
+  assert(first.valid());
+
+  auto ptr_pool = first.state()->pool();
+  std::shared_ptr<TaskStateT<result_t>> ptr_state(new TaskStateT<result_t>(ptr_pool));
+
+  auto ptr_remaining = std::make_shared<std::atomic<size_t>>(sizeof...(R) + 2);
+
+  fn_task_t fn_complete = [ptr_state, ptr_remaining, first, rest...]()
+  {
+    if (ptr_remaining->fetch_sub(1) == 1)
+    {
+      try
+      {
+        when_all_t::complete(*ptr_state, first, rest...);
+      }
+      catch (...)
+      {
+        ptr_state->set_exception(std::current_exception());
+      }
+    }
+  };
+
+  first.state()->on_ready(fn_task_t(fn_complete));
+
+  const int order[] = { 0, (assert(rest.valid()), rest.state()->on_ready(fn_task_t(fn_complete)), 0)... };
+  UNREFERENCED_PARAMETER(order);
+
+  fn_complete(); // the extra count, so it can't be completed while the continuations are being added
+
+  return TaskFutureT<result_t>(ptr_state);
+}
+
+/**
+ * when_any
+ * The future of the index of the first completed future (whether it succeeded or failed).
+ */
+
+template <typename T>
+TaskFutureT<size_t> when_any(const std::vector<TaskFutureT<T>>& futures)
+{
+  assert(!futures.empty());
+
+  auto ptr_pool = futures.front().state()->pool();
+  std::shared_ptr<TaskStateT<size_t>> ptr_state(new TaskStateT<size_t>(ptr_pool));
+
+  auto ptr_done = std::make_shared<std::atomic<bool>>(false);
+
+  for (size_t i = 0; i < futures.size(); i++)
+  {
+    assert(futures[i].valid());
+
+    futures[i].state()->on_ready([ptr_state, ptr_done, i]()
+    {
+      if (!ptr_done->exchange(true))
+      {
+        ptr_state->set_value(i);
+      }
+    });
+  }
+
+  return TaskFutureT<size_t>(ptr_state);
+}
+
+template <typename iterator_t>
+TaskFutureT<size_t> when_any(iterator_t first, iterator_t last)
+{
+  typedef typename std::iterator_traits<iterator_t>::value_type future_t;
+  return when_any(std::vector<future_t>(first, last));
+}
@@ -0,0 +1,738 @@
+/**
+ * @file   parallel.tpl
+ * @author Vic P.
+ * @brief  Template for Parallel Algorithms
+ */
+
+/**
+ * ParallelLoopT
+ * Runs a chunk function over [first, last) on a pool with the lazy binary splitting, a range is
+ * split in half only when the current thread has no task left that the idle workers can steal,
+ * else it runs a chunk of `grain` items then checks again. So the range is split as deep as the
+ * other workers are taking the work, not up front. The caller runs the first range itself and
+ * helps the pool while waiting, so the loops can be nested. The chunk function returns false to
+ * stop the loop, the chunks that are running are finished but no new chunk is started.
+ */
+
+template <typename index_t, typename chunk_fn_t>
+class ParallelLoopT
+{
+public:
+  ParallelLoopT(ThreadPool& pool, chunk_fn_t& fn, size_t grain)
+    : m_pool(pool), m_fn(fn), m_grain(grain), m_pending(0), m_stopped(false), m_failed(false)
+  {
+  }
+
+  /**
+   * Returns false if the loop is stopped by the chunk function.
+   */
+  bool run(const index_t first, const index_t last)
+  {
+    if (!(first < last))
+    {
+      return true;
+    }
+
+    if (m_grain == 0)
+    {
+      m_grain = (std::max)(size_t(1), size_t(last - first) / (64 * (m_pool.worker_count() + 1)));
+    }
+
+    m_pending.store(1);
+
+    this->execute(first, last);
+
+    while (m_pending.load(std::memory_order_acquire) != 0)
+    {
+      if (!m_pool.run_pending_task())
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    if (m_failed)
+    {
+      std::rethrow_exception(m_ptr_exception);
+    }
+
+    return !m_stopped.load();
+  }
+
+  bool stopped() const
+  {
+    return m_stopped.load(std::memory_order_relaxed);
+  }
+
+private:
+  void execute(index_t begin, index_t end)
+  {
+    try
+    {
+      while (size_t(end - begin) > m_grain && !this->stopped())
+      {
+        if (m_pool.local_task_count() == 0)
+        {
+          const index_t middle = begin + (end - begin) / 2;
+
+          m_pending.fetch_add(1, std::memory_order_relaxed);
+          m_pool.add_task([this, middle, end]() { this->execute(middle, end); });
+
+          end = middle;
+        }
+        else
+        {
+          const index_t next = begin + m_grain;
+
+          if (!m_fn(begin, next))
+          {
+            m_stopped.store(true);
+          }
+
+          begin = next;
+        }
+      }
+
+      if (!this->stopped() && !m_fn(begin, end))
+      {
+        m_stopped.store(true);
+      }
+    }
+    catch (...)
+    {
+      if (!m_failed.exchange(true))
+      {
+        m_ptr_exception = std::current_exception();
+      }
+
+      m_stopped.store(true);
+    }
+
+    m_pending.fetch_sub(1, std::memory_order_release);
+  }
+
+private:
+  ParallelLoopT(const ParallelLoopT&);
+  ParallelLoopT& operator=(const ParallelLoopT&);
+
+private:
+  ThreadPool& m_pool;
+  chunk_fn_t& m_fn;
+  size_t m_grain;
+  std::atomic<size_t> m_pending;
+  std::atomic<bool> m_stopped;
+  std::atomic<bool> m_failed;
+  std::exception_ptr m_ptr_exception;
+};
+
+template <typename index_t, typename chunk_fn_t>
+bool parallel_chunks(index_t first, index_t last, chunk_fn_t& fn, size_t grain, ThreadPool* ptr_pool)
+{
+  ParallelLoopT<index_t, chunk_fn_t> loop(ptr_pool != nullptr ? *ptr_pool : ThreadPool::global(), fn, grain);
+  return loop.run(first, last);
+}
+
+/**
+ * LoopBodyT
+ * Calls a loop body, the body may return void or return_type (return_type::Break stops the loop).
+ */
+
+template <typename R>
+struct LoopBodyT
+{
+  template <typename fn_t, typename arg_t>
+  static bool call(fn_t& fn, arg_t&& arg)
+  {
+    fn(std::forward<arg_t>(arg));
+    return true;
+  }
+};
+
+template <>
+struct LoopBodyT<return_type>
+{
+  template <typename fn_t, typename arg_t>
+  static bool call(fn_t& fn, arg_t&& arg)
+  {
+    return fn(std::forward<arg_t>(arg)) != return_type::Break;
+  }
+};
+
+/**
+ * parallel_for
+ * Calls `fn(i)` for each index in [first, last) on the pool (the global pool by default).
+ * The body may return return_type::Break to stop the loop early, then it returns false.
+ * The grain is the number of indexes that are run without checking for splitting (0 is auto).
+ * The exception of a body stops the loop and is rethrown to the caller.
+ * Eg.
+ *   vu::parallel_for(0, int(items.size()), [&](int i) { items[i] *= 2; });
+ *   vu::parallel_for(size_t(0), n, [&](size_t i) { return found(i) ? vu::return_type::Break : vu::return_type::Ok; });
+ */
+
+template <typename index_t, typename fn_t>
+bool parallel_for(index_t first, index_t last, fn_t fn, size_t grain = 0, ThreadPool* ptr_pool = nullptr)
+{
+  typedef decltype(fn(first)) result_t;
+
+  auto chunk_fn = [&fn](index_t begin, index_t end) -> bool
+  {
+    for (auto i = begin; i != end; ++i)
+    {
+      if (!LoopBodyT<result_t>::call(fn, i))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  return parallel_chunks(first, last, chunk_fn, grain, ptr_pool);
+}
+
+/**
+ * parallel_for_each
+ * Calls `fn(item)` for each item in [first, last) of the random-access iterators, the same as
+ * parallel_for.
+ */
+
+template <typename iterator_t, typename fn_t>
+bool parallel_for_each(iterator_t first, iterator_t last, fn_t fn, size_t grain = 0, ThreadPool* ptr_pool = nullptr)
+{
+  typedef decltype(fn(*first)) result_t;
+
+  auto chunk_fn = [&fn](iterator_t begin, iterator_t end) -> bool
+  {
+    for (auto it = begin; it != end; ++it)
+    {
+      if (!LoopBodyT<result_t>::call(fn, *it))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  return parallel_chunks(first, last, chunk_fn, grain, ptr_pool);
+}
+
+/**
+ * parallel_reduce
+ * Returns `init` combined with `map(i)` of each index in [first, last). Each worker accumulates
+ * into its own slot (no shared lock), then the slots are combined, so `combine` must be
+ * associative and commutative.
+ * Eg.
+ *   auto sum = vu::parallel_reduce(size_t(0), v.size(), 0LL,
+ *     [&](size_t i) { return (long long)v[i]; }, [](long long l, long long r) { return l + r; });
+ */
+
+template <typename value_t>
+struct ReduceSlotT
+{
+  value_t value;
+  bool used;
+  char padding[64]; // keep the slots of the workers on different cache lines
+
+  ReduceSlotT(const value_t& init) : value(init), used(false) {}
+};
+
+template <typename index_t, typename value_t, typename map_t, typename combine_t>
+value_t parallel_reduce(
+  index_t first,
+  index_t last,
+  value_t init,
+  map_t map,
+  combine_t combine,
+  size_t grain = 0,
+  ThreadPool* ptr_pool = nullptr)
+{
+  auto& pool = ptr_pool != nullptr ? *ptr_pool : ThreadPool::global();
+
+  // a slot per worker, a slot for the caller, then the other threads that help the pool share
+  // the locked last slot
+
+  const auto n_workers = pool.worker_count();
+  const auto caller_id = std::this_thread::get_id();
+
+  std::vector<ReduceSlotT<value_t>> slots(n_workers + 2, ReduceSlotT<value_t>(init));
+  std::mutex others_mutex;
+
+  auto chunk_fn = [&](index_t begin, index_t end) -> bool
+  {
+    value_t result = map(begin);
+    for (auto i = begin + 1; i != end; ++i)
+    {
+      result = combine(result, map(i));
+    }
+
+    auto index = pool.worker_index();
+    if (index >= n_workers)
+    {
+      index = std::this_thread::get_id() == caller_id ? n_workers : n_workers + 1;
+    }
+
+    std::unique_lock<std::mutex> lk(others_mutex, std::defer_lock);
+    if (index == n_workers + 1)
+    {
+      lk.lock();
+    }
+
+    auto& slot = slots[index];
+    slot.value = slot.used ? combine(slot.value, result) : result;
+    slot.used = true;
+
+    return true;
+  };
+
+  parallel_chunks(first, last, chunk_fn, grain, &pool);
+
+  for (const auto& e : slots)
+  {
+    if (e.used)
+    {
+      init = combine(init, e.value);
+    }
+  }
+
+  return init;
+}
+
+/**
+ * Parallel Algorithms
+ * The algorithms on random-access iterators, they fall back to the sequential algorithm when the
+ * range is shorter than the cutoff. The range is split into blocks (a few per worker) that are
+ * run by parallel_for.
+ */
+
+const size_t PARALLEL_SORT_CUTOFF = 16384;
+const size_t PARALLEL_SCAN_CUTOFF = 16384;
+const size_t PARALLEL_COPY_CUTOFF = 16384;
+
+inline size_t parallel_block_size(ThreadPool& pool, const size_t n, const size_t min_block_size)
+{
+  const size_t n_blocks = (std::max)(size_t(1), (std::min)(4 * (pool.worker_count() + 1), n / min_block_size));
+  return (n + n_blocks - 1) / n_blocks;
+}
+
+/**
+ * parallel_transform
+ * The same as std::transform, returns the end of the output.
+ */
+
+template <typename input_iterator_t, typename output_iterator_t, typename fn_t>
+output_iterator_t parallel_transform(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  fn_t fn,
+  ThreadPool* ptr_pool = nullptr)
+{
+  const size_t n = size_t(last - first);
+
+  parallel_for(size_t(0), n, [&](size_t i)
+  {
+    d_first[i] = fn(first[i]);
+  }, 0, ptr_pool);
+
+  return d_first + n;
+}
+
+template <typename input_iterator_1_t, typename input_iterator_2_t, typename output_iterator_t, typename fn_t>
+output_iterator_t parallel_transform(
+  input_iterator_1_t first_1,
+  input_iterator_1_t last_1,
+  input_iterator_2_t first_2,
+  output_iterator_t d_first,
+  fn_t fn,
+  ThreadPool* ptr_pool = nullptr)
+{
+  const size_t n = size_t(last_1 - first_1);
+
+  parallel_for(size_t(0), n, [&](size_t i)
+  {
+    d_first[i] = fn(first_1[i], first_2[i]);
+  }, 0, ptr_pool);
+
+  return d_first + n;
+}
+
+/**
+ * parallel_inclusive_scan / parallel_exclusive_scan
+ * The prefix sums of the range, `op` must be associative. The output may be the input itself.
+ * The scan has 3 passes, the sum of each block, the exclusive scan of the block sums (sequential),
+ * then the scan of each block from its offset.
+ * Eg.
+ *   vu::parallel_exclusive_scan(sizes.begin(), sizes.end(), offsets.begin(), size_t(0));
+ */
+
+template <typename input_iterator_t, typename output_iterator_t, typename value_t, typename op_t>
+output_iterator_t parallel_scan_blocks(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  const value_t* ptr_init, // exclusive scan if not null
+  op_t op,
+  ThreadPool* ptr_pool)
+{
+  const size_t n = size_t(last - first);
+  if (n == 0)
+  {
+    return d_first;
+  }
+
+  auto& pool = ptr_pool != nullptr ? *ptr_pool : ThreadPool::global();
+
+  const size_t block_size = n < PARALLEL_SCAN_CUTOFF ? n : parallel_block_size(pool, n, PARALLEL_SCAN_CUTOFF / 4);
+  const size_t n_blocks = (n + block_size - 1) / block_size;
+
+  // the first block gets the init (if any), so a block sum is only needed for the other blocks
+
+  std::vector<value_t> sums;
+  sums.reserve(n_blocks);
+
+  for (size_t i = 0; i < n_blocks; i++)
+  {
+    sums.push_back(ptr_init != nullptr ? *ptr_init : value_t(first[i * block_size]));
+  }
+
+  if (n_blocks > 1)
+  {
+    parallel_for(size_t(0), n_blocks - 1, [&](size_t b)
+    {
+      const size_t begin = b * block_size, end = (std::min)(n, begin + block_size);
+
+      value_t sum = first[begin];
+      for (size_t i = begin + 1; i < end; i++)
+      {
+        sum = op(sum, first[i]);
+      }
+
+      sums[b + 1] = sum;
+    }, 1, &pool);
+
+    for (size_t b = 1; b < n_blocks; b++) // the offset of each block
+    {
+      sums[b] = b == 1 && ptr_init == nullptr ? sums[b] : op(sums[b - 1], sums[b]);
+    }
+  }
+
+  const auto scan_block = [&](size_t b)
+  {
+    const size_t begin = b * block_size, end = (std::min)(n, begin + block_size);
+    const bool has_offset = ptr_init != nullptr || b != 0;
+
+    if (ptr_init != nullptr) // exclusive
+    {
+      value_t sum = sums[b];
+      for (size_t i = begin; i < end; i++)
+      {
+        value_t v = first[i]; // read before write for in-place
+        d_first[i] = sum;
+        sum = op(sum, v);
+      }
+    }
+    else // inclusive
+    {
+      value_t sum = has_offset ? op(sums[b], first[begin]) : value_t(first[begin]);
+      d_first[begin] = sum;
+      for (size_t i = begin + 1; i < end; i++)
+      {
+        sum = op(sum, first[i]);
+        d_first[i] = sum;
+      }
+    }
+  };
+
+  if (n_blocks == 1)
+  {
+    scan_block(0);
+  }
+  else
+  {
+    parallel_for(size_t(0), n_blocks, scan_block, 1, &pool);
+  }
+
+  return d_first + n;
+}
+
+template <typename input_iterator_t, typename output_iterator_t, typename op_t>
+output_iterator_t parallel_inclusive_scan(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  op_t op,
+  ThreadPool* ptr_pool = nullptr)
+{
+  typedef typename std::iterator_traits<input_iterator_t>::value_type value_t;
+  return parallel_scan_blocks(first, last, d_first, static_cast<const value_t*>(nullptr), op, ptr_pool);
+}
+
+template <typename input_iterator_t, typename output_iterator_t>
+output_iterator_t parallel_inclusive_scan(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first)
+{
+  typedef typename std::iterator_traits<input_iterator_t>::value_type value_t;
+  return parallel_inclusive_scan(first, last, d_first, std::plus<value_t>());
+}
+
+template <typename input_iterator_t, typename output_iterator_t, typename value_t, typename op_t>
+output_iterator_t parallel_exclusive_scan(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  value_t init,
+  op_t op,
+  ThreadPool* ptr_pool = nullptr)
+{
+  return parallel_scan_blocks(first, last, d_first, &init, op, ptr_pool);
+}
+
+template <typename input_iterator_t, typename output_iterator_t, typename value_t>
+output_iterator_t parallel_exclusive_scan(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  value_t init)
+{
+  return parallel_exclusive_scan(first, last, d_first, init, std::plus<value_t>());
+}
+
+/**
+ * parallel_copy_if
+ * The same as std::copy_if (the order is kept), returns the end of the output.
+ * The predicate is called once per item, the matches are counted per block, then each block is
+ * copied to its offset.
+ */
+
+template <typename input_iterator_t, typename output_iterator_t, typename predicate_t>
+output_iterator_t parallel_copy_if(
+  input_iterator_t first,
+  input_iterator_t last,
+  output_iterator_t d_first,
+  predicate_t pred,
+  ThreadPool* ptr_pool = nullptr)
+{
+  const size_t n = size_t(last - first);
+
+  if (n < PARALLEL_COPY_CUTOFF)
+  {
+    for (; first != last; ++first)
+    {
+      if (pred(*first))
+      {
+        *d_first++ = *first;
+      }
+    }
+
+    return d_first;
+  }
+
+  auto& pool = ptr_pool != nullptr ? *ptr_pool : ThreadPool::global();
+
+  const size_t block_size = parallel_block_size(pool, n, PARALLEL_COPY_CUTOFF / 4);
+  const size_t n_blocks = (n + block_size - 1) / block_size;
+
+  std::vector<unsigned char> matches(n);
+  std::vector<size_t> offsets(n_blocks + 1, 0);
+
+  parallel_for(size_t(0), n_blocks, [&](size_t b)
+  {
+    const size_t begin = b * block_size, end = (std::min)(n, begin + block_size);
+
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+      matches[i] = pred(first[i]) ? 1 : 0;
+      count += matches[i];
+    }
+
+    offsets[b + 1] = count;
+  }, 1, &pool);
+
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  parallel_for(size_t(0), n_blocks, [&](size_t b)
+  {
+    const size_t begin = b * block_size, end = (std::min)(n, begin + block_size);
+
+    auto it = d_first + offsets[b];
+    for (size_t i = begin; i < end; i++)
+    {
+      if (matches[i] != 0)
+      {
+        *it++ = first[i];
+      }
+    }
+  }, 1, &pool);
+
+  return d_first + offsets[n_blocks];
+}
+
+/**
+ * parallel_sort
+ * The same as std::sort (not stable), it's a merge sort, the blocks are sorted by std::sort in
+ * parallel, then the sorted runs are merged pairwise into a buffer and back (ping-pong) until a
+ * single run is left. Each merge is split into the chunks of the output by binary searching the
+ * split position (co-rank) of the two runs, so all of the workers take part in every pass.
+ * The items must be move-constructible and move-assignable.
+ */
+
+template <typename iterator_t, typename compare_t>
+size_t parallel_merge_co_rank(
+  const size_t p, iterator_t a, const size_t m, iterator_t b, const size_t n, compare_t& comp)
+{
+  // the number of items from `a` in the first `p` items of the stable merge of `a` and `b`
+
+  size_t lo = p > n ? p - n : 0;
+  size_t hi = (std::min)(p, m);
+
+  while (lo < hi)
+  {
+    const size_t i = lo + (hi - lo) / 2;
+    if (!comp(b[p - i - 1], a[i])) // a[i] goes before b[p - i - 1], so more items from `a`
+    {
+      lo = i + 1;
+    }
+    else
+    {
+      hi = i;
+    }
+  }
+
+  return lo;
+}
+
+template <typename iterator_t, typename output_iterator_t, typename compare_t>
+void parallel_merge_pass(
+  iterator_t src,
+  output_iterator_t dst,
+  const size_t n,
+  const size_t run,
+  compare_t& comp,
+  ThreadPool& pool)
+{
+  const size_t pair_size = 2 * run;
+  const size_t chunk_size = (std::max)(PARALLEL_SORT_CUTOFF / 4, n / (4 * (pool.worker_count() + 1)));
+  const size_t n_pairs = (n + pair_size - 1) / pair_size;
+  const size_t chunks_per_pair = (pair_size + chunk_size - 1) / chunk_size;
+  const size_t n_chunks = n_pairs * chunks_per_pair;
+
+  struct Chunk
+  {
+    size_t out_begin, out_end; // in the pair
+    size_t i_begin, i_end;     // in the first run of the pair
+  };
+
+  const auto get_pair = [&](const size_t k, size_t& pair_begin, size_t& m, size_t& l)
+  {
+    pair_begin = (k / chunks_per_pair) * pair_size;
+    const size_t pair_length = (std::min)(n, pair_begin + pair_size) - pair_begin;
+    m = (std::min)(run, pair_length);
+    l = pair_length - m;
+  };
+
+  // the split positions are found before any item is moved, the binary search of a chunk reads
+  // the items of the other chunks
+
+  std::vector<Chunk> chunks(n_chunks);
+
+  parallel_for(size_t(0), n_chunks, [&](size_t k)
+  {
+    size_t pair_begin = 0, m = 0, l = 0;
+    get_pair(k, pair_begin, m, l);
+
+    auto& chunk = chunks[k];
+    chunk.out_begin = (std::min)(m + l, (k % chunks_per_pair) * chunk_size);
+    chunk.out_end = (std::min)(m + l, chunk.out_begin + chunk_size);
+
+    const auto a = src + pair_begin;
+    chunk.i_begin = parallel_merge_co_rank(chunk.out_begin, a, m, a + m, l, comp);
+    chunk.i_end = parallel_merge_co_rank(chunk.out_end, a, m, a + m, l, comp);
+  }, 1, &pool);
+
+  parallel_for(size_t(0), n_chunks, [&](size_t k)
+  {
+    const auto& chunk = chunks[k];
+    if (chunk.out_begin == chunk.out_end)
+    {
+      return;
+    }
+
+    size_t pair_begin = 0, m = 0, l = 0;
+    get_pair(k, pair_begin, m, l);
+
+    const auto a = src + pair_begin;
+    const auto b = a + m;
+
+    std::merge(
+      std::make_move_iterator(a + chunk.i_begin),
+      std::make_move_iterator(a + chunk.i_end),
+      std::make_move_iterator(b + (chunk.out_begin - chunk.i_begin)),
+      std::make_move_iterator(b + (chunk.out_end - chunk.i_end)),
+      dst + pair_begin + chunk.out_begin, comp);
+  }, 1, &pool);
+}
+
+template <typename iterator_t, typename compare_t>
+void parallel_sort(iterator_t first, iterator_t last, compare_t comp, ThreadPool* ptr_pool = nullptr)
+{
+  typedef typename std::iterator_traits<iterator_t>::value_type value_t;
+
+  const size_t n = size_t(last - first);
+
+  if (n < PARALLEL_SORT_CUTOFF)
+  {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  auto& pool = ptr_pool != nullptr ? *ptr_pool : ThreadPool::global();
+
+  const size_t block_size = parallel_block_size(pool, n, PARALLEL_SORT_CUTOFF / 4);
+  const size_t n_blocks = (n + block_size - 1) / block_size;
+
+  parallel_for(size_t(0), n_blocks, [&](size_t b)
+  {
+    const size_t begin = b * block_size, end = (std::min)(n, begin + block_size);
+    std::sort(first + begin, first + end, comp);
+  }, 1, &pool);
+
+  if (n_blocks == 1)
+  {
+    return;
+  }
+
+  std::vector<value_t> buffer;
+  buffer.reserve(n);
+  buffer.insert(buffer.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+
+  bool in_buffer = true; // the data is in the buffer after moving it there
+
+  for (size_t run = block_size; run < n; run *= 2)
+  {
+    if (in_buffer)
+    {
+      parallel_merge_pass(buffer.begin(), first, n, run, comp, pool);
+    }
+    else
+    {
+      parallel_merge_pass(first, buffer.begin(), n, run, comp, pool);
+    }
+
+    in_buffer = !in_buffer;
+  }
+
+  if (in_buffer)
+  {
+    parallel_for(size_t(0), n, [&](size_t i) { first[i] = std::move(buffer[i]); }, 0, &pool);
+  }
+}
+
+template <typename iterator_t>
+void parallel_sort(iterator_t first, iterator_t last)
+{
+  typedef typename std::iterator_traits<iterator_t>::value_type value_t;
+  parallel_sort(first, last, std::less<value_t>());
+}
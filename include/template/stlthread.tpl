@@ -6,6 +6,8 @@
 
  /**
   * STLThreadT
+  * The items are split into the static chunks, one per thread (see parallel_for/parallel_reduce
+  * for the adaptive splitting and the lambda bodies).
   */
 
 enum class return_type
@@ -0,0 +1,383 @@
+/**
+ * @file   strfmt.tpl
+ * @author Vic P.
+ * @brief  Template for Type-Safe String Format
+ */
+
+/**
+ * FormatBufferT
+ * The output of the formatting, the characters are written into the stack buffer first,
+ * then into the heap when the stack buffer is full.
+ */
+
+template <typename char_t, size_t N = 256>
+class FormatBufferT
+{
+public:
+  FormatBufferT() : m_ptr(m_stack), m_size(0), m_capacity(N) {}
+
+  const char_t* data() const { return m_ptr; }
+  size_t size() const { return m_size; }
+
+  void append(const char_t* ptr, const size_t size)
+  {
+    this->reserve(m_size + size);
+    std::char_traits<char_t>::copy(m_ptr + m_size, ptr, size);
+    m_size += size;
+  }
+
+  void append(const char_t c, const size_t count = 1)
+  {
+    this->reserve(m_size + count);
+    std::char_traits<char_t>::assign(m_ptr + m_size, count, c);
+    m_size += count;
+  }
+
+private:
+  FormatBufferT(const FormatBufferT&);
+  FormatBufferT& operator=(const FormatBufferT&);
+
+  void reserve(const size_t size)
+  {
+    if (size <= m_capacity)
+    {
+      return;
+    }
+
+    const auto capacity = (std::max)(size, 2 * m_capacity);
+    std::unique_ptr<char_t[]> heap(new char_t[capacity]);
+    std::char_traits<char_t>::copy(heap.get(), m_ptr, m_size);
+
+    m_heap.swap(heap);
+    m_ptr = m_heap.get();
+    m_capacity = capacity;
+  }
+
+private:
+  char_t m_stack[N];
+  std::unique_ptr<char_t[]> m_heap;
+  char_t* m_ptr;
+  size_t m_size;
+  size_t m_capacity;
+};
+
+/**
+ * IsFormatCharT
+ * The character types, a string of a character type is not formatted as a pointer.
+ */
+
+template <typename T>
+struct IsFormatCharT : std::integral_constant<bool,
+  std::is_same<typename std::remove_cv<T>::type, char>::value ||
+  std::is_same<typename std::remove_cv<T>::type, wchar>::value> {};
+
+/**
+ * FormatArgT
+ * The type-erased argument of the formatting (no varargs, so the types are kept).
+ */
+
+template <typename char_t>
+struct FormatArgT
+{
+  enum arg_type
+  {
+    FA_NONE,
+    FA_BOOL,
+    FA_CHAR,
+    FA_INT,
+    FA_UINT,
+    FA_DOUBLE,
+    FA_STRING,
+    FA_POINTER,
+  };
+
+  arg_type type;
+
+  union
+  {
+    bool b;
+    char_t c;
+    long long i;
+    unsigned long long u;
+    double d;
+    const void* p;
+    struct
+    {
+      const char_t* ptr;
+      size_t size;
+    } s;
+  };
+
+  FormatArgT() : type(FA_NONE), u(0) {}
+  FormatArgT(const bool v) : type(FA_BOOL), u(0) { b = v; }
+  FormatArgT(const char_t v) : type(FA_CHAR), u(0) { c = v; }
+  FormatArgT(const StringViewT<char_t>& v) : type(FA_STRING) { s.ptr = v.data(); s.size = v.size(); }
+  FormatArgT(const std::basic_string<char_t>& v) : type(FA_STRING) { s.ptr = v.data(); s.size = v.size(); }
+  FormatArgT(const char_t* v) : type(FA_STRING) { this->set_string(v); }
+  FormatArgT(char_t* v) : type(FA_STRING) { this->set_string(v); }
+
+  template <typename T>
+  FormatArgT(const T v, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type* = 0)
+    : type(FA_INT), i(static_cast<long long>(v)) {}
+
+  template <typename T>
+  FormatArgT(const T v, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type* = 0)
+    : type(FA_UINT), u(static_cast<unsigned long long>(v)) {}
+
+  template <typename T>
+  FormatArgT(const T v, typename std::enable_if<std::is_floating_point<T>::value>::type* = 0)
+    : type(FA_DOUBLE), d(static_cast<double>(v)) {}
+
+  template <typename T>
+  FormatArgT(const T v, typename std::enable_if<std::is_enum<T>::value>::type* = 0)
+    : type(FA_INT), i(static_cast<long long>(v)) {}
+
+  FormatArgT(std::nullptr_t) : type(FA_POINTER), p(nullptr) {}
+
+  template <typename T>
+  FormatArgT(const T* v) : type(FA_POINTER), p(v)
+  {
+    static_assert(!IsFormatCharT<T>::value, "the string of the other character type, convert it first");
+  }
+
+private:
+  void set_string(const char_t* v)
+  {
+    static const char_t null[] = { '(', 'n', 'u', 'l', 'l', ')', '\0' };
+    s.ptr  = v == nullptr ? null : v;
+    s.size = std::char_traits<char_t>::length(s.ptr);
+  }
+};
+
+/**
+ * The formatting of the arguments by the format string, the replacement fields are
+ *   {[index][:[0][width][.precision][type]]}
+ * The types are d (decimal), x/X (hex), o (octal), b (binary), f/e/g (floating-point),
+ * s (string), c (character) and p (pointer). `{{` and `}}` are the escaped braces.
+ * The numbers are right-aligned and the others are left-aligned in their widths.
+ * The invalid replacement fields are written as-is.
+ */
+
+void vuapi format_args_A(
+  FormatBufferT<char>& buffer, const StringViewA& format, const FormatArgT<char>* args, const size_t count);
+void vuapi format_args_W(
+  FormatBufferT<wchar>& buffer, const StringViewW& format, const FormatArgT<wchar>* args, const size_t count);
+
+/**
+ * Formats the arguments into a new string.
+ * Eg. vu::format_text_A("{} is {} years old, {:08X}", "Vic", 26, 0xC0FFEE);
+ */
+
+template <typename ... Args>
+std::string format_text_A(const StringViewA& format, const Args& ... args)
+{
+  FormatBufferT<char> buffer;
+  const FormatArgT<char> list[] = { FormatArgT<char>(), FormatArgT<char>(args)... };
+  format_args_A(buffer, format, list + 1, sizeof...(args));
+  return std::string(buffer.data(), buffer.size());
+}
+
+template <typename ... Args>
+std::wstring format_text_W(const StringViewW& format, const Args& ... args)
+{
+  FormatBufferT<wchar> buffer;
+  const FormatArgT<wchar> list[] = { FormatArgT<wchar>(), FormatArgT<wchar>(args)... };
+  format_args_W(buffer, format, list + 1, sizeof...(args));
+  return std::wstring(buffer.data(), buffer.size());
+}
+
+/**
+ * Formats the arguments and appends them to an existing string or buffer.
+ */
+
+template <typename ... Args>
+void append_format_A(std::string& result, const StringViewA& format, const Args& ... args)
+{
+  FormatBufferT<char> buffer;
+  const FormatArgT<char> list[] = { FormatArgT<char>(), FormatArgT<char>(args)... };
+  format_args_A(buffer, format, list + 1, sizeof...(args));
+  result.append(buffer.data(), buffer.size());
+}
+
+template <typename ... Args>
+void append_format_W(std::wstring& result, const StringViewW& format, const Args& ... args)
+{
+  FormatBufferT<wchar> buffer;
+  const FormatArgT<wchar> list[] = { FormatArgT<wchar>(), FormatArgT<wchar>(args)... };
+  format_args_W(buffer, format, list + 1, sizeof...(args));
+  result.append(buffer.data(), buffer.size());
+}
+
+template <typename ... Args>
+void append_format_A(Buffer& result, const StringViewA& format, const Args& ... args)
+{
+  FormatBufferT<char> buffer;
+  const FormatArgT<char> list[] = { FormatArgT<char>(), FormatArgT<char>(args)... };
+  format_args_A(buffer, format, list + 1, sizeof...(args));
+  result.append(buffer.data(), buffer.size());
+}
+
+template <typename ... Args>
+void append_format_W(Buffer& result, const StringViewW& format, const Args& ... args)
+{
+  FormatBufferT<wchar> buffer;
+  const FormatArgT<wchar> list[] = { FormatArgT<wchar>(), FormatArgT<wchar>(args)... };
+  format_args_W(buffer, format, list + 1, sizeof...(args));
+  result.append(buffer.data(), buffer.size() * sizeof(wchar));
+}
+
+/**
+ * Number Conversion
+ * The locale-independent conversion between the numbers and the strings without the iostreams,
+ * it's backed by std::to_chars/from_chars when available. The floating-point numbers are written
+ * in the shortest form that is read back to the same value.
+ */
+
+enum class number_error
+{
+  NE_NONE,
+  NE_INVALID,  // no number at the position
+  NE_OVERFLOW, // out of the range of the type
+};
+
+struct NumberResult
+{
+  size_t position; // the position of the first character that is not parsed
+  number_error error;
+
+  NumberResult(const size_t position = 0, const number_error error = number_error::NE_NONE)
+    : position(position), error(error) {}
+
+  bool ok() const { return error == number_error::NE_NONE; }
+};
+
+/**
+ * Writes a number into the buffer, returns the number of the written characters (0 if the buffer is too small).
+ */
+
+size_t vuapi number_to_chars(char* ptr, const size_t size, const long long v, const int base = 10);
+size_t vuapi number_to_chars(char* ptr, const size_t size, const unsigned long long v, const int base = 10);
+size_t vuapi number_to_chars(char* ptr, const size_t size, const double v);
+size_t vuapi number_to_chars(char* ptr, const size_t size, const float v);
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const long long v, const int base = 10);
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const unsigned long long v, const int base = 10);
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const double v);
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const float v);
+
+/**
+ * Parses a number at the beginning of the buffer (no whitespace, an optional sign), the value is
+ * only set on success. The parsing stops at the first character that is not a part of the number.
+ */
+
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, long long& v, const int base = 10);
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, unsigned long long& v, const int base = 10);
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, double& v);
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, float& v);
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, long long& v, const int base = 10);
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, unsigned long long& v, const int base = 10);
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, double& v);
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, float& v);
+
+/**
+ * NumberTypeT
+ * The type of the conversion for an arithmetic type.
+ */
+
+template <typename T>
+struct NumberTypeT
+{
+  typedef typename std::conditional<std::is_floating_point<T>::value,
+    typename std::conditional<std::is_same<T, float>::value, float, double>::type,
+    typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type
+  >::type type;
+
+  static bool in_range(const type v)
+  {
+    return !std::is_integral<T>::value ||
+      (v >= type((std::numeric_limits<T>::min)()) && v <= type((std::numeric_limits<T>::max)()));
+  }
+};
+
+/**
+ * Converts a number to a string.
+ * Eg. vu::number_to_string_A(26) -> "26", vu::number_to_string_A(0.1) -> "0.1"
+ */
+
+template <typename T>
+std::string number_to_string_A(const T v)
+{
+  char buffer[64];
+  const auto n = number_to_chars(buffer, sizeof(buffer), typename NumberTypeT<T>::type(v));
+  return std::string(buffer, n);
+}
+
+template <typename T>
+std::wstring number_to_string_W(const T v)
+{
+  wchar buffer[64];
+  const auto n = number_to_chars(buffer, sizeof(buffer) / sizeof(buffer[0]), typename NumberTypeT<T>::type(v));
+  return std::wstring(buffer, n);
+}
+
+/**
+ * Converts a string to a number, the surrounding whitespaces are ignored and the rest must be a number.
+ * Eg. int v = 0; if (vu::string_to_number_A(" -26 ", v).ok()) ...
+ */
+
+template <typename T>
+NumberResult string_to_number_A(const StringViewA& text, T& v)
+{
+  const auto trimmed = trim_string_view_A(text, trim_type::TS_LEFT);
+  const auto offset  = size_t(trimmed.data() - text.data());
+
+  typename NumberTypeT<T>::type number = 0;
+  auto result = number_from_chars(trimmed.data(), trimmed.size(), number);
+  result.position += offset;
+
+  if (result.ok())
+  {
+    if (!trim_string_view_A(text.substr(result.position)).empty())
+    {
+      result.error = number_error::NE_INVALID;
+    }
+    else if (!NumberTypeT<T>::in_range(number))
+    {
+      result.error = number_error::NE_OVERFLOW;
+    }
+    else
+    {
+      v = T(number);
+    }
+  }
+
+  return result;
+}
+
+template <typename T>
+NumberResult string_to_number_W(const StringViewW& text, T& v)
+{
+  const auto trimmed = trim_string_view_W(text, trim_type::TS_LEFT);
+  const auto offset  = size_t(trimmed.data() - text.data());
+
+  typename NumberTypeT<T>::type number = 0;
+  auto result = number_from_chars(trimmed.data(), trimmed.size(), number);
+  result.position += offset;
+
+  if (result.ok())
+  {
+    if (!trim_string_view_W(text.substr(result.position)).empty())
+    {
+      result.error = number_error::NE_INVALID;
+    }
+    else if (!NumberTypeT<T>::in_range(number))
+    {
+      result.error = number_error::NE_OVERFLOW;
+    }
+    else
+    {
+      v = T(number);
+    }
+  }
+
+  return result;
+}
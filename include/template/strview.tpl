@@ -0,0 +1,371 @@
+/**
+ * @file   strview.tpl
+ * @author Vic P.
+ * @brief  Template for String View
+ */
+
+/**
+ * StringViewT
+ * The non-owning view of a string (std::basic_string_view for C++11),
+ * it's converted from/to std::basic_string_view when built with C++17.
+ */
+
+template <typename char_t>
+class StringViewT
+{
+public:
+  typedef char_t value_type;
+  typedef const char_t* const_iterator;
+  typedef std::basic_string<char_t> std_string_t;
+
+  static const size_t npos = size_t(-1);
+
+  StringViewT() : m_ptr(nullptr), m_size(0) {}
+  StringViewT(const char_t* ptr, const size_t size) : m_ptr(ptr), m_size(size) {}
+  StringViewT(const char_t* ptr) : m_ptr(ptr), m_size(ptr == nullptr ? 0 : std::char_traits<char_t>::length(ptr)) {}
+  StringViewT(const std_string_t& string) : m_ptr(string.data()), m_size(string.size()) {}
+
+#if ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || (__cplusplus >= 201703L))
+  StringViewT(const std::basic_string_view<char_t>& view) : m_ptr(view.data()), m_size(view.size()) {}
+  operator std::basic_string_view<char_t>() const { return std::basic_string_view<char_t>(m_ptr, m_size); }
+#endif
+
+  const char_t* data() const { return m_ptr; }
+  size_t size() const { return m_size; }
+  size_t length() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  const_iterator begin() const { return m_ptr; }
+  const_iterator end() const { return m_ptr + m_size; }
+
+  const char_t& operator[](const size_t pos) const { return m_ptr[pos]; }
+  const char_t& front() const { return m_ptr[0]; }
+  const char_t& back() const { return m_ptr[m_size - 1]; }
+
+  std_string_t str() const
+  {
+    return m_size == 0 ? std_string_t() : std_string_t(m_ptr, m_size);
+  }
+
+  void remove_prefix(const size_t n)
+  {
+    const auto k = n < m_size ? n : m_size;
+    m_ptr += k;
+    m_size -= k;
+  }
+
+  void remove_suffix(const size_t n)
+  {
+    m_size -= n < m_size ? n : m_size;
+  }
+
+  // Unlike std::basic_string_view, the position is clamped instead of throwing
+
+  StringViewT substr(size_t pos, size_t n = npos) const
+  {
+    pos = pos < m_size ? pos : m_size;
+    n = n < m_size - pos ? n : m_size - pos;
+    return StringViewT(m_ptr + pos, n);
+  }
+
+  int compare(const StringViewT& right) const
+  {
+    const auto n = m_size < right.m_size ? m_size : right.m_size;
+    const int result = n == 0 ? 0 : std::char_traits<char_t>::compare(m_ptr, right.m_ptr, n);
+    return result != 0 ? result : (m_size < right.m_size ? -1 : m_size > right.m_size ? 1 : 0);
+  }
+
+  size_t find(const char_t c, const size_t pos = 0) const
+  {
+    if (pos >= m_size)
+    {
+      return npos;
+    }
+
+    const auto p = std::char_traits<char_t>::find(m_ptr + pos, m_size - pos, c);
+    return p == nullptr ? npos : size_t(p - m_ptr);
+  }
+
+  size_t find(const StringViewT& v, size_t pos = 0) const
+  {
+    if (v.m_size == 0)
+    {
+      return pos <= m_size ? pos : npos;
+    }
+
+    // the first character is searched by char_traits (memchr/wmemchr), then the rest is compared
+
+    while (pos + v.m_size <= m_size)
+    {
+      pos = this->find(v.m_ptr[0], pos);
+      if (pos == npos || pos + v.m_size > m_size)
+      {
+        return npos;
+      }
+
+      if (std::char_traits<char_t>::compare(m_ptr + pos + 1, v.m_ptr + 1, v.m_size - 1) == 0)
+      {
+        return pos;
+      }
+
+      pos++;
+    }
+
+    return npos;
+  }
+
+  size_t rfind(const StringViewT& v, size_t pos = npos) const
+  {
+    if (v.m_size > m_size)
+    {
+      return npos;
+    }
+
+    pos = pos < m_size - v.m_size ? pos : m_size - v.m_size;
+
+    for (size_t i = pos + 1; i-- > 0;)
+    {
+      if (std::char_traits<char_t>::compare(m_ptr + i, v.m_ptr, v.m_size) == 0)
+      {
+        return i;
+      }
+    }
+
+    return npos;
+  }
+
+  size_t find_first_of(const StringViewT& chars, const size_t pos = 0) const
+  {
+    for (size_t i = pos; i < m_size; i++)
+    {
+      if (chars.find(m_ptr[i]) != npos)
+      {
+        return i;
+      }
+    }
+
+    return npos;
+  }
+
+  size_t find_first_not_of(const StringViewT& chars, const size_t pos = 0) const
+  {
+    for (size_t i = pos; i < m_size; i++)
+    {
+      if (chars.find(m_ptr[i]) == npos)
+      {
+        return i;
+      }
+    }
+
+    return npos;
+  }
+
+  size_t find_last_not_of(const StringViewT& chars) const
+  {
+    for (size_t i = m_size; i-- > 0;)
+    {
+      if (chars.find(m_ptr[i]) == npos)
+      {
+        return i;
+      }
+    }
+
+    return npos;
+  }
+
+  bool operator==(const StringViewT& right) const
+  {
+    return m_size == right.m_size && this->compare(right) == 0;
+  }
+
+  bool operator!=(const StringViewT& right) const
+  {
+    return !(*this == right);
+  }
+
+  bool operator<(const StringViewT& right) const
+  {
+    return this->compare(right) < 0;
+  }
+
+private:
+  const char_t* m_ptr;
+  size_t m_size;
+};
+
+template <typename char_t>
+const size_t StringViewT<char_t>::npos;
+
+typedef StringViewT<char>  StringViewA;
+typedef StringViewT<wchar> StringViewW;
+
+/**
+ * TokenizerT
+ * The lazy splitting of a string, the tokens are the views into the string and are found on demand.
+ * The semantics are the same as split_string (an empty string has no token, an empty delimiter
+ * gives the whole string as the only token, and the empty tokens are skipped if `remove_empty`).
+ * Eg.
+ *   for (const auto& e : vu::TokenizerA(line, ",")) ...
+ *   for (const auto& e : vu::TokenizerA(line, "", vu::split_type::ST_WHITESPACE, true)) ...
+ */
+
+template <typename char_t>
+class TokenizerT
+{
+public:
+  typedef StringViewT<char_t> string_view_t;
+
+  class iterator
+  {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef string_view_t value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const string_view_t* pointer;
+    typedef const string_view_t& reference;
+
+    iterator() : m_ended(true) {}
+    iterator(const TokenizerT& tokenizer) : m_tokenizer(tokenizer), m_ended(false) { ++(*this); }
+
+    reference operator*() const { return m_token; }
+    pointer operator->() const { return &m_token; }
+
+    iterator& operator++()
+    {
+      m_ended = !m_tokenizer.next(m_token);
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    bool operator==(const iterator& right) const
+    {
+      if (m_ended || right.m_ended)
+      {
+        return m_ended == right.m_ended;
+      }
+
+      return m_token.data() == right.m_token.data() && m_token.size() == right.m_token.size();
+    }
+
+    bool operator!=(const iterator& right) const
+    {
+      return !(*this == right);
+    }
+
+  private:
+    TokenizerT m_tokenizer;
+    string_view_t m_token;
+    bool m_ended;
+  };
+
+  TokenizerT() : m_type(split_type::ST_STRING), m_remove_empty(false), m_pos(0), m_ended(true) {}
+
+  TokenizerT(
+    const string_view_t& string,
+    const string_view_t& delimiter,
+    const split_type type = split_type::ST_STRING,
+    const bool remove_empty = false)
+    : m_string(string)
+    , m_delimiter(delimiter)
+    , m_type(type)
+    , m_remove_empty(remove_empty)
+    , m_pos(0)
+    , m_ended(string.empty())
+  {
+    if (m_type == split_type::ST_WHITESPACE)
+    {
+      static const char_t whitespaces[] = { ' ', '\t', '\n', '\r', '\f', '\v' };
+      m_delimiter = string_view_t(whitespaces, sizeof(whitespaces) / sizeof(whitespaces[0]));
+    }
+    else if (m_type == split_type::ST_CHAR && m_delimiter.size() > 1)
+    {
+      m_delimiter = m_delimiter.substr(0, 1);
+    }
+  }
+
+  iterator begin() const { return iterator(*this); }
+  iterator end() const { return iterator(); }
+
+  /**
+   * Gets the next token, returns false when there is no token left.
+   */
+  bool next(string_view_t& token)
+  {
+    while (!m_ended)
+    {
+      size_t size = 0;
+      const auto pos = this->find_delimiter(size);
+
+      if (pos == string_view_t::npos)
+      {
+        token = m_string.substr(m_pos);
+        m_ended = true;
+      }
+      else
+      {
+        token = m_string.substr(m_pos, pos - m_pos);
+        m_pos = pos + size;
+      }
+
+      if (!token.empty() || !m_remove_empty)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Gets the remaining part of the string that is not tokenized yet.
+   */
+  string_view_t remaining() const
+  {
+    return m_ended ? string_view_t() : m_string.substr(m_pos);
+  }
+
+private:
+  size_t find_delimiter(size_t& size) const
+  {
+    if (m_delimiter.empty())
+    {
+      return string_view_t::npos;
+    }
+
+    size = 1;
+
+    switch (m_type)
+    {
+    case split_type::ST_CHAR:
+      {
+        const auto p = find_char(m_string.data() + m_pos, m_string.size() - m_pos, m_delimiter[0]);
+        return p == nullptr ? string_view_t::npos : size_t(p - m_string.data());
+      }
+
+    case split_type::ST_ANY_OF:
+    case split_type::ST_WHITESPACE:
+      return m_string.find_first_of(m_delimiter, m_pos);
+
+    default:
+      size = m_delimiter.size();
+      return m_string.find(m_delimiter, m_pos);
+    }
+  }
+
+private:
+  string_view_t m_string;
+  string_view_t m_delimiter;
+  split_type m_type;
+  bool m_remove_empty;
+  size_t m_pos;
+  bool m_ended;
+};
+
+typedef TokenizerT<char>  TokenizerA;
+typedef TokenizerT<wchar> TokenizerW;
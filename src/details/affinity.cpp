@@ -0,0 +1,173 @@
+/**
+ * @file   affinity.cpp
+ * @author Vic P.
+ * @brief  Implementation for Processor Affinity & NUMA Topology
+ */
+
+#include "Vutils.h"
+#include "threadpool.h"
+
+namespace vu
+{
+
+/**
+ * The processor groups are on Windows 7+, so the functions are looked up at run-time and the
+ * structures are declared here (as GROUP_AFFINITY, PROCESSOR_NUMBER and the NUMA node entry of
+ * SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX). Without them there is a single node of group 0.
+ */
+
+struct GroupAffinity
+{
+  ulongptr mask;
+  ushort group;
+  ushort reserved[3];
+};
+
+struct ProcessorNumber
+{
+  ushort group;
+  byte number;
+  byte reserved;
+};
+
+struct NumaNodeRelationship
+{
+  ulong relationship;
+  ulong size;
+  ulong node_number;
+  byte  reserved[20];
+  GroupAffinity group_mask;
+};
+
+static const ulong RELATION_NUMA_NODE = 1; // RelationNumaNode
+
+typedef BOOL (WINAPI *PfnGetLogicalProcessorInformationEx)(ulong relationship, void* buffer, PDWORD length);
+typedef BOOL (WINAPI *PfnSetThreadGroupAffinity)(HANDLE thread, const GroupAffinity* affinity, GroupAffinity* previous);
+typedef void (WINAPI *PfnGetCurrentProcessorNumberEx)(ProcessorNumber* processor);
+typedef BOOL (WINAPI *PfnGetNumaProcessorNodeEx)(ProcessorNumber* processor, PUSHORT node_number);
+
+struct ProcessorAPI
+{
+  PfnGetLogicalProcessorInformationEx pfnGetLogicalProcessorInformationEx;
+  PfnSetThreadGroupAffinity pfnSetThreadGroupAffinity;
+  PfnGetCurrentProcessorNumberEx pfnGetCurrentProcessorNumberEx;
+  PfnGetNumaProcessorNodeEx pfnGetNumaProcessorNodeEx;
+};
+
+static std::once_flag g_processor_api_flag;
+static ProcessorAPI g_processor_api;
+
+static const ProcessorAPI& get_processor_api()
+{
+  std::call_once(g_processor_api_flag, []()
+  {
+    g_processor_api.pfnGetLogicalProcessorInformationEx = (PfnGetLogicalProcessorInformationEx)
+      Library::quick_get_proc_address(_T("kernel32.dll"), _T("GetLogicalProcessorInformationEx"));
+    g_processor_api.pfnSetThreadGroupAffinity = (PfnSetThreadGroupAffinity)
+      Library::quick_get_proc_address(_T("kernel32.dll"), _T("SetThreadGroupAffinity"));
+    g_processor_api.pfnGetCurrentProcessorNumberEx = (PfnGetCurrentProcessorNumberEx)
+      Library::quick_get_proc_address(_T("kernel32.dll"), _T("GetCurrentProcessorNumberEx"));
+    g_processor_api.pfnGetNumaProcessorNodeEx = (PfnGetNumaProcessorNodeEx)
+      Library::quick_get_proc_address(_T("kernel32.dll"), _T("GetNumaProcessorNodeEx"));
+  });
+
+  return g_processor_api;
+}
+
+std::vector<NumaNodeInfo> get_numa_nodes()
+{
+  std::vector<NumaNodeInfo> result;
+
+  const auto pfnGetLogicalProcessorInformationEx = get_processor_api().pfnGetLogicalProcessorInformationEx;
+
+  if (pfnGetLogicalProcessorInformationEx != nullptr)
+  {
+    DWORD length = 0;
+    pfnGetLogicalProcessorInformationEx(RELATION_NUMA_NODE, nullptr, &length);
+
+    std::vector<byte> buffer(length);
+
+    if (length != 0 && pfnGetLogicalProcessorInformationEx(RELATION_NUMA_NODE, buffer.data(), &length))
+    {
+      for (DWORD offset = 0; offset + sizeof(NumaNodeRelationship) <= length;)
+      {
+        const auto ptr_entry = reinterpret_cast<const NumaNodeRelationship*>(&buffer[offset]);
+
+        if (ptr_entry->relationship == RELATION_NUMA_NODE && ptr_entry->group_mask.mask != 0)
+        {
+          NumaNodeInfo node;
+          node.id = ptr_entry->node_number;
+          node.processors.group = ptr_entry->group_mask.group;
+          node.processors.mask  = ptr_entry->group_mask.mask;
+          result.push_back(node);
+        }
+
+        if (ptr_entry->size == 0)
+        {
+          break;
+        }
+
+        offset += ptr_entry->size;
+      }
+    }
+  }
+
+  if (result.empty())
+  {
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask);
+
+    NumaNodeInfo node;
+    node.id = 0;
+    node.processors.group = 0;
+    node.processors.mask  = process_mask != 0 ? process_mask : 1;
+    result.push_back(node);
+  }
+
+  return result;
+}
+
+ulong get_current_numa_node()
+{
+  const auto& api = get_processor_api();
+  const auto pfnGetCurrentProcessorNumberEx = api.pfnGetCurrentProcessorNumberEx;
+  const auto pfnGetNumaProcessorNodeEx = api.pfnGetNumaProcessorNodeEx;
+
+  if (pfnGetCurrentProcessorNumberEx == nullptr || pfnGetNumaProcessorNodeEx == nullptr)
+  {
+    return 0;
+  }
+
+  ProcessorNumber processor = { 0 };
+  pfnGetCurrentProcessorNumberEx(&processor);
+
+  USHORT node_number = 0;
+  if (!pfnGetNumaProcessorNodeEx(&processor, &node_number) || node_number == USHORT(-1))
+  {
+    return 0;
+  }
+
+  return node_number;
+}
+
+bool set_current_thread_affinity(const ProcessorSet& processors)
+{
+  const auto pfnSetThreadGroupAffinity = get_processor_api().pfnSetThreadGroupAffinity;
+
+  if (pfnSetThreadGroupAffinity != nullptr)
+  {
+    GroupAffinity affinity = { 0 };
+    affinity.mask  = processors.mask;
+    affinity.group = processors.group;
+    return pfnSetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != FALSE;
+  }
+
+  if (processors.group != 0)
+  {
+    return false;
+  }
+
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(processors.mask)) != 0;
+}
+
+} // namespace vu
@@ -21,15 +21,19 @@ namespace vu
  * IATElement
  */
 
+// The names are interned (case-insensitive), so they are compared by their handles
+
 struct IATElement
 {
-  std::string target;
-  std::string module;
-  std::string function;
+  typedef InternedStringT<char, true> name_t;
+
+  name_t target;
+  name_t module;
+  name_t function;
   const void* original;
   const void* replacement;
 
-  IATElement() : target(""), module(""), function(""), original(nullptr), replacement(nullptr) {}
+  IATElement() : original(nullptr), replacement(nullptr) {}
 
   IATElement(
     const std::string& t,
@@ -38,28 +42,25 @@ struct IATElement
     const void* o = 0,
     const void* r = 0) : target(t), module(m), function(f), original(o), replacement(r) {}
 
-  const IATElement& operator=(const IATElement& right)
-  {
-    target = right.target;
-    module = right.module;
-    function = right.function;
-    original = right.original;
-    replacement = right.replacement;
-    return *this;
-  }
-
   bool operator==(const IATElement& right) const
   {
-    return\
-      upper_string_A(target) == upper_string_A(right.target) &&
-      upper_string_A(module) == upper_string_A(right.module) &&
-      upper_string_A(function) == upper_string_A(right.function);
+    return target == right.target && module == right.module && function == right.function;
   }
 
   bool operator!=(const IATElement& right) const
   {
     return !(*this == right);
   }
+
+  // Checks an imported function without interning its names (most of them are not hooked)
+
+  bool matches(const std::string& m, const std::string& f) const
+  {
+    name_t name;
+    return
+      name_t::find(m, name) && name == module &&
+      name_t::find(f, name) && name == function;
+  }
 };
 
 /**
@@ -84,7 +85,7 @@ IATHookingA::IATElements::iterator IATHookingA::find(
 
 IATHookingA::IATElements::iterator IATHookingA::find(const IATElement& element)
 {
-  return this->find(element.target, element.module, element.function);
+  return std::find(m_iat_elements.begin(), m_iat_elements.end(), element);
 }
 
 bool IATHookingA::exist(
@@ -165,7 +166,7 @@ VUResult IATHookingA::perform(const iat_action action, IATElement& element)
   {
     // msg_debug_A("[%p] [%p] %s!%s\n", ptr_iat->u1.Function, ptr_int->u1.Function, m.c_str(), f.c_str());
   
-    if (element == IATElement(element.target, m, f))
+    if (element.matches(m, f))
     {
       const void* address = 0;
 
@@ -0,0 +1,316 @@
+/**
+ * @file   cdc.cpp
+ * @author Vic P.
+ * @brief  Implementation for Content-Defined Chunking
+ */
+
+#include "Vutils.h"
+#include "crypt.h"
+
+namespace vu
+{
+
+/**
+ * Gear Table
+ * 256 random 64-bit values (SplitMix64), indexed by the incoming byte of the rolling hash.
+ */
+
+struct GearTable
+{
+  uint64 values[256];
+
+  GearTable()
+  {
+    uint64 state = 0x5675746C73434443ULL;
+
+    for (auto& v : values)
+    {
+      state += 0x9E3779B97F4A7C15ULL;
+      uint64 z = state;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      v = z ^ (z >> 31);
+    }
+  }
+};
+
+static const GearTable g_gear_table;
+
+/**
+ * The mask of the n highest bits, the highest bits of the Gear hash depend on the most bytes.
+ */
+
+static uint64 gear_mask(const int n)
+{
+  return n <= 0 ? 0 : (~0ULL) << (64 - n);
+}
+
+/**
+ * FastCDC
+ */
+
+FastCDC::FastCDC(const size_t min_size, const size_t avg_size, const size_t max_size)
+  : m_min_size(min_size)
+  , m_avg_size(avg_size)
+  , m_max_size(max_size)
+  , m_mask_s(0)
+  , m_mask_l(0)
+  , m_digest_version(sha_version::_1)
+  , m_digest_bits(crypt_bits::Unspecified)
+  , m_offset(0)
+{
+  if (min_size < 64 || min_size > avg_size || avg_size > max_size)
+  {
+    throw "invalid cdc chunk sizes";
+  }
+
+  int bits = 0;
+  while ((size_t(1) << (bits + 1)) <= avg_size)
+  {
+    bits++;
+  }
+
+  // the normalized chunking (level 1), harder to cut before the average size, easier after
+
+  m_mask_s = gear_mask(bits + 1);
+  m_mask_l = gear_mask(bits - 1);
+
+  m_pending.reserve(max_size);
+}
+
+FastCDC::~FastCDC()
+{
+}
+
+void FastCDC::set_digest(const sha_version version, const crypt_bits bits)
+{
+  m_digest_version = version;
+  m_digest_bits = bits;
+}
+
+void FastCDC::reset()
+{
+  m_offset = 0;
+  m_pending.clear();
+}
+
+size_t FastCDC::cut(const byte* ptr, const size_t size, bool& found) const
+{
+  found = false;
+
+  if (size <= m_min_size)
+  {
+    return size;
+  }
+
+  const auto n = (std::min)(size, m_max_size);
+  const auto normal = (std::min)(n, m_avg_size);
+  const auto& gear = g_gear_table.values;
+
+  uint64 h = 0;
+  size_t i = m_min_size; // the cut-point skipping
+
+  for (; i < normal; i++)
+  {
+    h = (h << 1) + gear[ptr[i]];
+    if ((h & m_mask_s) == 0)
+    {
+      found = true;
+      return i + 1;
+    }
+  }
+
+  for (; i < n; i++)
+  {
+    h = (h << 1) + gear[ptr[i]];
+    if ((h & m_mask_l) == 0)
+    {
+      found = true;
+      return i + 1;
+    }
+  }
+
+  found = n == m_max_size;
+
+  return n;
+}
+
+bool FastCDC::emit(const byte* ptr, const size_t size, const fn_chunk_t& fn)
+{
+  CDCChunk chunk;
+  chunk.offset = m_offset;
+  chunk.size = size;
+  chunk.hash = xxh64(ptr, size);
+
+  if (m_digest_bits != crypt_bits::Unspecified)
+  {
+    crypt_sha_buffer(ptr, size, m_digest_version, m_digest_bits, chunk.digest);
+  }
+
+  m_offset += size;
+
+  return fn(chunk, ptr);
+}
+
+bool FastCDC::update(const void* ptr, const size_t size, const fn_chunk_t fn)
+{
+  if (ptr == nullptr || fn == nullptr)
+  {
+    return false;
+  }
+
+  auto p = static_cast<const byte*>(ptr);
+  auto n = size;
+  bool found = false;
+
+  // complete the pending chunk with the head of the new data (at most the max chunk size is copied)
+
+  while (!m_pending.empty() && n != 0)
+  {
+    const auto length = (std::min)(m_max_size - m_pending.size(), n);
+    m_pending.insert(m_pending.end(), p, p + length);
+    p += length;
+    n -= length;
+
+    const auto chunk_size = this->cut(m_pending.data(), m_pending.size(), found);
+    if (!found)
+    {
+      return true; // need more data
+    }
+
+    if (!this->emit(m_pending.data(), chunk_size, fn))
+    {
+      return false;
+    }
+
+    m_pending.erase(m_pending.begin(), m_pending.begin() + chunk_size);
+  }
+
+  // the chunks inside the new data are emitted directly from it
+
+  while (n != 0)
+  {
+    const auto chunk_size = this->cut(p, n, found);
+    if (!found)
+    {
+      m_pending.assign(p, p + n);
+      break;
+    }
+
+    if (!this->emit(p, chunk_size, fn))
+    {
+      return false;
+    }
+
+    p += chunk_size;
+    n -= chunk_size;
+  }
+
+  return true;
+}
+
+bool FastCDC::finalize(const fn_chunk_t fn)
+{
+  if (fn == nullptr)
+  {
+    return false;
+  }
+
+  bool result = true;
+  bool found = false;
+
+  while (result && !m_pending.empty())
+  {
+    const auto chunk_size = this->cut(m_pending.data(), m_pending.size(), found);
+    result = this->emit(m_pending.data(), chunk_size, fn);
+    m_pending.erase(m_pending.begin(), m_pending.begin() + chunk_size);
+  }
+
+  this->reset();
+
+  return result;
+}
+
+std::vector<CDCChunk> FastCDC::chunk(const void* ptr, const size_t size)
+{
+  std::vector<CDCChunk> chunks;
+
+  const auto fn = [&](const CDCChunk& chunk, const byte* /*ptr*/) -> bool
+  {
+    chunks.push_back(chunk);
+    return true;
+  };
+
+  this->reset();
+  this->update(ptr, size, fn);
+  this->finalize(fn);
+
+  return chunks;
+}
+
+std::vector<CDCChunk> FastCDC::chunk(const Buffer& data)
+{
+  return this->chunk(data.get_ptr(), data.get_size());
+}
+
+template <class file_mapping_t, typename std_string_t>
+bool FastCDC::chunk_file_T(const std_string_t& file_path, const fn_chunk_t& fn)
+{
+  this->reset();
+
+  bool stopped = false;
+
+  const auto fn_view = [&](const void* ptr, const size_t size) -> void
+  {
+    if (!stopped)
+    {
+      stopped = !this->update(ptr, size, fn);
+    }
+  };
+
+  if (!crypt_file_T<file_mapping_t>(file_path, fn_view) || stopped)
+  {
+    this->reset();
+    return false;
+  }
+
+  return this->finalize(fn);
+}
+
+bool FastCDC::chunk_file(const std::string& file_path, const fn_chunk_t fn)
+{
+  return this->chunk_file_T<FileMappingA>(file_path, fn);
+}
+
+bool FastCDC::chunk_file(const std::wstring& file_path, const fn_chunk_t fn)
+{
+  return this->chunk_file_T<FileMappingW>(file_path, fn);
+}
+
+std::vector<CDCChunk> FastCDC::chunk_file(const std::string& file_path)
+{
+  std::vector<CDCChunk> chunks;
+
+  this->chunk_file(file_path, [&](const CDCChunk& chunk, const byte* /*ptr*/) -> bool
+  {
+    chunks.push_back(chunk);
+    return true;
+  });
+
+  return chunks;
+}
+
+std::vector<CDCChunk> FastCDC::chunk_file(const std::wstring& file_path)
+{
+  std::vector<CDCChunk> chunks;
+
+  this->chunk_file(file_path, [&](const CDCChunk& chunk, const byte* /*ptr*/) -> bool
+  {
+    chunks.push_back(chunk);
+    return true;
+  });
+
+  return chunks;
+}
+
+} // namespace vu
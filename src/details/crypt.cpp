@@ -6,11 +6,12 @@
 
 #include "Vutils.h"
 #include "defs.h"
+#include "crypt.h"
 
 #include VU_3RD_INCL(Others/base64.h)
 #include VU_3RD_INCL(Others/md5.h)
-#include VU_3RD_INCL(Others/md5.h)
 #include VU_3RD_INCL(Others/sha.h)
+#include VU_3RD_INCL(Others/sha3_impl.h)
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -27,6 +28,114 @@
 namespace vu
 {
 
+/**
+ * XXH64
+ */
+
+static const uint64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64 XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64 xxh_rotl64(const uint64 v, const int n)
+{
+  return (v << n) | (v >> (64 - n));
+}
+
+static inline uint64 xxh_read64(const byte* ptr)
+{
+  uint64 v;
+  memcpy(&v, ptr, sizeof(v));
+  return v;
+}
+
+static inline uint32 xxh_read32(const byte* ptr)
+{
+  uint32 v;
+  memcpy(&v, ptr, sizeof(v));
+  return v;
+}
+
+static inline uint64 xxh_round(uint64 acc, const uint64 input)
+{
+  acc += input * XXH_PRIME64_2;
+  acc  = xxh_rotl64(acc, 31);
+  acc *= XXH_PRIME64_1;
+  return acc;
+}
+
+static inline uint64 xxh_merge_round(uint64 acc, uint64 v)
+{
+  v = xxh_round(0, v);
+  acc ^= v;
+  acc  = acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+  return acc;
+}
+
+uint64 xxh64(const void* ptr, const size_t size, const uint64 seed)
+{
+  auto p = static_cast<const byte*>(ptr);
+  const auto end = p + size;
+
+  uint64 h = 0;
+
+  if (size >= 32)
+  {
+    uint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    uint64 v2 = seed + XXH_PRIME64_2;
+    uint64 v3 = seed;
+    uint64 v4 = seed - XXH_PRIME64_1;
+
+    for (const auto limit = end - 32; p <= limit; p += 32)
+    {
+      v1 = xxh_round(v1, xxh_read64(p + 0));
+      v2 = xxh_round(v2, xxh_read64(p + 8));
+      v3 = xxh_round(v3, xxh_read64(p + 16));
+      v4 = xxh_round(v4, xxh_read64(p + 24));
+    }
+
+    h = xxh_rotl64(v1, 1) + xxh_rotl64(v2, 7) + xxh_rotl64(v3, 12) + xxh_rotl64(v4, 18);
+    h = xxh_merge_round(h, v1);
+    h = xxh_merge_round(h, v2);
+    h = xxh_merge_round(h, v3);
+    h = xxh_merge_round(h, v4);
+  }
+  else
+  {
+    h = seed + XXH_PRIME64_5;
+  }
+
+  h += uint64(size);
+
+  for (; p + 8 <= end; p += 8)
+  {
+    h ^= xxh_round(0, xxh_read64(p));
+    h  = xxh_rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+  }
+
+  if (p + 4 <= end)
+  {
+    h ^= uint64(xxh_read32(p)) * XXH_PRIME64_1;
+    h  = xxh_rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+    p += 4;
+  }
+
+  for (; p < end; p++)
+  {
+    h ^= (*p) * XXH_PRIME64_5;
+    h  = xxh_rotl64(h, 11) * XXH_PRIME64_1;
+  }
+
+  h ^= h >> 33;
+  h *= XXH_PRIME64_2;
+  h ^= h >> 29;
+  h *= XXH_PRIME64_3;
+  h ^= h >> 32;
+
+  return h;
+}
+
 /**
  * Base 64 Encode/Decode
  */
@@ -132,6 +241,25 @@ std::wstring crypt_md5_buffer_W(const std::vector<byte>& data)
   return to_string_W(result);
 }
 
+template <class file_mapping_t, typename std_string_t>
+static std::string crypt_md5_file_T(const std_string_t& file_path)
+{
+  md5_state ctx;
+  md5_init(&ctx);
+
+  const auto fn = [&](const void* ptr, const size_t size) -> void
+  {
+    md5_update(&ctx, ptr, size);
+  };
+
+  if (!crypt_file_T<file_mapping_t>(file_path, fn))
+  {
+    return "";
+  }
+
+  return md5_final(&ctx);
+}
+
 std::string crypt_md5_file_A(const std::string& file_path)
 {
   if (!is_file_exists_A(file_path))
@@ -139,7 +267,7 @@ std::string crypt_md5_file_A(const std::string& file_path)
     return "";
   }
 
-  return md5file(file_path.c_str());
+  return crypt_md5_file_T<FileMappingA>(file_path);
 }
 
 std::wstring crypt_md5_file_W(const std::wstring& file_path)
@@ -149,16 +277,7 @@ std::wstring crypt_md5_file_W(const std::wstring& file_path)
     return L"";
   }
 
-  FILE* file = nullptr;
-  _wfopen_s(&file, file_path.c_str(), L"rb");
-  if (file == nullptr)
-  {
-    return L"";
-  }
-
-  const auto result = md5file(file);
-
-  fclose(file);
+  const auto result = crypt_md5_file_T<FileMappingW>(file_path);
 
   return to_string_W(result);
 }
@@ -167,6 +286,11 @@ std::wstring crypt_md5_file_W(const std::wstring& file_path)
  * CRC
  */
 
+typedef CRC_t<8, 0x07, 0x00, false, false, 0x00> CRC_8_t;
+typedef CRC_t<16, 0x8005, 0x0000, true, true, 0x0000> CRC_16_t;
+typedef CRC_t<32, 0x04C11DB7, 0xFFFFFFFF, true, true, 0xFFFFFFFF> CRC_32_t;
+typedef CRC_t<64, 0x42F0E1EBA9EA3693, 0x0000000000000000, false, false, 0x0000000000000000> CRC_64_t;
+
 uint64 crypt_crc_buffer(const std::vector<byte>& data,
   uint8_t bits, uint64 poly, uint64 init, bool ref_in, bool ref_out, uint64 xor_out, uint64 check)
 {
@@ -206,28 +330,28 @@ uint64 crypt_crc_buffer(const std::vector<byte>& data, const crypt_bits bits)
   {
   case crypt_bits::_8:
     {
-      CRC_t<8, 0x07, 0x00, false, false, 0x00> crc;
+      CRC_8_t crc;
       return crc.get_crc(data.data(), data.size());
     }
     break;
 
   case crypt_bits::_16:
     {
-      CRC_t<16, 0x8005, 0x0000, true, true, 0x0000> crc;
+      CRC_16_t crc;
       return crc.get_crc(data.data(), data.size());
     }
     break;
 
   case crypt_bits::_32:
     {
-      CRC_t<32, 0x04C11DB7, 0xFFFFFFFF, true, true, 0xFFFFFFFF> crc;
+      CRC_32_t crc;
       return crc.get_crc(data.data(), data.size());
     }
     break;
 
   case crypt_bits::_64:
     {
-      CRC_t<64, 0x42F0E1EBA9EA3693, 0x0000000000000000, false, false, 0x0000000000000000> crc;
+      CRC_64_t crc;
       return crc.get_crc(data.data(), data.size());
     }
     break;
@@ -254,6 +378,48 @@ uint64 crypt_crc_text_W(const std::wstring& text, const crypt_bits bits)
   return crypt_crc_text_A(s, bits);
 }
 
+template <class file_mapping_t, class crc_t, typename std_string_t>
+static uint64 crypt_crc_file_impl_T(const crc_t& crc, const std_string_t& file_path)
+{
+  auto raw_crc = crc.get_crc_init();
+
+  const auto fn = [&](const void* ptr, const size_t size) -> void
+  {
+    raw_crc = crc.get_raw_crc(ptr, size, raw_crc);
+  };
+
+  if (!crypt_file_T<file_mapping_t>(file_path, fn))
+  {
+    return 0;
+  }
+
+  return crc.get_end_crc(raw_crc);
+}
+
+template <class file_mapping_t, typename std_string_t>
+static uint64 crypt_crc_file_T(const std_string_t& file_path, const crypt_bits bits)
+{
+  switch (bits)
+  {
+  case crypt_bits::_8:
+    return crypt_crc_file_impl_T<file_mapping_t>(CRC_8_t(), file_path);
+
+  case crypt_bits::_16:
+    return crypt_crc_file_impl_T<file_mapping_t>(CRC_16_t(), file_path);
+
+  case crypt_bits::_32:
+    return crypt_crc_file_impl_T<file_mapping_t>(CRC_32_t(), file_path);
+
+  case crypt_bits::_64:
+    return crypt_crc_file_impl_T<file_mapping_t>(CRC_64_t(), file_path);
+
+  default:
+    throw "invalid crc bits";
+  }
+
+  return 0;
+}
+
 uint64 crypt_crc_file_A(const std::string& file_path, const crypt_bits bits)
 {
   if (!is_file_exists_A(file_path))
@@ -261,16 +427,17 @@ uint64 crypt_crc_file_A(const std::string& file_path, const crypt_bits bits)
     return 0;
   }
 
-  std::vector<vu::byte> data;
-  vu::read_file_binary_A(file_path, data);
-
-  return crypt_crc_buffer(data, bits);
+  return crypt_crc_file_T<FileMappingA>(file_path, bits);
 }
 
 uint64 crypt_crc_file_W(const std::wstring& file_path, const crypt_bits bits)
 {
-  auto s = to_string_A(file_path);
-  return crypt_crc_file_A(s, bits);
+  if (!is_file_exists_W(file_path))
+  {
+    return 0;
+  }
+
+  return crypt_crc_file_T<FileMappingW>(file_path, bits);
 }
 
 /**
@@ -295,6 +462,86 @@ std::wstring crypt_sha_text_W(const std::wstring& text, const sha_version versio
   return to_string_W(hash);
 }
 
+static bool is_valid_sha_args(const sha_version version, const crypt_bits bits)
+{
+  bool valid_args = false;
+
+  valid_args |= (version == sha_version::_1) &&
+    (bits == crypt_bits::_160);
+
+  valid_args |= (version == sha_version::_2 || version == sha_version::_3) &&
+    (bits == crypt_bits::_224 || bits == crypt_bits::_384 || bits == crypt_bits::_256 || bits == crypt_bits::_512);
+
+  return valid_args;
+}
+
+template <class file_mapping_t, class hashing_t, typename std_string_t>
+static bool crypt_hash_file_T(hashing_t& hashing, const std_string_t& file_path, std::vector<byte>& hash)
+{
+  const auto fn = [&](const void* ptr, const size_t size) -> void
+  {
+    hashing.update(ptr, size);
+  };
+
+  if (!crypt_file_T<file_mapping_t>(file_path, fn))
+  {
+    return false;
+  }
+
+  hashing.finalize(hash);
+
+  return true;
+}
+
+template <class file_mapping_t, typename std_string_t>
+static bool crypt_sha_file_T(
+  const std_string_t& file_path,
+  const sha_version version,
+  const crypt_bits bits,
+  std::vector<byte>& hash)
+{
+  if (!is_valid_sha_args(version, bits))
+  {
+    throw "invalid sha bits";
+  }
+
+  if (version == sha_version::_1)
+  {
+    MDHashingT<uint32_t, 64, 20> hashing(sha_1::sha1_iteration, SHA_1_IV);
+    return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+  }
+  else if (version == sha_version::_2)
+  {
+    if (bits == crypt_bits::_224)
+    {
+      MDHashingT<uint32_t, 64, 28> hashing(sha_2_256::sha2_iteration, SHA_2_224_IV);
+      return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+    }
+    else if (bits == crypt_bits::_256)
+    {
+      MDHashingT<uint32_t, 64, 32> hashing(sha_2_256::sha2_iteration, SHA_2_256_IV);
+      return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+    }
+    else if (bits == crypt_bits::_384)
+    {
+      MDHashingT<uint64_t, 128, 48> hashing(sha_2_512::sha2_iteration, SHA_2_384_IV);
+      return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+    }
+    else if (bits == crypt_bits::_512)
+    {
+      MDHashingT<uint64_t, 128, 64> hashing(sha_2_512::sha2_iteration, SHA_2_512_IV);
+      return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+    }
+  }
+  else if (version == sha_version::_3)
+  {
+    SHA3 hashing(bits);
+    return crypt_hash_file_T<file_mapping_t>(hashing, file_path, hash);
+  }
+
+  return false;
+}
+
 std::string crypt_sha_file_A(const std::string& file_path, const sha_version version, const crypt_bits bits)
 {
   if (!is_file_exists_A(file_path))
@@ -302,11 +549,11 @@ std::string crypt_sha_file_A(const std::string& file_path, const sha_version ver
     return "";
   }
 
-  std::vector<vu::byte> data;
-  vu::read_file_binary_A(file_path, data);
-
   std::vector<byte> hash;
-  crypt_sha_buffer(data, version, bits, hash);
+  if (!crypt_sha_file_T<FileMappingA>(file_path, version, bits, hash))
+  {
+    return "";
+  }
 
   std::string result = to_hex_string_A(hash.data(), hash.size());
   return result;
@@ -314,9 +561,19 @@ std::string crypt_sha_file_A(const std::string& file_path, const sha_version ver
 
 std::wstring crypt_sha_file_W(const std::wstring& file_path, const sha_version version, const crypt_bits bits)
 {
-  const auto s = to_string_A(file_path);
-  auto hash = crypt_sha_file_A(s, version, bits);
-  return to_string_W(hash);
+  if (!is_file_exists_W(file_path))
+  {
+    return L"";
+  }
+
+  std::vector<byte> hash;
+  if (!crypt_sha_file_T<FileMappingW>(file_path, version, bits, hash))
+  {
+    return L"";
+  }
+
+  std::wstring result = to_hex_string_W(hash.data(), hash.size());
+  return result;
 }
 
 void crypt_sha_buffer(
@@ -325,15 +582,17 @@ void crypt_sha_buffer(
   const crypt_bits bits,
   std::vector<byte>& hash)
 {
-  bool valid_args = false;
-
-  valid_args |= (version == sha_version::_1) &&
-    (bits == crypt_bits::_160);
-
-  valid_args |= (version == sha_version::_2 || version == sha_version::_3) &&
-    (bits == crypt_bits::_224 || bits == crypt_bits::_384 || bits == crypt_bits::_256 || bits == crypt_bits::_512);
+  crypt_sha_buffer(data.data(), data.size(), version, bits, hash);
+}
 
-  if (!valid_args)
+void crypt_sha_buffer(
+  const void* ptr,
+  const size_t size,
+  const sha_version version,
+  const crypt_bits bits,
+  std::vector<byte>& hash)
+{
+  if (!is_valid_sha_args(version, bits))
   {
     throw "invalid sha bits";
   }
@@ -344,44 +603,44 @@ void crypt_sha_buffer(
 
   if (version == sha_version::_1)
   {
-    sha_1::sha1(data.data(), data.size(), pstr);
+    sha_1::sha1(ptr, size, pstr);
   }
   else if (version == sha_version::_2)
   {
     if (bits == crypt_bits::_224)
     {
-      sha_2_224::sha2(data.data(), data.size(), pstr);
+      sha_2_224::sha2(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_256)
     {
-      sha_2_256::sha2(data.data(), data.size(), pstr);
+      sha_2_256::sha2(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_384)
     {
-      sha_2_384::sha2(data.data(), data.size(), pstr);
+      sha_2_384::sha2(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_512)
     {
-      sha_2_512::sha2(data.data(), data.size(), pstr);
+      sha_2_512::sha2(ptr, size, pstr);
     }
   }
   else if (version == sha_version::_3)
   {
     if (bits == crypt_bits::_224)
     {
-      sha_3_224::sha3(data.data(), data.size(), pstr);
+      sha_3_224::sha3(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_256)
     {
-      sha_3_256::sha3(data.data(), data.size(), pstr);
+      sha_3_256::sha3(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_384)
     {
-      sha_3_384::sha3(data.data(), data.size(), pstr);
+      sha_3_384::sha3(ptr, size, pstr);
     }
     else if (bits == crypt_bits::_512)
     {
-      sha_3_512::sha3(data.data(), data.size(), pstr);
+      sha_3_512::sha3(ptr, size, pstr);
     }
   }
   else
@@ -390,4 +649,200 @@ void crypt_sha_buffer(
   }
 }
 
+static bool is_valid_sha3_bits(const crypt_bits bits)
+{
+  return bits == crypt_bits::_224 || bits == crypt_bits::_256 ||
+         bits == crypt_bits::_384 || bits == crypt_bits::_512;
+}
+
+static bool is_valid_shake_bits(const crypt_bits bits)
+{
+  return bits == crypt_bits::_128 || bits == crypt_bits::_256;
+}
+
+void crypt_sha3_buffers(
+  const std::vector<std::vector<byte>>& data,
+  const crypt_bits bits,
+  std::vector<std::vector<byte>>& hashes)
+{
+  if (!is_valid_sha3_bits(bits))
+  {
+    throw "invalid sha bits";
+  }
+
+  const auto digest_size = uint(bits) / 8;
+
+  hashes.resize(data.size());
+  for (auto& hash : hashes)
+  {
+    hash.resize(digest_size);
+  }
+
+  size_t i = 0;
+
+  for (; i + 4 <= data.size(); i += 4)
+  {
+    const uint8_t* ptr_data[4];
+    size_t sizes[4];
+    uint8_t* ptr_hashes[4];
+
+    for (size_t k = 0; k < 4; k++)
+    {
+      ptr_data[k]   = data[i + k].data();
+      sizes[k]      = data[i + k].size();
+      ptr_hashes[k] = hashes[i + k].data();
+    }
+
+    sha3_x4(ptr_data, sizes, digest_size, ptr_hashes);
+  }
+
+  for (; i < data.size(); i++)
+  {
+    sha3_state ctx;
+    sha3_init(&ctx, digest_size);
+    sha3_update(&ctx, data[i].data(), data[i].size());
+    sha3_final(&ctx, hashes[i].data());
+  }
+}
+
+/**
+ * SHAKE
+ */
+
+void crypt_shake_buffer(
+  const std::vector<byte>& data,
+  const crypt_bits bits,
+  const size_t size,
+  std::vector<byte>& output)
+{
+  SHAKE shake(bits);
+  shake.update(data);
+  shake.squeeze(output, size);
+}
+
+std::string crypt_shake_text_A(const std::string& text, const crypt_bits bits, const size_t size)
+{
+  SHAKE shake(bits);
+  shake.update(text.data(), text.size());
+
+  std::vector<byte> output;
+  shake.squeeze(output, size);
+
+  return to_hex_string_A(output.data(), output.size());
+}
+
+std::wstring crypt_shake_text_W(const std::wstring& text, const crypt_bits bits, const size_t size)
+{
+  const auto s = to_string_A(text);
+  auto hash = crypt_shake_text_A(s, bits, size);
+  return to_string_W(hash);
+}
+
+/**
+ * Keccak - SHA-3 & SHAKE (Incremental)
+ */
+
+KeccakX::KeccakX() : m_ptr_state(new sha3_state)
+{
+  memset(m_ptr_state, 0, sizeof(sha3_state));
+}
+
+KeccakX::KeccakX(const KeccakX& right) : m_ptr_state(new sha3_state)
+{
+  *this = right;
+}
+
+KeccakX::~KeccakX()
+{
+  delete m_ptr_state;
+  m_ptr_state = nullptr;
+}
+
+const KeccakX& KeccakX::operator=(const KeccakX& right)
+{
+  *m_ptr_state = *right.m_ptr_state;
+  return *this;
+}
+
+void KeccakX::update(const void* ptr, const size_t size)
+{
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  sha3_update(m_ptr_state, static_cast<const uint8_t*>(ptr), size);
+}
+
+void KeccakX::update(const std::vector<byte>& data)
+{
+  this->update(data.data(), data.size());
+}
+
+void KeccakX::update(const Buffer& data)
+{
+  this->update(data.get_ptr(), data.get_size());
+}
+
+SHA3::SHA3(const crypt_bits bits) : KeccakX(), m_bits(bits)
+{
+  if (!is_valid_sha3_bits(bits))
+  {
+    throw "invalid sha bits";
+  }
+
+  this->reset();
+}
+
+SHA3::~SHA3()
+{
+}
+
+void SHA3::reset()
+{
+  sha3_init(m_ptr_state, uint(m_bits) / 8);
+}
+
+void SHA3::finalize(std::vector<byte>& hash)
+{
+  hash.resize(uint(m_bits) / 8);
+  sha3_final(m_ptr_state, hash.data());
+  this->reset();
+}
+
+SHAKE::SHAKE(const crypt_bits bits) : KeccakX(), m_bits(bits)
+{
+  if (!is_valid_shake_bits(bits))
+  {
+    throw "invalid shake bits";
+  }
+
+  this->reset();
+}
+
+SHAKE::~SHAKE()
+{
+}
+
+void SHAKE::reset()
+{
+  shake_init(m_ptr_state, uint(m_bits) / 8);
+}
+
+void SHAKE::squeeze(void* ptr, const size_t size)
+{
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  shake_squeeze(m_ptr_state, static_cast<uint8_t*>(ptr), size);
+}
+
+void SHAKE::squeeze(std::vector<byte>& data, const size_t size)
+{
+  data.resize(size);
+  this->squeeze(data.data(), size);
+}
+
 } // vu
\ No newline at end of file
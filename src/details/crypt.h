@@ -0,0 +1,174 @@
+/**
+ * @file   crypt.h
+ * @author Vic P.
+ * @brief  Header for Cryptography
+ */
+
+#pragma once
+
+#include "Vutils.h"
+#include "defs.h"
+
+#include VU_3RD_INCL(Others/sha.h)
+
+namespace vu
+{
+
+/**
+ * File Iterating
+ * The file is mapped in large sliding windows and each window is fed straight to the callback.
+ * An empty file is a success without any callback.
+ */
+
+template <class file_mapping_t, typename std_string_t>
+bool crypt_file_T(
+  const std_string_t& file_path, const std::function<void(const void* ptr, const size_t size)> fn)
+{
+  file_mapping_t fm;
+
+  auto ret = fm.create_within_file(
+    file_path, 0, 0,
+    fs_generic::FG_READ,
+    fs_share::FS_READWRITE,
+    fs_mode::FM_OPENEXISTING,
+    fs_attribute(fs_attribute::FA_NORMAL | fs_attribute::FA_SEQUENTIALSCAN),
+    page_protection::PP_READ_ONLY);
+  if (ret != VU_OK)
+  {
+    return fm.get_file_size_ex() == 0; // an empty file could not be mapped
+  }
+
+  ret = fm.iterate_views([&](const void* ptr, const size_t size, const uint64 /*offset*/) -> bool
+  {
+    fn(ptr, size);
+    return true;
+  });
+
+  return ret == VU_OK;
+}
+
+/**
+ * XXH64 - The fast non-cryptographic hashing (https://github.com/Cyan4973/xxHash)
+ */
+
+uint64 xxh64(const void* ptr, const size_t size, const uint64 seed = 0);
+
+/**
+ * The streaming Merkle-Damgard hashing (SHA-1 & SHA-2) on top of their block iterations.
+ * The data is fed chunk by chunk, only the incomplete block is buffered.
+ */
+
+template <typename word_t, const size_t block_size, const size_t digest_size>
+class MDHashingT
+{
+public:
+  typedef void (*fn_iteration_t)(const uint8_t* data, word_t h[]);
+
+  MDHashingT(fn_iteration_t fn, const word_t (&iv)[8]) : m_fn_iteration(fn), m_used(0), m_total(0)
+  {
+    memcpy(m_h, iv, sizeof(m_h));
+  }
+
+  void update(const void* ptr, size_t size)
+  {
+    auto ptr_bytes = static_cast<const uint8_t*>(ptr);
+
+    m_total += size;
+
+    if (m_used != 0)
+    {
+      const auto n = (std::min)(block_size - m_used, size);
+      memcpy(m_block + m_used, ptr_bytes, n);
+      m_used += n;
+      ptr_bytes += n;
+      size -= n;
+
+      if (m_used < block_size)
+      {
+        return;
+      }
+
+      m_fn_iteration(m_block, m_h);
+      m_used = 0;
+    }
+
+    for (; size >= block_size; ptr_bytes += block_size, size -= block_size)
+    {
+      m_fn_iteration(ptr_bytes, m_h);
+    }
+
+    memcpy(m_block, ptr_bytes, size);
+    m_used = size;
+  }
+
+  void finalize(byte* digest)
+  {
+    const size_t length_size = block_size / 8; // 64-bit length for 64-byte blocks, 128-bit for 128-byte blocks
+
+    m_block[m_used++] = 0x80;
+
+    if (m_used > block_size - length_size)
+    {
+      memset(m_block + m_used, 0, block_size - m_used);
+      m_fn_iteration(m_block, m_h);
+      m_used = 0;
+    }
+
+    memset(m_block + m_used, 0, block_size - m_used);
+
+    const uint64 bits = m_total * 8;
+    for (size_t i = 0; i < 8; i++)
+    {
+      m_block[block_size - 1 - i] = uint8_t(bits >> (8 * i));
+    }
+
+    m_fn_iteration(m_block, m_h);
+
+    for (size_t i = 0; i < digest_size; i++) // big-endian words, truncated for SHA-224 & SHA-384
+    {
+      digest[i] = uint8_t(m_h[i / sizeof(word_t)] >> (8 * (sizeof(word_t) - 1 - i % sizeof(word_t))));
+    }
+  }
+
+  void finalize(std::vector<byte>& digest)
+  {
+    digest.resize(digest_size);
+    this->finalize(digest.data());
+  }
+
+private:
+  fn_iteration_t m_fn_iteration;
+  word_t m_h[8];
+  uint8_t m_block[block_size];
+  size_t m_used;
+  uint64 m_total;
+};
+
+static const uint32_t SHA_1_IV[8] =
+{
+  0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0, 0, 0, 0,
+};
+
+static const uint32_t SHA_2_224_IV[8] =
+{
+  0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4,
+};
+
+static const uint32_t SHA_2_256_IV[8] =
+{
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint64_t SHA_2_384_IV[8] =
+{
+  0xcbbb9d5dc1059ed8, 0x629a292a367cd507, 0x9159015a3070dd17, 0x152fecd8f70e5939,
+  0x67332667ffc00b31, 0x8eb44a8768581511, 0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4,
+};
+
+static const uint64_t SHA_2_512_IV[8] =
+{
+  0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+  0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179,
+};
+
+} // namespace vu
@@ -559,9 +559,12 @@ std::string normalize_path_A(const std::string& path, const path_separator separ
   const std::string SEP_POSIX = "/";
   const std::string sep = separator == path_separator::WIN ? SEP_WIN : SEP_POSIX;
 
-  result = replace_string_A(result, SEP_WIN + SEP_WIN, sep);
-  result = replace_string_A(result, SEP_WIN, sep);
-  result = replace_string_A(result, SEP_POSIX, sep);
+  std::map<std::string, std::string> replacements;
+  replacements[SEP_WIN + SEP_WIN] = sep;
+  replacements[SEP_WIN] = sep;
+  replacements[SEP_POSIX] = sep;
+
+  replace_all_in_place_A(result, replacements);
 
   return result;
 }
@@ -574,9 +577,12 @@ std::wstring normalize_path_W(const std::wstring& path, const path_separator sep
   const std::wstring SEP_POSIX = L"/";
   const std::wstring sep = separator == path_separator::WIN ? SEP_WIN : SEP_POSIX;
 
-  result = replace_string_W(result, SEP_WIN + SEP_WIN, sep);
-  result = replace_string_W(result, SEP_WIN, sep);
-  result = replace_string_W(result, SEP_POSIX, sep);
+  std::map<std::wstring, std::wstring> replacements;
+  replacements[SEP_WIN + SEP_WIN] = sep;
+  replacements[SEP_WIN] = sep;
+  replacements[SEP_POSIX] = sep;
+
+  replace_all_in_place_W(result, replacements);
 
   return result;
 }
@@ -649,7 +655,7 @@ bool PathA::operator==(const PathA& right)
   {
     if (m_separator == path_separator::WIN)
     {
-      result &= lower_string_A(m_path) == lower_string_A(right.m_path);
+      result &= compare_string_view_A(m_path, right.m_path, true);
     }
     else if (m_separator == path_separator::POSIX)
     {
@@ -790,7 +796,7 @@ bool PathW::operator==(const PathW& right)
   {
     if (m_separator == path_separator::WIN)
     {
-      result &= lower_string_W(m_path) == lower_string_W(right.m_path);
+      result &= compare_string_view_W(m_path, right.m_path, true);
     }
     else if (m_separator == path_separator::POSIX)
     {
@@ -5,6 +5,7 @@
  */
 
 #include "Vutils.h"
+#include "defs.h"
 
 namespace vu
 {
@@ -90,6 +91,98 @@ ulong vuapi FileMappingX::get_file_size()
   return result;
 }
 
+uint64 vuapi FileMappingX::get_file_size_ex()
+{
+  if (!this->valid(m_file_handle))
+  {
+    return uint64(-1);
+  }
+
+  LARGE_INTEGER size = { 0 };
+  const auto ret = ::GetFileSizeEx(m_file_handle, &size);
+
+  m_last_error_code = GetLastError();
+
+  return ret != FALSE ? uint64(size.QuadPart) : uint64(-1);
+}
+
+VUResult vuapi FileMappingX::iterate_views(
+  const std::function<bool(const void* ptr, const size_t size, const uint64 offset)> fn,
+  const size_t window_size,
+  desired_access the_desired_access
+)
+{
+  if (!this->valid(m_map_handle) || fn == nullptr)
+  {
+    return 1;
+  }
+
+  const auto file_size = this->get_file_size_ex();
+  if (file_size == uint64(-1))
+  {
+    return 2;
+  }
+
+  // The memory range entry of PrefetchVirtualMemory (WIN32_MEMORY_RANGE_ENTRY, Windows 8+)
+
+  struct MemoryRangeEntry
+  {
+    PVOID  VirtualAddress;
+    SIZE_T NumberOfBytes;
+  };
+
+  typedef BOOL (WINAPI *PfnPrefetchVirtualMemory)(
+    HANDLE hProcess, ULONG_PTR NumberOfEntries, MemoryRangeEntry* VirtualAddresses, ULONG Flags);
+
+  static auto pfnPrefetchVirtualMemory = (PfnPrefetchVirtualMemory)Library::quick_get_proc_address(
+    _T("kernel32.dll"), _T("PrefetchVirtualMemory"));
+
+  SYSTEM_INFO si = { 0 };
+  GetSystemInfo(&si);
+
+  const uint64 granularity = si.dwAllocationGranularity;
+  const uint64 window = (std::max)(granularity, (uint64(window_size) + granularity - 1) / granularity * granularity);
+
+  for (uint64 offset = 0; offset < file_size; offset += window)
+  {
+    const auto size = SIZE_T((std::min)(window, file_size - offset));
+
+    auto ptr = MapViewOfFile(
+      m_map_handle,
+      the_desired_access,
+      ulong(offset >> 32),
+      ulong(offset & 0xFFFFFFFF),
+      size
+    );
+
+    m_last_error_code = GetLastError();
+
+    if (ptr == nullptr)
+    {
+      return 3;
+    }
+
+    // Sequential hint, the pages of the whole window are read ahead asynchronously
+
+    if (pfnPrefetchVirtualMemory != nullptr)
+    {
+      MemoryRangeEntry range = { ptr, size };
+      pfnPrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+
+    const bool next = fn(ptr, size, offset);
+
+    UnmapViewOfFile(ptr);
+
+    if (!next)
+    {
+      break;
+    }
+  }
+
+  return VU_OK;
+}
+
 /**
  * FileMappingA
  */
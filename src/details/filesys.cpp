@@ -11,6 +11,60 @@
 namespace vu
 {
 
+/**
+ * Decodes the UTF-16 & the UTF-32 text of a buffer (by its detected encoding)
+ */
+
+static std::wstring decode_wide_text(const Buffer& buffer, const EncodingDetection& detection, bool remove_bom)
+{
+  std::wstring result;
+
+  const auto offset = remove_bom ? detection.bom_size : 0;
+  const auto p = buffer.get_ptr_bytes() + offset;
+  const auto n = buffer.get_size() - offset;
+
+  switch (detection.type)
+  {
+  case encoding_type::ET_UTF16_LE:
+  case encoding_type::ET_UTF16_LE_BOM:
+    result.resize(n / 2);
+    memcpy(&result[0], p, result.size() * sizeof(wchar));
+    break;
+
+  case encoding_type::ET_UTF16_BE:
+  case encoding_type::ET_UTF16_BE_BOM:
+    result.resize(n / 2);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+      result[i] = wchar((p[2 * i] << 8) | p[2 * i + 1]);
+    }
+    break;
+
+  case encoding_type::ET_UTF32_LE_BOM:
+  case encoding_type::ET_UTF32_BE_BOM:
+    {
+      const bool le = detection.type == encoding_type::ET_UTF32_LE_BOM;
+
+      std::u32string text(n / 4, 0);
+      for (size_t i = 0; i < text.size(); i++)
+      {
+        const auto q = p + 4 * i;
+        text[i] = le ?
+          char32_t(q[0] | (q[1] << 8) | (q[2] << 16) | (uint32(q[3]) << 24)) :
+          char32_t(q[3] | (q[2] << 8) | (q[1] << 16) | (uint32(q[0]) << 24));
+      }
+
+      utf32_to_utf16(text, result);
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return result;
+}
+
 FileSystemX::FileSystemX() : LastError()
 {
   m_read_size  = 0;
@@ -207,21 +261,27 @@ const std::string vuapi FileSystemA::read_as_string(bool remove_bom)
   std::string result("");
 
   auto buffer = this->read_as_buffer();
-  auto p = (char*)buffer.get_ptr();
+  if (buffer.empty())
+  {
+    return result;
+  }
 
-  auto encoding = determine_encoding_type(buffer.get_ptr(), buffer.get_size());
-  if (encoding == encoding_type::ET_UNKNOWN)
+  auto detection = detect_encoding(buffer.get_ptr(), buffer.get_size());
+  if (detection.type == encoding_type::ET_UNKNOWN)
   {
     assert(0);
     return result;
   }
 
-  if (remove_bom && encoding == encoding_type::ET_UTF8_BOM)
+  if (detection.type == encoding_type::ET_UTF8 || detection.type == encoding_type::ET_UTF8_BOM)
   {
-    p += 3; /* remove BOM */
+    const auto offset = remove_bom ? detection.bom_size : 0; /* remove BOM */
+    result.assign((char*)buffer.get_ptr() + offset, buffer.get_size() - offset);
+  }
+  else
+  {
+    result = to_string_A(decode_wide_text(buffer, detection, remove_bom));
   }
-
-  result.assign(p);
 
   return result;
 }
@@ -332,22 +392,32 @@ const std::wstring vuapi FileSystemW::read_as_string(bool remove_bom)
   std::wstring result(L"");
 
   auto buffer = this->read_as_buffer();
-  auto p = (wchar*)buffer.get_ptr();
+  if (buffer.empty())
+  {
+    return result;
+  }
 
-  auto encoding = determine_encoding_type(buffer.get_ptr(), buffer.get_size());
-  if (encoding == encoding_type::ET_UNKNOWN)
+  auto detection = detect_encoding(buffer.get_ptr(), buffer.get_size());
+  if (detection.type == encoding_type::ET_UNKNOWN)
   {
     assert(0);
     return result;
   }
 
-  if (remove_bom && (encoding == encoding_type::ET_UTF16_LE_BOM || encoding == encoding_type::ET_UTF16_BE_BOM))
+  if (detection.type == encoding_type::ET_UTF8 || detection.type == encoding_type::ET_UTF8_BOM)
+  {
+    const auto offset = remove_bom ? detection.bom_size : 0; /* remove BOM */
+    const std::string text((char*)buffer.get_ptr() + offset, buffer.get_size() - offset);
+    if (!utf8_to_utf16(text, result)) // not UTF-8 so it's ANSI
+    {
+      result = to_string_W(text);
+    }
+  }
+  else
   {
-    p = (wchar*)((char*)buffer.get_ptr() + 2); /* remove BOM */
+    result = decode_wide_text(buffer, detection, remove_bom);
   }
 
-  result.assign(p);
-
   return result;
 }
 
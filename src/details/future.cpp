@@ -0,0 +1,189 @@
+/**
+ * @file   future.cpp
+ * @author Vic P.
+ * @brief  Implementation for Task Future
+ */
+
+#include "Vutils.h"
+
+#include <condition_variable>
+
+namespace vu
+{
+
+/**
+ * TaskWaiter
+ * The locks and the condition variables that are shared by the task states, picked by the
+ * address of the state, so a task state doesn't own any of them.
+ */
+
+struct TaskWaiter
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+static const size_t NUM_TASK_WAITERS = 64;
+
+static TaskWaiter g_task_waiters[NUM_TASK_WAITERS];
+
+static TaskWaiter& get_task_waiter(const void* ptr)
+{
+  return g_task_waiters[(size_t(ptr) / sizeof(void*)) % NUM_TASK_WAITERS];
+}
+
+/**
+ * TaskState
+ */
+
+TaskState::TaskState(ThreadPool* ptr_pool) : m_ptr_pool(ptr_pool), m_ready(false), m_observers(0)
+{
+}
+
+TaskState::~TaskState()
+{
+}
+
+ThreadPool* TaskState::pool() const
+{
+  return m_ptr_pool;
+}
+
+bool TaskState::ready() const
+{
+  return m_ready.load(std::memory_order_acquire);
+}
+
+bool TaskState::failed() const
+{
+  return this->ready() && m_ptr_exception != nullptr;
+}
+
+void TaskState::wait() const
+{
+  if (this->ready())
+  {
+    return;
+  }
+
+  // a worker runs the other tasks while waiting, else the pool could run out of workers
+
+  if (m_ptr_pool != nullptr && m_ptr_pool->in_worker_thread())
+  {
+    while (!this->ready())
+    {
+      if (!m_ptr_pool->run_pending_task())
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    return;
+  }
+
+  auto& waiter = get_task_waiter(this);
+
+  std::unique_lock<std::mutex> lk(waiter.mutex);
+  m_observers.fetch_add(1);
+  waiter.cv.wait(lk, [this]() { return this->ready(); });
+  m_observers.fetch_sub(1);
+}
+
+bool TaskState::wait_for(const std::chrono::milliseconds& timeout) const
+{
+  if (this->ready())
+  {
+    return true;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  if (m_ptr_pool != nullptr && m_ptr_pool->in_worker_thread())
+  {
+    while (!this->ready() && std::chrono::steady_clock::now() < deadline)
+    {
+      if (!m_ptr_pool->run_pending_task())
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    return this->ready();
+  }
+
+  auto& waiter = get_task_waiter(this);
+
+  std::unique_lock<std::mutex> lk(waiter.mutex);
+  m_observers.fetch_add(1);
+  const bool result = waiter.cv.wait_until(lk, deadline, [this]() { return this->ready(); });
+  m_observers.fetch_sub(1);
+
+  return result;
+}
+
+void TaskState::on_ready(fn_task_t&& fn)
+{
+  if (!this->ready())
+  {
+    auto& waiter = get_task_waiter(this);
+
+    std::lock_guard<std::mutex> lg(waiter.mutex);
+
+    // the observer is counted before checking the state again, set_ready() does the opposite,
+    // so either the continuation is queued and seen by set_ready() or it's run here
+
+    m_observers.fetch_add(1);
+
+    if (!m_ready.load())
+    {
+      m_continuations.push_back(std::move(fn));
+      return;
+    }
+
+    m_observers.fetch_sub(1);
+  }
+
+  fn();
+}
+
+void TaskState::set_exception(std::exception_ptr ptr_exception)
+{
+  m_ptr_exception = ptr_exception;
+  this->set_ready();
+}
+
+void TaskState::set_ready()
+{
+  m_ready.store(true);
+
+  if (m_observers.load() == 0)
+  {
+    return;
+  }
+
+  std::vector<fn_task_t> continuations;
+
+  auto& waiter = get_task_waiter(this);
+
+  {
+    std::lock_guard<std::mutex> lg(waiter.mutex);
+    continuations.swap(m_continuations);
+  }
+
+  waiter.cv.notify_all();
+
+  for (auto& fn : continuations)
+  {
+    fn();
+  }
+}
+
+void TaskState::rethrow_if_failed() const
+{
+  if (m_ptr_exception != nullptr)
+  {
+    std::rethrow_exception(m_ptr_exception);
+  }
+}
+
+} // namespace vu
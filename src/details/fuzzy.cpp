@@ -0,0 +1,364 @@
+/**
+ * @file   fuzzy.cpp
+ * @author Vic P.
+ * @brief  Implementation for Fuzzy Hashing
+ */
+
+#include "Vutils.h"
+#include "crypt.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace vu
+{
+
+/**
+ * The bucket of a triplet of the sliding window (the multiplicative hashing then the 7 highest bits)
+ */
+
+static inline uint32 fuzzy_bucket(const uint32 salt, const byte a, const byte b, const byte c)
+{
+  uint32 x = (salt << 24) | (uint32(a) << 16) | (uint32(b) << 8) | uint32(c);
+  x *= 0x9E3779B1u;
+  x ^= x >> 15;
+  x *= 0x85EBCA77u;
+  return x >> (32 - 7);
+}
+
+/**
+ * The length value (logarithmic) of the data, in a byte
+ */
+
+static byte fuzzy_length_value(const uint64 size)
+{
+  const double v = double(size);
+
+  int l = 0;
+
+  if (size <= 656)
+  {
+    l = int(std::floor(std::log(v) / std::log(1.5)));
+  }
+  else if (size <= 3199)
+  {
+    l = int(std::floor(std::log(v) / std::log(1.3) - 8.72777));
+  }
+  else
+  {
+    l = int(std::floor(std::log(v) / std::log(1.1) - 62.5472));
+  }
+
+  return byte(l & 0xFF);
+}
+
+/**
+ * The count of the set bits of a 64-bit word (SWAR, so no POPCNT instruction is required)
+ */
+
+static inline int fuzzy_popcount(uint64 v)
+{
+  v = v - ((v >> 1) & 0x5555555555555555ULL);
+  v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return int((v * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * The distance of two values in a circular range
+ */
+
+static inline int fuzzy_mod_diff(const int x, const int y, const int range)
+{
+  const int d = x > y ? x - y : y - x;
+  return (std::min)(d, range - d);
+}
+
+/**
+ * The streaming builder, the last 4 bytes of the sliding window are kept between the chunks
+ */
+
+class FuzzyBuilder
+{
+public:
+  FuzzyBuilder() : m_size(0), m_checksum(0)
+  {
+    memset(m_window, 0, sizeof(m_window));
+    memset(m_buckets, 0, sizeof(m_buckets));
+  }
+
+  void update(const void* ptr, const size_t size)
+  {
+    auto p = static_cast<const byte*>(ptr);
+
+    byte c1 = m_window[0], c2 = m_window[1], c3 = m_window[2], c4 = m_window[3];
+
+    for (size_t i = 0; i < size; i++)
+    {
+      const byte c0 = p[i];
+
+      if (m_size + i >= 4)
+      {
+        m_checksum = byte(fuzzy_bucket(1, c0, c1, m_checksum) ^ m_checksum);
+
+        m_buckets[fuzzy_bucket( 2, c0, c1, c2)]++;
+        m_buckets[fuzzy_bucket( 3, c0, c1, c3)]++;
+        m_buckets[fuzzy_bucket( 5, c0, c2, c3)]++;
+        m_buckets[fuzzy_bucket( 7, c0, c2, c4)]++;
+        m_buckets[fuzzy_bucket(11, c0, c1, c4)]++;
+        m_buckets[fuzzy_bucket(13, c0, c3, c4)]++;
+      }
+
+      c4 = c3;
+      c3 = c2;
+      c2 = c1;
+      c1 = c0;
+    }
+
+    m_window[0] = c1;
+    m_window[1] = c2;
+    m_window[2] = c3;
+    m_window[3] = c4;
+
+    m_size += size;
+  }
+
+  bool finalize(FuzzyHash& hash)
+  {
+    memset(&hash, 0, sizeof(hash));
+
+    if (m_size < FuzzyHash::MIN_SIZE)
+    {
+      return false;
+    }
+
+    uint32 sorted[FuzzyHash::BUCKETS];
+    memcpy(sorted, m_buckets, sizeof(sorted));
+
+    const auto q = FuzzyHash::BUCKETS / 4;
+    std::nth_element(sorted, sorted + 3 * q - 1, sorted + FuzzyHash::BUCKETS);
+    const auto q3 = sorted[3 * q - 1];
+    std::nth_element(sorted, sorted + 2 * q - 1, sorted + 3 * q - 1);
+    const auto q2 = sorted[2 * q - 1];
+    std::nth_element(sorted, sorted + q - 1, sorted + 2 * q - 1);
+    const auto q1 = sorted[q - 1];
+
+    if (q3 == 0)
+    {
+      return false; // too uniform, most of the buckets are empty
+    }
+
+    for (size_t i = 0; i < FuzzyHash::BUCKETS; i++)
+    {
+      const auto v = m_buckets[i];
+      const uint64 code = v <= q1 ? 0 : v <= q2 ? 1 : v <= q3 ? 2 : 3;
+      const uint64 bit = 1ULL << (i % 64);
+
+      if (code & 2)
+      {
+        hash.body_hi[i / 64] |= bit;
+      }
+
+      if (code & 1)
+      {
+        hash.body_lo[i / 64] |= bit;
+      }
+    }
+
+    hash.checksum = m_checksum;
+    hash.lvalue   = fuzzy_length_value(m_size);
+    hash.q1_ratio = byte(uint64(q1) * 100 / q3 % 16);
+    hash.q2_ratio = byte(uint64(q2) * 100 / q3 % 16);
+
+    return true;
+  }
+
+private:
+  uint64 m_size;
+  byte   m_window[4];
+  byte   m_checksum;
+  uint32 m_buckets[FuzzyHash::BUCKETS];
+};
+
+/**
+ * Fuzzy Hashing
+ */
+
+bool vuapi crypt_fuzzy_buffer(const void* ptr, const size_t size, FuzzyHash& hash)
+{
+  if (ptr == nullptr && size != 0)
+  {
+    return false;
+  }
+
+  FuzzyBuilder builder;
+  builder.update(ptr, size);
+  return builder.finalize(hash);
+}
+
+bool vuapi crypt_fuzzy_buffer(const std::vector<byte>& data, FuzzyHash& hash)
+{
+  return crypt_fuzzy_buffer(data.data(), data.size(), hash);
+}
+
+bool vuapi crypt_fuzzy_buffer(const Buffer& data, FuzzyHash& hash)
+{
+  return crypt_fuzzy_buffer(data.get_ptr(), data.get_size(), hash);
+}
+
+template <class file_mapping_t, typename std_string_t>
+bool crypt_fuzzy_file_T(const std_string_t& file_path, FuzzyHash& hash)
+{
+  FuzzyBuilder builder;
+
+  if (!crypt_file_T<file_mapping_t>(file_path, [&](const void* ptr, const size_t size) -> void
+  {
+    builder.update(ptr, size);
+  }))
+  {
+    memset(&hash, 0, sizeof(hash));
+    return false;
+  }
+
+  return builder.finalize(hash);
+}
+
+bool vuapi crypt_fuzzy_file_A(const std::string& file_path, FuzzyHash& hash)
+{
+  return crypt_fuzzy_file_T<FileMappingA>(file_path, hash);
+}
+
+bool vuapi crypt_fuzzy_file_W(const std::wstring& file_path, FuzzyHash& hash)
+{
+  return crypt_fuzzy_file_T<FileMappingW>(file_path, hash);
+}
+
+int vuapi crypt_fuzzy_compare(const FuzzyHash& left, const FuzzyHash& right)
+{
+  int result = 0;
+
+  // the header
+
+  if (left.checksum != right.checksum)
+  {
+    result += 1;
+  }
+
+  const int ldiff = fuzzy_mod_diff(left.lvalue, right.lvalue, 256);
+  result += ldiff <= 1 ? ldiff : ldiff * 12;
+
+  const int q1diff = fuzzy_mod_diff(left.q1_ratio, right.q1_ratio, 16);
+  result += q1diff <= 1 ? q1diff : (q1diff - 1) * 12;
+
+  const int q2diff = fuzzy_mod_diff(left.q2_ratio, right.q2_ratio, 16);
+  result += q2diff <= 1 ? q2diff : (q2diff - 1) * 12;
+
+  // the body, the 2-bit codes are compared on their bit-planes
+  // distance of codes : 0 (same), 1 (lo bit differs), 2 (hi bit differs), 1 (1 vs 2) or 6 (0 vs 3)
+
+  for (size_t i = 0; i < FuzzyHash::BUCKETS / 64; i++)
+  {
+    const uint64 h  = left.body_hi[i] ^ right.body_hi[i];
+    const uint64 l  = left.body_lo[i] ^ right.body_lo[i];
+    const uint64 c3 = (left.body_hi[i] & left.body_lo[i]) | (right.body_hi[i] & right.body_lo[i]);
+
+    result += fuzzy_popcount(l & ~h);
+    result += fuzzy_popcount(h & ~l) * 2;
+    result += fuzzy_popcount(h & l);
+    result += fuzzy_popcount(h & l & c3) * 5;
+  }
+
+  return result;
+}
+
+void vuapi crypt_fuzzy_compare(
+  const FuzzyHash& hash, const FuzzyHash* hashes, const size_t count, int* distances)
+{
+  if (hashes == nullptr || distances == nullptr)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    distances[i] = crypt_fuzzy_compare(hash, hashes[i]);
+  }
+}
+
+void vuapi crypt_fuzzy_compare(
+  const FuzzyHash& hash, const std::vector<FuzzyHash>& hashes, std::vector<int>& distances)
+{
+  distances.resize(hashes.size());
+  crypt_fuzzy_compare(hash, hashes.data(), hashes.size(), distances.data());
+}
+
+/**
+ * The text form is the hex string of the header then the body (72 characters)
+ */
+
+static void fuzzy_to_bytes(const FuzzyHash& hash, byte bytes[FuzzyHash::TEXT_SIZE / 2])
+{
+  bytes[0] = hash.checksum;
+  bytes[1] = hash.lvalue;
+  bytes[2] = hash.q1_ratio;
+  bytes[3] = hash.q2_ratio;
+
+  for (size_t i = 0; i < 32; i++)
+  {
+    const auto& plane = i < 16 ? hash.body_hi : hash.body_lo;
+    const auto j = i % 16;
+    bytes[4 + i] = byte(plane[j / 8] >> (8 * (j % 8)));
+  }
+}
+
+static bool fuzzy_from_bytes(const std::vector<byte>& bytes, FuzzyHash& hash)
+{
+  memset(&hash, 0, sizeof(hash));
+
+  if (bytes.size() != FuzzyHash::TEXT_SIZE / 2 || bytes[2] > 15 || bytes[3] > 15)
+  {
+    return false;
+  }
+
+  hash.checksum = bytes[0];
+  hash.lvalue   = bytes[1];
+  hash.q1_ratio = bytes[2];
+  hash.q2_ratio = bytes[3];
+
+  for (size_t i = 0; i < 32; i++)
+  {
+    auto& plane = i < 16 ? hash.body_hi : hash.body_lo;
+    const auto j = i % 16;
+    plane[j / 8] |= uint64(bytes[4 + i]) << (8 * (j % 8));
+  }
+
+  return true;
+}
+
+std::string vuapi crypt_fuzzy_to_string_A(const FuzzyHash& hash)
+{
+  byte bytes[FuzzyHash::TEXT_SIZE / 2];
+  fuzzy_to_bytes(hash, bytes);
+  return to_hex_string_A(bytes, sizeof(bytes));
+}
+
+std::wstring vuapi crypt_fuzzy_to_string_W(const FuzzyHash& hash)
+{
+  byte bytes[FuzzyHash::TEXT_SIZE / 2];
+  fuzzy_to_bytes(hash, bytes);
+  return to_hex_string_W(bytes, sizeof(bytes));
+}
+
+bool vuapi crypt_fuzzy_from_string_A(const std::string& text, FuzzyHash& hash)
+{
+  std::vector<byte> bytes;
+  return to_hex_bytes_A(text, bytes) && fuzzy_from_bytes(bytes, hash);
+}
+
+bool vuapi crypt_fuzzy_from_string_W(const std::wstring& text, FuzzyHash& hash)
+{
+  std::vector<byte> bytes;
+  return to_hex_bytes_W(text, bytes) && fuzzy_from_bytes(bytes, hash);
+}
+
+} // namespace vu
@@ -10,6 +10,26 @@
 namespace vu
 {
 
+/**
+ * Reads the leading number of a value, the rest is ignored (eg. "100 ; comment" or "12abc"),
+ * the same as GetPrivateProfileInt and atof. Returns the default value if there is no number.
+ */
+
+template <typename T, typename char_t>
+static T read_leading_number(const char_t* ptr, size_t size, const T default_value)
+{
+  while (size != 0 && (*ptr == char_t(' ') || *ptr == char_t('\t')))
+  {
+    ptr++;
+    size--;
+  }
+
+  typename NumberTypeT<T>::type number = 0;
+  const auto result = number_from_chars(ptr, size, number);
+
+  return result.ok() && result.position > 0 && NumberTypeT<T>::in_range(number) ? T(number) : default_value;
+}
+
 INIFileA::INIFileA() : LastError()
 {
   m_section  = "";
@@ -108,11 +128,18 @@ std::vector<std::string> vuapi INIFileA::read_section(const std::string& section
 int vuapi INIFileA::read_integer(
   const std::string& section, const std::string& key, int default_value)
 {
+  char sz_result[MAX_SIZE];
+
+  ZeroMemory(sz_result, sizeof(sz_result));
+
   this->update_file_path();
-  uint result = GetPrivateProfileIntA(
-    section.c_str(), key.c_str(), default_value, m_file_path.c_str());
+
+  const auto n = GetPrivateProfileStringA(
+    section.c_str(), key.c_str(), "", sz_result, MAX_SIZE, m_file_path.c_str());
+
   m_last_error_code = GetLastError();
-  return result;
+
+  return read_leading_number(sz_result, n, default_value);
 }
 
 bool vuapi INIFileA::read_bool(
@@ -128,19 +155,18 @@ bool vuapi INIFileA::read_bool(
 float vuapi INIFileA::read_float(
   const std::string& section, const std::string& key, float default_value)
 {
-  const std::string tmp_default = number_to_string_A(default_value);
   char sz_result[MAX_SIZE];
 
   ZeroMemory(sz_result, sizeof(sz_result));
 
   this->update_file_path();
 
-  GetPrivateProfileStringA(
-    section.c_str(), key.c_str(), tmp_default.c_str(), sz_result, MAX_SIZE, m_file_path.c_str());
+  const auto n = GetPrivateProfileStringA(
+    section.c_str(), key.c_str(), "", sz_result, MAX_SIZE, m_file_path.c_str());
 
   m_last_error_code = GetLastError();
 
-  return (float)atof(sz_result);
+  return read_leading_number(sz_result, n, default_value);
 }
 
 std::string vuapi INIFileA::read_string(
@@ -411,11 +437,18 @@ std::vector<std::wstring> vuapi INIFileW::read_section(const std::wstring& secti
 int vuapi INIFileW::read_integer(
   const std::wstring& section, const std::wstring& key, int default_value)
 {
+  wchar sz_result[MAX_SIZE];
+
+  ZeroMemory(sz_result, sizeof(sz_result));
+
   this->update_file_path();
-  int result = GetPrivateProfileIntW(
-    section.c_str(), key.c_str(), default_value, m_file_path.c_str());
+
+  const auto n = GetPrivateProfileStringW(
+    section.c_str(), key.c_str(), L"", sz_result, MAX_SIZE, m_file_path.c_str());
+
   m_last_error_code = GetLastError();
-  return result;
+
+  return read_leading_number(sz_result, n, default_value);
 }
 
 bool vuapi INIFileW::read_bool(
@@ -431,27 +464,18 @@ bool vuapi INIFileW::read_bool(
 float vuapi INIFileW::read_float(
   const std::wstring& section, const std::wstring& key, float default_value)
 {
-  this->update_file_path();
-
-  const std::wstring tmp_default = number_to_string_W(default_value);
   wchar sz_result[MAX_SIZE];
 
   ZeroMemory(sz_result, sizeof(sz_result));
 
-  GetPrivateProfileStringW(
-    section.c_str(),
-    key.c_str(),
-    tmp_default.c_str(),
-    sz_result,
-    sizeof(sz_result),
-    m_file_path.c_str()
-  );
+  this->update_file_path();
 
-  m_last_error_code = GetLastError();
+  const auto n = GetPrivateProfileStringW(
+    section.c_str(), key.c_str(), L"", sz_result, MAX_SIZE, m_file_path.c_str());
 
-  const std::string s = to_string_A(sz_result);
+  m_last_error_code = GetLastError();
 
-  return (float)atof(s.c_str());
+  return read_leading_number(sz_result, n, default_value);
 }
 
 std::wstring vuapi INIFileW::read_string(
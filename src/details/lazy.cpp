@@ -295,6 +295,12 @@ VUResult vuapi Initialize_DLL_MISC()
     return ERROR_CODE(__LINE__);
   }
 
+  pfn_vswprintf = (Pfn_vswprintf)vu::Library::quick_get_proc_address(_T("msvcrt.dll"), _T("_vsnwprintf"));
+  if (pfn_vswprintf == nullptr)
+  {
+    return ERROR_CODE(__LINE__);
+  }
+
   VU_GET_API(advapi32.dll, CheckTokenMembership);
   if (pfnCheckTokenMembership == nullptr)
   {
@@ -6,6 +6,7 @@
 
 #include "Vutils.h"
 
+#include <cmath>
 #include <algorithm>
 
 namespace vu
@@ -105,4 +106,156 @@ intptr vuapi lcm(ulongptr count, ...) // Least Common Multiples -> UCLN = | a1 *
   return result;
 }
 
-} // namespace vu
\ No newline at end of file
+/**
+ * Byte Histogram & Entropy
+ */
+
+void vuapi byte_histogram(const void* ptr, const size_t size, uint64 (&histogram)[256], const bool accumulate)
+{
+  if (!accumulate)
+  {
+    memset(histogram, 0, sizeof(histogram));
+  }
+
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  auto p = static_cast<const byte*>(ptr);
+  auto n = size;
+
+  // 4 sub-histograms, so the increments of the consecutive bytes rarely hit the same counter
+  // and do not stall on the store-to-load forwarding. 8 bytes are loaded at once.
+  // The 32-bit counters are flushed before they could overflow.
+
+  const size_t block_size = 1ULL << 30;
+
+  uint32 counters[4][256] = { 0 };
+  auto c0 = counters[0], c1 = counters[1], c2 = counters[2], c3 = counters[3];
+
+  while (n >= 8)
+  {
+    const auto block = (std::min)(n, block_size) & ~size_t(7);
+
+    for (size_t i = 0; i < block; i += 8)
+    {
+      uint64 v = 0;
+      memcpy(&v, p + i, sizeof(v));
+
+      c0[byte(v)]++;
+      c1[byte(v >> 8)]++;
+      c2[byte(v >> 16)]++;
+      c3[byte(v >> 24)]++;
+      c0[byte(v >> 32)]++;
+      c1[byte(v >> 40)]++;
+      c2[byte(v >> 48)]++;
+      c3[byte(v >> 56)]++;
+    }
+
+    for (size_t i = 0; i < 256; i++)
+    {
+      histogram[i] += uint64(c0[i]) + c1[i] + c2[i] + c3[i];
+    }
+
+    memset(counters, 0, sizeof(counters));
+
+    p += block;
+    n -= block;
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    histogram[p[i]]++;
+  }
+}
+
+double vuapi shannon_entropy(const uint64 (&histogram)[256])
+{
+  uint64 total = 0;
+  for (const auto& e : histogram)
+  {
+    total += e;
+  }
+
+  if (total == 0)
+  {
+    return 0.;
+  }
+
+  // H = -sum(p * log2(p)) = log2(N) - sum(c * log2(c)) / N
+
+  double sum = 0.;
+  for (const auto& e : histogram)
+  {
+    if (e != 0)
+    {
+      sum += double(e) * std::log(double(e));
+    }
+  }
+
+  const double result = (std::log(double(total)) - sum / double(total)) / std::log(2.);
+
+  return result < 0. ? 0. : result;
+}
+
+double vuapi shannon_entropy(const void* ptr, const size_t size)
+{
+  uint64 histogram[256];
+  byte_histogram(ptr, size, histogram);
+  return shannon_entropy(histogram);
+}
+
+double vuapi shannon_entropy(const std::vector<byte>& data)
+{
+  return shannon_entropy(data.data(), data.size());
+}
+
+double vuapi shannon_entropy(const Buffer& data)
+{
+  return shannon_entropy(data.get_ptr(), data.get_size());
+}
+
+double vuapi chi_square(const uint64 (&histogram)[256])
+{
+  uint64 total = 0;
+  for (const auto& e : histogram)
+  {
+    total += e;
+  }
+
+  if (total == 0)
+  {
+    return 0.;
+  }
+
+  const double expected = double(total) / 256.;
+
+  double result = 0.;
+  for (const auto& e : histogram)
+  {
+    const double d = double(e) - expected;
+    result += d * d;
+  }
+
+  return result / expected;
+}
+
+double vuapi chi_square(const void* ptr, const size_t size)
+{
+  uint64 histogram[256];
+  byte_histogram(ptr, size, histogram);
+  return chi_square(histogram);
+}
+
+double vuapi chi_square(const std::vector<byte>& data)
+{
+  return chi_square(data.data(), data.size());
+}
+
+double vuapi chi_square(const Buffer& data)
+{
+  return chi_square(data.get_ptr(), data.get_size());
+}
+
+} // namespace vu
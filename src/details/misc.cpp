@@ -195,15 +195,15 @@ const TPattern to_pattern(const std::string& buffer)
 {
   TPattern result;
 
-  const auto l = vu::split_string_A(buffer, " ");
-  for (const auto& e : l)
+  for (const auto& e : TokenizerA(buffer, " ", split_type::ST_CHAR))
   {
     auto v = TPattern::value_type(false, 0x00);
 
     if (e.length() == 2 && isxdigit(e[0]) && isxdigit(e[1]))
     {
+      const char hex[] = { e[0], e[1], '\0' };
       v.first  = true;
-      v.second = (byte)strtoul(e.c_str(), nullptr, 16);
+      v.second = (byte)strtoul(hex, nullptr, 16);
     }
 
     result.emplace_back(v);
@@ -29,10 +29,13 @@ typedef struct _IMAGE_BASE_RELOCATION_ENTRY
 
 template<typename T>
 PEFileTX<T>::PEFileTX()
+  : m_ptr_module_names(std::make_shared<StringPoolA>(true))
+  , m_ptr_function_names(std::make_shared<StringPoolA>(false))
 {
   m_initialized = false;
 
   m_ptr_base = nullptr;
+  m_size = 0;
   m_ptr_dos_header = nullptr;
   m_ptr_pe_header  = nullptr;
   m_section_headers.clear();
@@ -102,6 +105,36 @@ const std::vector<PSectionHeader>& vuapi PEFileTX<T>::get_setion_headers(bool in
   return m_section_headers;
 }
 
+template<typename T>
+const std::vector<double> vuapi PEFileTX<T>::get_section_entropies(bool in_cache)
+{
+  std::vector<double> result;
+
+  const auto& section_headers = this->get_setion_headers(in_cache);
+
+  for (const auto& e : section_headers)
+  {
+    // the raw data of the section, clipped to the file
+
+    uint64 offset = e->PointerToRawData;
+    uint64 size = e->SizeOfRawData;
+
+    if (offset >= m_size)
+    {
+      size = 0;
+    }
+    else if (size > m_size - offset)
+    {
+      size = m_size - offset;
+    }
+
+    const auto ptr = static_cast<const byte*>(m_ptr_base) + offset;
+    result.push_back(size == 0 ? 0. : shannon_entropy(ptr, size_t(size)));
+  }
+
+  return result;
+}
+
 // IMAGE_REL_BASED_<X>
 // static const char* relocation_entry_types[] =
 // {
@@ -201,6 +234,7 @@ const std::vector<ImportDescriptorEx>& vuapi PEFileTX<T>::get_ex_iids(bool in_ca
     ImportDescriptorEx ex_iid;
     ex_iid.iid_id = i;
     ex_iid.name = (char*)((ulong64)m_ptr_base + this->rva_to_offset(ptr_iid->Name));;
+    ex_iid.name_handle = m_ptr_module_names->intern(ex_iid.name);
     ex_iid.ptr_iid = ptr_iid;
 
     m_ex_iids.push_back(std::move(ex_iid));
@@ -256,6 +290,7 @@ const std::vector<ImportModule> vuapi PEFileTX<T>::get_import_modules(bool in_ca
     ImportModule mi;
     mi.iid_id = e.iid_id;
     mi.name = e.name;
+    mi.name_handle = e.name_handle;
     // mi.number_of_functions = 0;
 
     m_import_modules.push_back(std::move(mi));
@@ -296,6 +331,7 @@ const std::vector<ImportFunctionT<T>> vuapi PEFileTX<T>::get_import_functions(bo
       if ((ptr_thunk_data->u1.AddressOfData & m_ordinal_flag) == m_ordinal_flag) // imported by ordinal
       {
         funcInfo.name = "";
+        funcInfo.name_handle = 0;
         funcInfo.hint = -1;
         funcInfo.ordinal = ptr_thunk_data->u1.AddressOfData & ~m_ordinal_flag;
       }
@@ -308,6 +344,7 @@ const std::vector<ImportFunctionT<T>> vuapi PEFileTX<T>::get_import_functions(bo
           funcInfo.hint = p->Hint;
           funcInfo.ordinal = T(-1);
           funcInfo.name = (char*)p->Name;
+          funcInfo.name_handle = m_ptr_function_names->intern(funcInfo.name);
         }
       }
 
@@ -334,14 +371,19 @@ const ImportModule* vuapi PEFileTX<T>::find_ptr_import_module(
 
   this->get_import_modules(in_cache);
 
-  const ImportModule* result = nullptr;
+  // a name that is not in the pool is not the name of any module
 
-  auto s1 = upper_string_A(module_name);
+  const auto name_handle = m_ptr_module_names->find(module_name);
+  if (name_handle == StringPoolA::INVALID_HANDLE)
+  {
+    return nullptr;
+  }
+
+  const ImportModule* result = nullptr;
 
   for (const auto& e: m_import_modules)
   {
-    auto s2 = upper_string_A(e.name);
-    if (s1 == s2)
+    if (e.name_handle == name_handle)
     {
       result = &e;
       break;
@@ -381,15 +423,23 @@ const ImportFunctionT<T>* vuapi PEFileTX<T>::find_ptr_import_function(
     break;
 
   case find_by::NAME:
+  {
+    const auto name_handle = m_ptr_function_names->find(import_function.name);
+    if (name_handle == StringPoolA::INVALID_HANDLE)
+    {
+      break;
+    }
+
     for (const auto& e: m_import_functions)
     {
-      if (e.name == import_function.name)
+      if (e.name_handle == name_handle)
       {
         result = &e;
         break;
       }
     }
-    break;
+  }
+  break;
 
   default:
     break;
@@ -405,7 +455,7 @@ const ImportFunctionT<T>* vuapi PEFileTX<T>::find_ptr_import_function(
 {
   ImportFunctionT<T> o = {0};
   o.name = function_name;
-  return this->find_ptr_import_function(o, find_by::NAME);
+  return this->find_ptr_import_function(o, find_by::NAME, in_cache);
 }
 
 template<typename T>
@@ -556,6 +606,12 @@ VUResult vuapi PEFileTA<T>::parse()
     return 4;
   }
 
+  PEFileTX<T>::m_size = m_file_map.get_file_size_ex();
+  if (PEFileTX<T>::m_size == uint64(-1))
+  {
+    return 9; // The file size is needed to bound the sections
+  }
+
   PEFileTX<T>::m_ptr_dos_header = (PDOSHeader)PEFileTX<T>::m_ptr_base;
   if (PEFileTX<T>::m_ptr_dos_header == nullptr)
   {
@@ -646,6 +702,12 @@ VUResult vuapi PEFileTW<T>::parse()
     return 4;
   }
 
+  PEFileTX<T>::m_size = m_file_map.get_file_size_ex();
+  if (PEFileTX<T>::m_size == uint64(-1))
+  {
+    return 9; // The file size is needed to bound the sections
+  }
+
   PEFileTX<T>::m_ptr_dos_header = (PDOSHeader)PEFileTX<T>::m_ptr_base;
   if (PEFileTX<T>::m_ptr_dos_header == nullptr)
   {
@@ -340,15 +340,11 @@ std::vector<ulong> vuapi name_to_pid_A(const std::string& name)
 
   vu::ulong n_processes = cb_needed / sizeof(ulong);
 
-  std::string s1 = lower_string_A(name), s2;
-
   for (vu::ulong i = 0; i < n_processes; i++)
   {
     ulong pid = ptr_processes.get()[i];
 
-    s2.clear();
-    s2 = lower_string_A(vu::pid_to_name_A(pid));
-    if (s1 == s2)
+    if (compare_string_view_A(name, vu::pid_to_name_A(pid), true))
     {
       l.push_back(pid);
     }
@@ -387,15 +383,11 @@ std::vector<ulong> vuapi name_to_pid_W(const std::wstring& name)
 
   vu::ulong n_processes = cb_needed / sizeof(ulong);
 
-  std::wstring s1 = lower_string_W(name), s2;
-
   for (vu::ulong i = 0; i < n_processes; i++)
   {
     ulong pid = ptr_processes.get()[i];
 
-    s2.clear();
-    s2 = lower_string_W(vu::pid_to_name_W(pid));
-    if (s1 == s2)
+    if (compare_string_view_W(name, vu::pid_to_name_W(pid), true))
     {
       l.push_back(pid);
     }
@@ -521,17 +513,13 @@ HMODULE vuapi Remote64GetModuleHandleA(const ulong pid, const std::string& modul
     return result;
   }
 
-  auto target_name = lower_string_A(module_name);
-  target_name = trim_string_A(target_name);
-
-  std::string it_name = "";
+  const auto target_name = trim_string_view_A(module_name);
 
   char ps_module_name[MAX_PATH] = {0};
   for (ulong i = 0; i < n_modules; i++)
   {
     pfnGetModuleBaseNameA(hp, hmodules[i], ps_module_name, sizeof(module_name));
-    it_name = lower_string_A(ps_module_name);
-    if (it_name == target_name)
+    if (compare_string_view_A(ps_module_name, target_name, true))
     {
       result = hmodules[i];
       break;
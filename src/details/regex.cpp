@@ -0,0 +1,315 @@
+/**
+ * @file   regex.cpp
+ * @author Vic P.
+ * @brief  Implementation for Regular Expression
+ */
+
+#include "Vutils.h"
+
+#include <map>
+#include <list>
+
+namespace vu
+{
+
+/**
+ * RegexCacheT
+ * The bounded LRU cache of the compiled regular expressions that is keyed by (pattern, syntax).
+ * The compilation is done outside of the lock, so a slow pattern does not block the other threads.
+ */
+
+template <typename char_t>
+class RegexCacheT
+{
+public:
+  typedef std::basic_string<char_t> std_string_t;
+  typedef std::basic_regex<char_t> std_regex_t;
+  typedef std::shared_ptr<const std_regex_t> ptr_regex_t;
+  typedef std::pair<std_string_t, int> key_t;
+  typedef std::list<std::pair<key_t, ptr_regex_t>> list_t;
+
+  static const size_t DEFAULT_CAPACITY = 64;
+
+  RegexCacheT() : m_capacity(DEFAULT_CAPACITY) {}
+
+  ptr_regex_t get(const std_string_t& pattern, const std::regex_constants::syntax_option_type syntax)
+  {
+    const key_t key(pattern, int(syntax));
+
+    {
+      std::lock_guard<std::mutex> lg(m_mutex);
+
+      auto it = m_map.find(key);
+      if (it != m_map.end())
+      {
+        m_statistics.hits++;
+        m_list.splice(m_list.begin(), m_list, it->second);
+        return it->second->second;
+      }
+
+      m_statistics.misses++;
+    }
+
+    ptr_regex_t ptr_regex(new std_regex_t(pattern, syntax));
+
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    auto it = m_map.find(key);
+    if (it != m_map.end()) // compiled by another thread meanwhile
+    {
+      m_list.splice(m_list.begin(), m_list, it->second);
+      return it->second->second;
+    }
+
+    m_list.push_front(std::make_pair(key, ptr_regex));
+    m_map[key] = m_list.begin();
+
+    this->evict();
+
+    return ptr_regex;
+  }
+
+  void set_capacity(const size_t capacity)
+  {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    m_capacity = capacity;
+    this->evict();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    m_map.clear();
+    m_list.clear();
+    m_statistics = RegexCacheStatistics();
+  }
+
+  RegexCacheStatistics get_statistics()
+  {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    auto result = m_statistics;
+    result.size = m_list.size();
+    result.capacity = m_capacity;
+    return result;
+  }
+
+private:
+  void evict()
+  {
+    while (m_list.size() > m_capacity)
+    {
+      m_map.erase(m_list.back().first);
+      m_list.pop_back();
+    }
+  }
+
+private:
+  std::mutex m_mutex;
+  size_t m_capacity;
+  list_t m_list;
+  std::map<key_t, typename list_t::iterator> m_map;
+  RegexCacheStatistics m_statistics;
+};
+
+// the function-local statics, so the caches are ready for the regexes of the other static objects
+
+template <typename char_t>
+static RegexCacheT<char_t>& get_regex_cache();
+
+template <>
+RegexCacheT<char>& get_regex_cache<char>()
+{
+  static RegexCacheT<char> cache;
+  return cache;
+}
+
+template <>
+RegexCacheT<wchar>& get_regex_cache<wchar>()
+{
+  static RegexCacheT<wchar> cache;
+  return cache;
+}
+
+/**
+ * RegexT
+ */
+
+template <typename char_t>
+RegexT<char_t>::RegexT()
+{
+}
+
+template <typename char_t>
+RegexT<char_t>::RegexT(const std_string_t& pattern, const syntax_t syntax) : m_pattern(pattern)
+{
+  m_ptr_regex = get_regex_cache<char_t>().get(pattern, syntax);
+}
+
+template <typename char_t>
+RegexT<char_t>::RegexT(const char_t* pattern, const syntax_t syntax) : m_pattern(pattern)
+{
+  m_ptr_regex = get_regex_cache<char_t>().get(m_pattern, syntax);
+}
+
+template <typename char_t>
+RegexT<char_t>::RegexT(const RegexT& right)
+{
+  *this = right;
+}
+
+template <typename char_t>
+RegexT<char_t>::~RegexT()
+{
+}
+
+template <typename char_t>
+const RegexT<char_t>& RegexT<char_t>::operator=(const RegexT& right)
+{
+  m_pattern = right.m_pattern;
+  m_ptr_regex = right.m_ptr_regex;
+  return *this;
+}
+
+template <typename char_t>
+RegexT<char_t>::operator const std_regex_t&() const
+{
+  return this->get();
+}
+
+template <typename char_t>
+bool RegexT<char_t>::valid() const
+{
+  return m_ptr_regex != nullptr;
+}
+
+template <typename char_t>
+const typename RegexT<char_t>::std_string_t& RegexT<char_t>::pattern() const
+{
+  return m_pattern;
+}
+
+template <typename char_t>
+const typename RegexT<char_t>::std_regex_t& RegexT<char_t>::get() const
+{
+  assert(this->valid());
+  return *m_ptr_regex;
+}
+
+template <typename char_t>
+bool RegexT<char_t>::match(const std_string_t& text, const flags_t flags) const
+{
+  return this->valid() && std::regex_match(text, *m_ptr_regex, flags);
+}
+
+template <typename char_t>
+bool RegexT<char_t>::search(const std_string_t& text, const flags_t flags) const
+{
+  return this->valid() && std::regex_search(text, *m_ptr_regex, flags);
+}
+
+template <typename char_t>
+size_t RegexT<char_t>::search_all(
+  const std_string_t& text, std::vector<match_t>& matches, const flags_t flags) const
+{
+  matches.clear();
+
+  if (!this->valid())
+  {
+    return 0;
+  }
+
+  typedef std::regex_iterator<typename std_string_t::const_iterator> iterator_t;
+
+  for (iterator_t it(text.cbegin(), text.cend(), *m_ptr_regex, flags), end; it != end; ++it)
+  {
+    matches.push_back(*it);
+  }
+
+  return matches.size();
+}
+
+template <typename char_t>
+typename RegexT<char_t>::std_string_t RegexT<char_t>::replace(
+  const std_string_t& text, const std_string_t& replacement, const flags_t flags) const
+{
+  return this->valid() ? std::regex_replace(text, *m_ptr_regex, replacement, flags) : text;
+}
+
+template <typename char_t>
+void RegexT<char_t>::set_cache_capacity(const size_t capacity)
+{
+  get_regex_cache<char_t>().set_capacity(capacity);
+}
+
+template <typename char_t>
+void RegexT<char_t>::clear_cache()
+{
+  get_regex_cache<char_t>().clear();
+}
+
+template <typename char_t>
+RegexCacheStatistics RegexT<char_t>::get_cache_statistics()
+{
+  return get_regex_cache<char_t>().get_statistics();
+}
+
+template class RegexT<char>;
+template class RegexT<wchar>;
+
+/**
+ * Regular Expression Working
+ */
+
+std::string vuapi regex_replace_string_A(
+  const std::string& text,
+  const std::string& pattern,
+  const std::string& replacement,
+  std::regex_constants::match_flag_type flags)
+{
+  return regex_replace_string_A(text, RegexA(pattern).get(), replacement, flags);
+}
+
+std::wstring vuapi regex_replace_string_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  const std::wstring& replacement,
+  std::regex_constants::match_flag_type flags)
+{
+  return regex_replace_string_W(text, RegexW(pattern).get(), replacement, flags);
+}
+
+bool vuapi regex_match_string_A(
+  const std::string& text,
+  const std::string& pattern,
+  std::regex_constants::syntax_option_type syntax)
+{
+  return RegexA(pattern, syntax).match(text);
+}
+
+bool vuapi regex_match_string_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  std::regex_constants::syntax_option_type syntax)
+{
+  return RegexW(pattern, syntax).match(text);
+}
+
+size_t vuapi regex_search_all_A(
+  const std::string& text,
+  const std::string& pattern,
+  std::vector<std::smatch>& matches,
+  std::regex_constants::syntax_option_type syntax)
+{
+  return RegexA(pattern, syntax).search_all(text, matches);
+}
+
+size_t vuapi regex_search_all_W(
+  const std::wstring& text,
+  const std::wstring& pattern,
+  std::vector<std::wsmatch>& matches,
+  std::regex_constants::syntax_option_type syntax)
+{
+  return RegexW(pattern, syntax).search_all(text, matches);
+}
+
+} // namespace vu
@@ -0,0 +1,36 @@
+/**
+ * @file   strcase.h
+ * @author Vic P.
+ * @brief  Header for String Case Folding
+ */
+
+#pragma once
+
+#include "Vutils.h"
+
+#include <cwctype>
+
+namespace vu
+{
+
+/**
+ * The case folding, only the ASCII letters are folded for the ANSI strings (as the C locale)
+ * and the simple case folding of the C runtime is used for the non-ASCII wide characters.
+ */
+
+static inline char fold_case(const char c)
+{
+  return c >= 'A' && c <= 'Z' ? char(c | 0x20) : c;
+}
+
+static inline char unfold_case(const char c)
+{
+  return c >= 'a' && c <= 'z' ? char(c & ~0x20) : c;
+}
+
+static inline wchar fold_case(const wchar c)
+{
+  return c < 0x80 ? (c >= L'A' && c <= L'Z' ? wchar(c | 0x20) : c) : wchar(towlower(c));
+}
+
+} // namespace vu
@@ -8,7 +8,19 @@
 #include "lazy.h"
 
 #include <math.h>
+#include <cerrno>
+#include <climits>
 #include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#if ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || (__cplusplus >= 201703L))
+#include <charconv>
+#endif
+
+#if defined(__cpp_lib_to_chars)
+#define VU_TO_CHARS
+#endif
 
 namespace vu
 {
@@ -81,32 +93,53 @@ int vuapi get_format_length_W(const std::wstring format, ...)
   return N;
 }
 
+// The formatting is done into a stack buffer, it's only measured and formatted again
+// when the stack buffer is not enough (the argument list is copied for each pass).
+
 std::string vuapi format_vl_A(const std::string format, va_list args)
 {
   std::string s;
-  s.clear();
 
-  auto N = get_format_length_vl_A(format, args);
-  if (N <= 0)
+  if (Initialize_DLL_MISC() != VU_OK)
+  {
+    return s;
+  }
+
+  char buffer[512];
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+  #ifdef _MSC_VER
+  int n = vsnprintf(buffer, _countof(buffer), format.c_str(), args_copy);
+  #else
+  int n = pfn_vsnprintf(buffer, _countof(buffer), format.c_str(), args_copy);
+  #endif
+  va_end(args_copy);
+
+  if (n >= 0 && n < int(_countof(buffer)))
   {
+    s.assign(buffer, n);
     return s;
   }
 
-  std::unique_ptr<char[]> p(new char [N]);
-  if (p == nullptr)
+  va_copy(args_copy, args);
+  auto N = get_format_length_vl_A(format, args_copy);
+  va_end(args_copy);
+
+  if (N <= 1)
   {
     return s;
   }
 
-  ZeroMemory(p.get(), N);
+  s.resize(N);
 
   #ifdef _MSC_VER
-  vsnprintf(p.get(), N, format.c_str(), args);
+  vsnprintf(&s[0], N, format.c_str(), args);
   #else
-  pfn_vsnprintf(p.get(), N, format.c_str(), args);
+  pfn_vsnprintf(&s[0], N, format.c_str(), args);
   #endif
 
-  s.assign(p.get());
+  s.resize(N - 1);
 
   return s;
 }
@@ -114,29 +147,47 @@ std::string vuapi format_vl_A(const std::string format, va_list args)
 std::wstring vuapi format_vl_W(const std::wstring format, va_list args)
 {
   std::wstring s;
-  s.clear();
 
-  auto N = get_format_length_vl_W(format, args);
-  if (N <= 0)
+  if (Initialize_DLL_MISC() != VU_OK)
+  {
+    return s;
+  }
+
+  wchar buffer[512];
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+  #ifdef _MSC_VER
+  int n = _vsnwprintf(buffer, _countof(buffer), format.c_str(), args_copy);
+  #else
+  int n = pfn_vswprintf(buffer, _countof(buffer), format.c_str(), args_copy);
+  #endif
+  va_end(args_copy);
+
+  if (n >= 0 && n < int(_countof(buffer)))
   {
+    s.assign(buffer, n);
     return s;
   }
 
-  std::unique_ptr<wchar[]> p(new wchar [N]);
-  if (p == nullptr)
+  va_copy(args_copy, args);
+  auto N = get_format_length_vl_W(format, args_copy);
+  va_end(args_copy);
+
+  if (N <= 1)
   {
     return s;
   }
 
-  ZeroMemory(p.get(), 2*N);
+  s.resize(N);
 
   #ifdef _MSC_VER
-  vswprintf(p.get(), format.c_str(), args);
+  _vsnwprintf(&s[0], N, format.c_str(), args);
   #else
-  pfn_vswprintf(p.get(), N, format.c_str(), args);
+  pfn_vswprintf(&s[0], N, format.c_str(), args);
   #endif
 
-  s.assign(p.get());
+  s.resize(N - 1);
 
   return s;
 }
@@ -165,6 +216,463 @@ std::wstring vuapi format_W(const std::wstring format, ...)
   return s;
 }
 
+/**
+ * Type-Safe String Format
+ */
+
+struct FormatSpec
+{
+  bool   zero;
+  size_t width;
+  int    precision;
+  char   type;
+
+  FormatSpec() : zero(false), width(0), precision(-1), type(0) {}
+};
+
+static const char FORMAT_DIGITS[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// Writes an unsigned integer backward from the end of the buffer, returns the first character
+
+static char* format_unsigned(char* last, unsigned long long v, const unsigned base, const bool upper)
+{
+  const char* digits = upper ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+
+  if (base == 10)
+  {
+    while (v >= 100)
+    {
+      const auto i = size_t(v % 100) * 2;
+      v /= 100;
+      *--last = FORMAT_DIGITS[i + 1];
+      *--last = FORMAT_DIGITS[i];
+    }
+
+    if (v >= 10)
+    {
+      const auto i = size_t(v) * 2;
+      *--last = FORMAT_DIGITS[i + 1];
+      *--last = FORMAT_DIGITS[i];
+    }
+    else
+    {
+      *--last = char('0' + v);
+    }
+
+    return last;
+  }
+
+  do
+  {
+    *--last = digits[v % base];
+    v /= base;
+  } while (v != 0);
+
+  return last;
+}
+
+// Writes a floating-point number, returns the number of the written characters
+
+static size_t format_double(char* ptr, const size_t size, const double v, const char type, int precision)
+{
+  if (precision > 100)
+  {
+    precision = 100;
+  }
+
+  #ifdef VU_TO_CHARS
+  std::to_chars_result result;
+  switch (type)
+  {
+  case 'f':
+    result = std::to_chars(ptr, ptr + size, v, std::chars_format::fixed, precision < 0 ? 6 : precision);
+    break;
+  case 'e':
+    result = std::to_chars(ptr, ptr + size, v, std::chars_format::scientific, precision < 0 ? 6 : precision);
+    break;
+  case 'g':
+    result = std::to_chars(ptr, ptr + size, v, std::chars_format::general, precision < 0 ? 6 : precision);
+    break;
+  default:
+    result = precision < 0
+      ? std::to_chars(ptr, ptr + size, v)
+      : std::to_chars(ptr, ptr + size, v, std::chars_format::general, precision);
+    break;
+  }
+  return result.ec == std::errc() ? size_t(result.ptr - ptr) : 0;
+  #else // VU_TO_CHARS
+  int n = 0;
+  switch (type)
+  {
+  case 'f':
+  case 'e':
+  case 'g':
+    {
+      const char fmt[] = { '%', '.', '*', type, '\0' };
+      n = _snprintf(ptr, size, fmt, precision < 0 ? 6 : precision, v);
+    }
+    break;
+  default:
+    if (precision < 0) // the shortest representation that is read back to the same value
+    {
+      for (precision = 15; precision <= 17; precision++)
+      {
+        n = _snprintf(ptr, size, "%.*g", precision, v);
+        if (n <= 0 || size_t(n) >= size || strtod(ptr, nullptr) == v)
+        {
+          break;
+        }
+      }
+    }
+    else
+    {
+      n = _snprintf(ptr, size, "%.*g", precision, v);
+    }
+    break;
+  }
+  return n > 0 && size_t(n) < size ? size_t(n) : 0;
+  #endif // VU_TO_CHARS
+}
+
+template <typename char_t>
+static void format_padded(
+  FormatBufferT<char_t>& buffer, const char* ptr, size_t size, const FormatSpec& spec, const bool numeric)
+{
+  const auto padding = spec.width > size ? spec.width - size : 0;
+
+  if (numeric && spec.zero && padding != 0)
+  {
+    if (size != 0 && (ptr[0] == '-' || ptr[0] == '+'))
+    {
+      buffer.append(char_t(ptr[0]));
+      ptr++;
+      size--;
+    }
+
+    buffer.append(char_t('0'), padding);
+  }
+  else if (numeric && padding != 0)
+  {
+    buffer.append(char_t(' '), padding);
+  }
+
+  for (size_t i = 0; i < size; i++)
+  {
+    buffer.append(char_t(ptr[i]));
+  }
+
+  if (!numeric && padding != 0)
+  {
+    buffer.append(char_t(' '), padding);
+  }
+}
+
+template <typename char_t>
+static bool format_arg(FormatBufferT<char_t>& buffer, const FormatArgT<char_t>& arg, const FormatSpec& spec)
+{
+  typedef FormatArgT<char_t> arg_t;
+
+  char scratch[512];
+  char* const last = scratch + sizeof(scratch);
+
+  unsigned long long u = 0;
+  bool negative = false;
+
+  switch (arg.type)
+  {
+  case arg_t::FA_STRING:
+    {
+      if (spec.type != 0 && spec.type != 's')
+      {
+        return false;
+      }
+
+      auto size = arg.s.size;
+      if (spec.precision >= 0 && size_t(spec.precision) < size)
+      {
+        size = size_t(spec.precision);
+      }
+
+      buffer.append(arg.s.ptr, size);
+
+      if (spec.width > size)
+      {
+        buffer.append(char_t(' '), spec.width - size);
+      }
+    }
+    return true;
+
+  case arg_t::FA_CHAR:
+    if (spec.type == 0 || spec.type == 'c')
+    {
+      buffer.append(arg.c);
+      if (spec.width > 1)
+      {
+        buffer.append(char_t(' '), spec.width - 1);
+      }
+      return true;
+    }
+    u = static_cast<typename std::make_unsigned<char_t>::type>(arg.c);
+    break;
+
+  case arg_t::FA_BOOL:
+    if (spec.type == 0 || spec.type == 's')
+    {
+      const char* s = arg.b ? "true" : "false";
+      format_padded(buffer, s, strlen(s), spec, false);
+      return true;
+    }
+    u = arg.b ? 1 : 0;
+    break;
+
+  case arg_t::FA_INT:
+    negative = arg.i < 0;
+    u = negative ? 0ULL - static_cast<unsigned long long>(arg.i) : static_cast<unsigned long long>(arg.i);
+    break;
+
+  case arg_t::FA_UINT:
+    u = arg.u;
+    break;
+
+  case arg_t::FA_DOUBLE:
+    {
+      if (spec.type != 0 && spec.type != 'f' && spec.type != 'e' && spec.type != 'g')
+      {
+        return false;
+      }
+
+      const auto n = format_double(scratch, sizeof(scratch), arg.d, spec.type, spec.precision);
+      format_padded(buffer, scratch, n, spec, true);
+    }
+    return true;
+
+  case arg_t::FA_POINTER:
+    {
+      if (spec.type != 0 && spec.type != 'p')
+      {
+        return false;
+      }
+
+      auto first = format_unsigned(last, static_cast<unsigned long long>(reinterpret_cast<size_t>(arg.p)), 16, true);
+      while (last - first < ptrdiff_t(2 * sizeof(void*)))
+      {
+        *--first = '0';
+      }
+
+      *--first = 'x';
+      *--first = '0';
+
+      format_padded(buffer, first, size_t(last - first), spec, true);
+    }
+    return true;
+
+  default:
+    return false;
+  }
+
+  // the integers
+
+  unsigned base = 10;
+
+  switch (spec.type)
+  {
+  case 0:
+  case 'd':
+    break;
+  case 'x':
+  case 'X':
+    base = 16;
+    break;
+  case 'o':
+    base = 8;
+    break;
+  case 'b':
+    base = 2;
+    break;
+  default:
+    return false;
+  }
+
+  char* first = nullptr;
+
+  #ifdef VU_TO_CHARS
+  const auto result = std::to_chars(scratch + 1, last, u, int(base));
+  first = std::copy_backward(scratch + 1, result.ptr, last);
+  if (spec.type == 'X')
+  {
+    std::transform(first, last, first, [](const char c) -> char { return c >= 'a' ? char(c - 'a' + 'A') : c; });
+  }
+  #else  // VU_TO_CHARS
+  first = format_unsigned(last, u, base, spec.type == 'X');
+  #endif // VU_TO_CHARS
+
+  if (negative)
+  {
+    *--first = '-';
+  }
+
+  format_padded(buffer, first, size_t(last - first), spec, true);
+
+  return true;
+}
+
+template <typename char_t>
+static bool format_field(
+  FormatBufferT<char_t>& buffer,
+  const char_t* first,
+  const char_t* last,
+  const FormatArgT<char_t>* args,
+  const size_t count,
+  size_t& next_index)
+{
+  const auto is_digit = [](const char_t c) -> bool { return c >= '0' && c <= '9'; };
+
+  const auto parse_number = [&](size_t& v) -> bool
+  {
+    if (first == last || !is_digit(*first))
+    {
+      return false;
+    }
+
+    for (v = 0; first != last && is_digit(*first) && v < 100000; first++)
+    {
+      v = v * 10 + size_t(*first - '0');
+    }
+
+    return true;
+  };
+
+  size_t index = 0;
+  if (!parse_number(index))
+  {
+    index = next_index;
+  }
+
+  next_index = index + 1;
+
+  FormatSpec spec;
+
+  if (first != last && *first == ':')
+  {
+    first++;
+
+    if (first != last && *first == '0')
+    {
+      spec.zero = true;
+      first++;
+    }
+
+    parse_number(spec.width);
+
+    if (first != last && *first == '.')
+    {
+      first++;
+
+      size_t precision = 0;
+      if (!parse_number(precision))
+      {
+        return false;
+      }
+
+      spec.precision = int(precision);
+    }
+
+    if (first != last)
+    {
+      if (unsigned(*first) >= 0x80) // not a type, eg. U+0178 would be narrowed to 'x'
+      {
+        return false;
+      }
+
+      spec.type = char(*first++);
+    }
+  }
+
+  if (first != last || index >= count)
+  {
+    return false;
+  }
+
+  return format_arg(buffer, args[index], spec);
+}
+
+template <typename char_t>
+static void format_args_T(
+  FormatBufferT<char_t>& buffer,
+  const StringViewT<char_t>& format,
+  const FormatArgT<char_t>* args,
+  const size_t count)
+{
+  const char_t* p = format.data();
+  const char_t* const end = p + format.size();
+
+  size_t next_index = 0;
+
+  while (p != end)
+  {
+    const char_t* q = p;
+    while (q != end && *q != '{' && *q != '}')
+    {
+      q++;
+    }
+
+    buffer.append(p, size_t(q - p));
+    p = q;
+
+    if (p == end)
+    {
+      break;
+    }
+
+    if (p + 1 != end && p[1] == *p) // the escaped braces
+    {
+      buffer.append(*p);
+      p += 2;
+      continue;
+    }
+
+    if (*p == '}')
+    {
+      buffer.append(*p++);
+      continue;
+    }
+
+    const char_t* close = p + 1;
+    while (close != end && *close != '}')
+    {
+      close++;
+    }
+
+    if (close == end)
+    {
+      buffer.append(p, size_t(end - p));
+      break;
+    }
+
+    if (!format_field(buffer, p + 1, close, args, count, next_index))
+    {
+      buffer.append(p, size_t(close + 1 - p));
+    }
+
+    p = close + 1;
+  }
+}
+
+void vuapi format_args_A(
+  FormatBufferT<char>& buffer, const StringViewA& format, const FormatArgT<char>* args, const size_t count)
+{
+  format_args_T(buffer, format, args, count);
+}
+
+void vuapi format_args_W(
+  FormatBufferT<wchar>& buffer, const StringViewW& format, const FormatArgT<wchar>* args, const size_t count)
+{
+  format_args_T(buffer, format, args, count);
+}
+
 void vuapi msg_debug_A(const std::string format, ...)
 {
   va_list args;
@@ -317,363 +825,1372 @@ std::wstring vuapi get_last_error_W(ulong code)
   // return s;
 }
 
-std::string vuapi get_format_string_for_number(std::string type_id)
-{
-  /* MinGW
-    i -> int
-    l -> long
-    x -> long long
-    j -> unsigned
-    m -> unsigned long
-    y -> unsigned long long
-    f -> float
-    d -> double
-    e -> long double
-  */
-
-  std::string fs = "";
-
-  if (type_id == "i")
-  {
-    fs = "%d";
-  }
-  else if (type_id == "l")
-  {
-    fs = "%ld";
-  }
-  else if (type_id == "x")
-  {
-    fs = "lld";
-  }
-  else if (type_id == "j")
-  {
-    fs = "%u";
-  }
-  else if (type_id == "m")
-  {
-    fs = "%lu";
-  }
-  else if (type_id == "y")
-  {
-    fs = "%llu";
-  }
-  else if (type_id == "f")
-  {
-    fs = "%f";
-  }
-  else if (type_id == "d")
-  {
-    fs = "%e";
-  }
-  else if (type_id == "e")
-  {
-    fs = "%Le";
-  }
-  else
-  {
-    fs = "";
-  }
-
-  return fs;
-}
-
 std::string vuapi date_time_to_string_A(const time_t t)
 {
-  std::string s = format_date_time_A(t, "%H:%M:%S %d/%m/%Y");
-  return s;
+  return DateTimeFormatterA("%H:%M:%S %d/%m/%Y").format(t);
 }
 
 std::wstring vuapi date_time_to_string_W(const time_t t)
 {
-  std::wstring s = format_date_time_W(t, L"%H:%M:%S %d/%m/%Y");
-  return s;
+  return DateTimeFormatterW(L"%H:%M:%S %d/%m/%Y").format(t);
+}
+
+std::string vuapi format_date_time_A(const time_t t, const std::string format)
+{
+  return DateTimeFormatterA(format).format(t);
+}
+
+std::wstring vuapi format_date_time_W(const time_t t, const std::wstring format)
+{
+  return DateTimeFormatterW(format).format(t);
+}
+
+/**
+ * DateTimeFormatterT
+ * The fields are computed from the local seconds (the UTC seconds plus the time-zone offset) by the
+ * civil calendar algorithms, so localtime is only called once per hour. An hour that has a change of
+ * the offset (the transitions are not always on the hour, eg. Lord Howe) is not cached.
+ */
+
+static const char* const DATE_TIME_WEEKDAY_NAMES[] =
+{
+  "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+};
+
+static const char* const DATE_TIME_MONTH_NAMES[] =
+{
+  "January", "February", "March", "April", "May", "June",
+  "July", "August", "September", "October", "November", "December",
+};
+
+static inline long long floor_div(const long long v, const long long d)
+{
+  const auto q = v / d;
+  return q * d > v ? q - 1 : q;
+}
+
+// The days since 1970-01-01 of a date in the proleptic Gregorian calendar (by Howard Hinnant)
+
+static long long days_from_civil(long long y, const unsigned m, const unsigned d)
+{
+  y -= m <= 2 ? 1 : 0;
+  const long long era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = unsigned(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (long long)(doe) - 719468;
+}
+
+static void civil_from_days(long long z, long long& y, unsigned& m, unsigned& d)
+{
+  z += 719468;
+  const long long era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = unsigned(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = (long long)(yoe) + era * 400 + (m <= 2 ? 1 : 0);
+}
+
+static bool date_time_to_tm(const time_t t, const bool utc, tm& result)
+{
+  #if defined(_MSC_VER) && (_MSC_VER > 1200) // Above VC++ 6.0
+  return (utc ? gmtime_s(&result, &t) : localtime_s(&result, &t)) == 0;
+  #else
+  const auto ptr = utc ? gmtime(&t) : localtime(&t);
+  if (ptr != nullptr)
+  {
+    memcpy((void*)&result, ptr, sizeof(tm));
+  }
+  return ptr != nullptr;
+  #endif
+}
+
+static inline size_t date_time_strftime(char* ptr, const size_t size, const char* format, const tm* t)
+{
+  return strftime(ptr, size, format, t);
+}
+
+static inline size_t date_time_strftime(wchar* ptr, const size_t size, const wchar* format, const tm* t)
+{
+  return wcsftime(ptr, size, format, t);
+}
+
+template <typename std_string_t>
+static inline void date_time_append_ascii(std_string_t& s, const char* ptr)
+{
+  for (; *ptr != '\0'; ptr++)
+  {
+    s.push_back(typename std_string_t::value_type(*ptr));
+  }
+}
+
+template <typename char_t>
+static inline void date_time_write_2(char_t* ptr, const unsigned v)
+{
+  ptr[0] = char_t(FORMAT_DIGITS[2 * v]);
+  ptr[1] = char_t(FORMAT_DIGITS[2 * v + 1]);
+}
+
+template <typename std_string_t>
+static inline void date_time_append_2(std_string_t& s, const unsigned v)
+{
+  s.push_back(typename std_string_t::value_type(FORMAT_DIGITS[2 * v]));
+  s.push_back(typename std_string_t::value_type(FORMAT_DIGITS[2 * v + 1]));
+}
+
+template <typename char_t>
+DateTimeFormatterT<char_t>::DateTimeFormatterT(const std_string_t& format, const bool utc)
+  : m_utc(utc)
+  , m_second((std::numeric_limits<time_t>::min)())
+  , m_hour((std::numeric_limits<time_t>::min)())
+  , m_offset(0)
+{
+  this->parse(format);
+}
+
+template <typename char_t>
+DateTimeFormatterT<char_t>::~DateTimeFormatterT()
+{
+}
+
+template <typename char_t>
+void DateTimeFormatterT<char_t>::parse(const std_string_t& format)
+{
+  auto add_token = [&](const token_type type, const char_t* ptr, const size_t size) -> void
+  {
+    if (type == TT_TEXT && !m_tokens.empty() && m_tokens.back().type == TT_TEXT)
+    {
+      m_tokens.back().size += size; // the texts are contiguous in m_text
+    }
+    else
+    {
+      const Token token = { type, m_text.size(), size };
+      m_tokens.push_back(token);
+    }
+
+    m_text.append(ptr, size);
+  };
+
+  auto add_format = [&](const char* format) -> void
+  {
+    const std_string_t s(format, format + strlen(format));
+    this->parse(s);
+  };
+
+  for (size_t i = 0; i < format.size(); i++)
+  {
+    if (format[i] != '%' || i + 1 == format.size())
+    {
+      add_token(TT_TEXT, &format[i], 1);
+      continue;
+    }
+
+    const auto spec = format[++i];
+    const auto field = &format[i - 1];
+
+    switch (spec)
+    {
+    case 'Y': add_token(TT_YEAR, field, 0); break;
+    case 'y': add_token(TT_YEAR_2, field, 0); break;
+    case 'm': add_token(TT_MONTH, field, 0); break;
+    case 'd': add_token(TT_DAY, field, 0); break;
+    case 'j': add_token(TT_DAY_OF_YEAR, field, 0); break;
+    case 'H': add_token(TT_HOUR, field, 0); break;
+    case 'I': add_token(TT_HOUR_12, field, 0); break;
+    case 'M': add_token(TT_MINUTE, field, 0); break;
+    case 'S': add_token(TT_SECOND, field, 0); break;
+    case 'p': add_token(TT_AM_PM, field, 0); break;
+    case 'A': add_token(TT_WEEKDAY_NAME, field, 0); break;
+    case 'a': add_token(TT_WEEKDAY_SHORT_NAME, field, 0); break;
+    case 'B': add_token(TT_MONTH_NAME, field, 0); break;
+    case 'b':
+    case 'h': add_token(TT_MONTH_SHORT_NAME, field, 0); break;
+    case 'z': add_token(TT_ZONE_OFFSET, field, 0); break;
+    case 'L': add_token(TT_MILLISECOND, field, 0); break;
+    case 'f': add_token(TT_MICROSECOND, field, 0); break;
+    case 'F': add_format("%Y-%m-%d"); break;
+    case 'T': add_format("%H:%M:%S"); break;
+    case 'D': add_format("%m/%d/%y"); break;
+    case 'R': add_format("%H:%M"); break;
+    case '%': add_token(TT_TEXT, &format[i], 1); break;
+    case 'n': add_format("\n"); break;
+    case 't': add_format("\t"); break;
+    case 'E': // the modifiers, eg. %Ec or %Oy
+    case 'O':
+      if (i + 1 < format.size())
+      {
+        i++;
+      }
+      add_token(TT_STRFTIME, field, size_t(&format[i] - field) + 1);
+      break;
+    default:
+      add_token(TT_STRFTIME, field, 2);
+      break;
+    }
+  }
+}
+
+template <typename char_t>
+long DateTimeFormatterT<char_t>::local_offset(const time_t t) const
+{
+  tm lt = { 0 };
+  if (m_utc || !date_time_to_tm(t, false, lt))
+  {
+    return 0;
+  }
+
+  const auto local = days_from_civil(lt.tm_year + 1900LL, unsigned(lt.tm_mon + 1), unsigned(lt.tm_mday)) * 86400 +
+    lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec;
+
+  return long(local - (long long)t);
+}
+
+template <typename char_t>
+void DateTimeFormatterT<char_t>::update_offset(const time_t t)
+{
+  const auto hour = time_t(floor_div((long long)t, 3600));
+  if (hour == m_hour)
+  {
+    return;
+  }
+
+  // the offset is cached if it's the same at the start and the end of the hour
+
+  const auto first = this->local_offset(hour * 3600);
+  const auto last  = this->local_offset(hour * 3600 + 3599);
+
+  if (first == last)
+  {
+    m_offset = first;
+    m_hour = hour;
+  }
+  else
+  {
+    m_offset = this->local_offset(t);
+    m_hour = (std::numeric_limits<time_t>::min)();
+  }
+}
+
+template <typename char_t>
+void DateTimeFormatterT<char_t>::update(const time_t t)
+{
+  this->update_offset(t);
+
+  const auto local = (long long)t + m_offset;
+  const auto days = floor_div(local, 86400);
+  const auto seconds = unsigned(local - days * 86400);
+
+  long long year = 0;
+  unsigned month = 0, day = 0;
+  civil_from_days(days, year, month, day);
+
+  const unsigned hour_24 = seconds / 3600;
+  const unsigned minute  = seconds / 60 % 60;
+  const unsigned second  = seconds % 60;
+  const unsigned weekday = unsigned((days % 7 + 11) % 7); // 1970-01-01 is Thursday
+  const unsigned yday    = unsigned(days - days_from_civil(year, 1, 1));
+
+  tm lt = { 0 };
+  bool lt_ready = false;
+
+  m_cache.clear();
+  m_patches.clear();
+
+  for (const auto& token : m_tokens)
+  {
+    switch (token.type)
+    {
+    case TT_TEXT:
+      m_cache.append(m_text, token.first, token.size);
+      break;
+
+    case TT_YEAR:
+      if (year >= 0 && year <= 9999)
+      {
+        date_time_append_2(m_cache, unsigned(year / 100));
+        date_time_append_2(m_cache, unsigned(year % 100));
+      }
+      else
+      {
+        char_t buffer[32];
+        m_cache.append(buffer, number_to_chars(buffer, 32, year));
+      }
+      break;
+
+    case TT_YEAR_2:
+      date_time_append_2(m_cache, unsigned((year % 100 + 100) % 100));
+      break;
+
+    case TT_MONTH:
+      date_time_append_2(m_cache, month);
+      break;
+
+    case TT_DAY:
+      date_time_append_2(m_cache, day);
+      break;
+
+    case TT_DAY_OF_YEAR:
+      m_cache.push_back(char_t('0' + (yday + 1) / 100));
+      date_time_append_2(m_cache, (yday + 1) % 100);
+      break;
+
+    case TT_HOUR:
+      date_time_append_2(m_cache, hour_24);
+      break;
+
+    case TT_HOUR_12:
+      date_time_append_2(m_cache, hour_24 % 12 == 0 ? 12 : hour_24 % 12);
+      break;
+
+    case TT_MINUTE:
+      date_time_append_2(m_cache, minute);
+      break;
+
+    case TT_SECOND:
+      date_time_append_2(m_cache, second);
+      break;
+
+    case TT_AM_PM:
+      date_time_append_ascii(m_cache, hour_24 < 12 ? "AM" : "PM");
+      break;
+
+    case TT_WEEKDAY_NAME:
+      date_time_append_ascii(m_cache, DATE_TIME_WEEKDAY_NAMES[weekday]);
+      break;
+
+    case TT_WEEKDAY_SHORT_NAME:
+      m_cache.append(std_string_t(DATE_TIME_WEEKDAY_NAMES[weekday], DATE_TIME_WEEKDAY_NAMES[weekday] + 3));
+      break;
+
+    case TT_MONTH_NAME:
+      date_time_append_ascii(m_cache, DATE_TIME_MONTH_NAMES[month - 1]);
+      break;
+
+    case TT_MONTH_SHORT_NAME:
+      m_cache.append(std_string_t(DATE_TIME_MONTH_NAMES[month - 1], DATE_TIME_MONTH_NAMES[month - 1] + 3));
+      break;
+
+    case TT_ZONE_OFFSET:
+      {
+        const auto offset = m_offset < 0 ? -m_offset : m_offset;
+        m_cache.push_back(char_t(m_offset < 0 ? '-' : '+'));
+        date_time_append_2(m_cache, unsigned(offset / 3600 % 100));
+        date_time_append_2(m_cache, unsigned(offset / 60 % 60));
+      }
+      break;
+
+    case TT_MILLISECOND:
+    case TT_MICROSECOND:
+      {
+        const Patch patch = { token.type, m_cache.size() };
+        m_patches.push_back(patch);
+        m_cache.append(token.type == TT_MILLISECOND ? 3 : 6, char_t('0'));
+      }
+      break;
+
+    case TT_STRFTIME:
+      {
+        if (!lt_ready)
+        {
+          lt_ready = date_time_to_tm(t, m_utc, lt);
+        }
+
+        const std_string_t field(m_text, token.first, token.size);
+
+        char_t buffer[128];
+        const auto n = lt_ready ? date_time_strftime(buffer, 128, field.c_str(), &lt) : 0;
+        m_cache.append(buffer, n);
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+template <typename char_t>
+size_t DateTimeFormatterT<char_t>::format(
+  char_t* ptr, const size_t size, const time_t t, const uint32 microseconds)
+{
+  if (t != m_second)
+  {
+    this->update(t);
+    m_second = t;
+  }
+
+  const auto n = m_cache.size();
+  if (ptr == nullptr || n + 1 > size)
+  {
+    return 0;
+  }
+
+  std::char_traits<char_t>::copy(ptr, m_cache.data(), n);
+  ptr[n] = char_t(0);
+
+  const unsigned us = (std::min)(microseconds, uint32(999999));
+
+  for (const auto& patch : m_patches)
+  {
+    auto p = ptr + patch.offset;
+
+    if (patch.type == TT_MILLISECOND)
+    {
+      const auto ms = us / 1000;
+      p[0] = char_t('0' + ms / 100);
+      date_time_write_2(p + 1, ms % 100);
+    }
+    else
+    {
+      date_time_write_2(p + 0, us / 10000);
+      date_time_write_2(p + 2, us / 100 % 100);
+      date_time_write_2(p + 4, us % 100);
+    }
+  }
+
+  return n;
+}
+
+template <typename char_t>
+size_t DateTimeFormatterT<char_t>::format(
+  char_t* ptr, const size_t size, const std::chrono::system_clock::time_point& time)
+{
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+  const auto seconds = floor_div((long long)us, 1000000);
+  return this->format(ptr, size, time_t(seconds), uint32(us - seconds * 1000000));
+}
+
+template <typename char_t>
+size_t DateTimeFormatterT<char_t>::now(char_t* ptr, const size_t size)
+{
+  return this->format(ptr, size, std::chrono::system_clock::now());
+}
+
+template <typename char_t>
+typename DateTimeFormatterT<char_t>::std_string_t DateTimeFormatterT<char_t>::format(
+  const time_t t, const uint32 microseconds)
+{
+  char_t buffer[256];
+  auto n = this->format(buffer, 256, t, microseconds);
+  if (n != 0 || m_cache.empty())
+  {
+    return std_string_t(buffer, n);
+  }
+
+  std_string_t result(m_cache.size() + 1, char_t(0));
+  n = this->format(&result[0], result.size(), t, microseconds);
+  result.resize(n);
+
+  return result;
+}
+
+template <typename char_t>
+typename DateTimeFormatterT<char_t>::std_string_t DateTimeFormatterT<char_t>::format(
+  const std::chrono::system_clock::time_point& time)
+{
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+  const auto seconds = floor_div((long long)us, 1000000);
+  return this->format(time_t(seconds), uint32(us - seconds * 1000000));
+}
+
+template <typename char_t>
+typename DateTimeFormatterT<char_t>::std_string_t DateTimeFormatterT<char_t>::now()
+{
+  return this->format(std::chrono::system_clock::now());
+}
+
+template class DateTimeFormatterT<char>;
+template class DateTimeFormatterT<wchar>;
+
+/**
+ * Hex Dump
+ * The lines are rendered from a precomputed line template into a block, then the block is
+ * written out at once. The default layout is
+ *   "  0000  00 11 22 33 44 55 66 77  88 99 AA BB CC DD EE FF  ................"
+ */
+
+class HexDumper
+{
+public:
+  HexDumper(const HexDumpOptions& options, const size_t size) : m_options(options)
+  {
+    if (m_options.width == 0)
+    {
+      m_options.width = 16;
+    }
+
+    // the addresses are in the same width, it's widened to fit the last address
+
+    const uint64 last_address = m_options.address + size - 1;
+
+    m_digits = (std::max)(size_t(1), (std::min)(m_options.address_digits, size_t(16)));
+    for (auto v = m_digits < 16 ? last_address >> (4 * m_digits) : 0; v != 0; v >>= 4)
+    {
+      m_digits++;
+    }
+
+    const size_t prefix = 2 + m_digits + 1;
+
+    m_offsets.resize(m_options.width);
+    for (size_t i = 0; i < m_options.width; i++)
+    {
+      m_offsets[i] = prefix + 3 * i + (m_options.group != 0 ? i / m_options.group : 0) + 1;
+    }
+
+    m_ascii = m_offsets.back() + 2 + 2;
+    m_line.assign(m_ascii + (m_options.ascii ? m_options.width : 0) + 1, ' ');
+    m_line.back() = '\n';
+    if (!m_options.ascii)
+    {
+      m_line.erase(m_offsets.back() + 2, m_line.size() - (m_offsets.back() + 2) - 1);
+    }
+  }
+
+  // The size of a line of n bytes (n <= width), the last line is not padded
+
+  size_t line_size(const size_t n) const
+  {
+    return m_options.ascii ? m_ascii + n + 1 : m_offsets[n - 1] + 2 + 1;
+  }
+
+  size_t total_size(const size_t size) const
+  {
+    const auto rest = size % m_options.width;
+    return size / m_options.width * m_line.size() + (rest != 0 ? this->line_size(rest) : 0);
+  }
+
+  // Renders a line of n bytes (n <= width), returns the size of the line
+
+  size_t render(char* out, const byte* ptr, const size_t n, const uint64 address) const
+  {
+    static const char LOWER[] = "0123456789abcdef";
+    static const char UPPER[] = "0123456789ABCDEF";
+
+    const auto digits = m_options.uppercase ? UPPER : LOWER;
+
+    memcpy(out, m_line.data(), m_line.size());
+
+    auto v = address;
+    for (size_t i = 0; i < m_digits; i++, v >>= 4)
+    {
+      out[2 + m_digits - 1 - i] = digits[v & 0xF];
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+      const auto p = out + m_offsets[i];
+      p[0] = digits[ptr[i] >> 4];
+      p[1] = digits[ptr[i] & 0xF];
+    }
+
+    // the last line is not padded
+
+    if (!m_options.ascii)
+    {
+      const auto end = m_offsets[n - 1] + 2;
+      out[end] = '\n';
+      return end + 1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+      out[m_ascii + i] = ptr[i] < 0x20 || ptr[i] > 0x7E ? '.' : char(ptr[i]);
+    }
+
+    out[m_ascii + n] = '\n';
+
+    return m_ascii + n + 1;
+  }
+
+  template <typename Fn>
+  void dump(const byte* ptr, const size_t size, Fn fn) const
+  {
+    const size_t lines_per_block = (std::max)(size_t(1), size_t(64 * KiB) / m_line.size());
+
+    std::vector<char> block(lines_per_block * m_line.size());
+
+    size_t offset = 0;
+
+    while (offset < size)
+    {
+      size_t block_size = 0;
+
+      for (size_t i = 0; i < lines_per_block && offset < size; i++)
+      {
+        const auto n = (std::min)(m_options.width, size - offset);
+        block_size += this->render(block.data() + block_size, ptr + offset, n, m_options.address + offset);
+        offset += n;
+      }
+
+      fn(block.data(), block_size);
+    }
+  }
+
+private:
+  HexDumpOptions m_options;
+  size_t m_digits;
+  size_t m_ascii;
+  std::vector<size_t> m_offsets;
+  std::string m_line;
+};
+
+void vuapi hex_dump(const void* ptr, const size_t size, std::string& result, const HexDumpOptions& options)
+{
+  result.clear();
+
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  HexDumper dumper(options, size);
+  result.reserve(dumper.total_size(size));
+
+  dumper.dump(static_cast<const byte*>(ptr), size, [&](const char* block, const size_t block_size) -> void
+  {
+    result.append(block, block_size);
+  });
+}
+
+void vuapi hex_dump(const void* ptr, const size_t size, Buffer& result, const HexDumpOptions& options)
+{
+  result.reset();
+
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  HexDumper dumper(options, size);
+  dumper.dump(static_cast<const byte*>(ptr), size, [&](const char* block, const size_t block_size) -> void
+  {
+    result.append(block, block_size);
+  });
+}
+
+void vuapi hex_dump(const void* ptr, const size_t size, std::ostream& stream, const HexDumpOptions& options)
+{
+  if (ptr == nullptr || size == 0)
+  {
+    return;
+  }
+
+  HexDumper dumper(options, size);
+  dumper.dump(static_cast<const byte*>(ptr), size, [&](const char* block, const size_t block_size) -> void
+  {
+    stream.write(block, std::streamsize(block_size));
+  });
+}
+
+void vuapi hex_dump(const void* data, int size)
+{
+  if (size > 0)
+  {
+    hex_dump(data, size_t(size), std::cout);
+  }
+}
+
+std::string vuapi format_bytes_A(long long bytes, data_unit_type dut, int digits)
+{
+  std::string result = "";
+
+  if (bytes < 0 || digits < 0)
+  {
+    return result;
+  }
+
+  // Max positive number of long long is 2*63 ~ 9{18}.
+  // So log(9{18}, 1000-1024) ~ 6-7 array index.
+  static const char* SIUnits[]  = { "B", "KB", "MB", "GB", "TB", "PB", "EB" };
+  static const char* IECUnits[] = { "B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB" };
+  static const auto  Units = dut == data_unit_type::IEC ? IECUnits : SIUnits;
+
+  const auto log2l = [](long double v) -> long double
+  {
+    const long double M_LOG2E = 1.44269504088896340736;
+    return logl(v) * M_LOG2E;
+  };
+
+  const auto logn = [&](long double v, long double n) -> long double
+  {
+    return log2l(v) / log2l(n);
+  };
+
+  int idx = 0;
+
+  if (bytes > 0)
+  {
+    idx = (int)logn(static_cast<long double>(bytes), static_cast<long double>(dut));
+
+    std::string fmt = "{:.";
+    fmt += std::to_string(digits);
+    fmt += "f} {}";
+
+    result = format_text_A(fmt, float(bytes / powl(static_cast<long double>(dut), idx)), Units[idx]);
+  }
+
+  return result;
+}
+
+std::wstring vuapi format_bytes_W(long long bytes, data_unit_type dut, int digits)
+{
+  return to_string_W(format_bytes_A(bytes, dut, digits));
+}
+
+std::string vuapi to_hex_string_A(const byte* ptr, const size_t size)
+{
+  std::stringstream ss;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    ss << std::hex << std::setfill('0') << std::setw(2) << int(ptr[i]);
+  }
+
+  return ss.str();
+}
+
+std::wstring vuapi to_hex_string_W(const byte* ptr, const size_t size)
+{
+  auto s = to_hex_string_A(ptr, size);
+  return to_string_W(s);
+}
+
+bool vuapi to_hex_bytes_A(const std::string& text, std::vector<byte>& bytes)
+{
+  bytes.clear();
+
+  auto s = trim_string_A(text);
+  s = replace_string_A(s, " ", "");
+
+  const size_t byte_width = 2;
+
+  if (s.size() % byte_width != 0)
+  {
+    throw "invalid hex string";
+  }
+
+  bytes.reserve(s.size() / byte_width);
+
+  for (size_t i = 0; i < s.size(); i += byte_width)
+  {
+    const std::string e = s.substr(i, byte_width);
+    if (!isxdigit(e[0]) || !isxdigit(e[1]))
+    {
+      throw "invalid hex string";
+    }
+    
+    bytes.push_back((byte)strtoul(e.c_str(), nullptr, 16));
+  }
+
+  return true;
+}
+
+bool vuapi to_hex_bytes_W(const std::wstring& text, std::vector<byte>& bytes)
+{
+  const auto s = to_string_A(text);
+  return to_hex_bytes_A(s, bytes);
+}
+
+/**
+ * URL Encoding (RFC 3986)
+ * The percent-encoding is done on the bytes, the wide strings are encoded as UTF-8.
+ */
+
+// The unreserved characters (ALPHA / DIGIT / "-" / "." / "_" / "~")
+
+static const bool URL_UNRESERVED[256] =
+{
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0, 1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,
+  0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,1,
+  0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,0,0,0,1,0,
+};
+
+// The values of the hex digits, 0xFF for the others
+
+static const byte URL_HEX_VALUES[256] =
+{
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,255,255,255,255,255,255,
+  255, 10, 11, 12, 13, 14, 15,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255, 10, 11, 12, 13, 14, 15,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+};
+
+// The decoded byte of an escape at the position, or -1 if it's not a valid escape
+
+static inline int url_escape_at(const byte* ptr, const size_t size, const size_t i)
+{
+  if (i + 2 >= size)
+  {
+    return -1;
+  }
+
+  const byte hi = URL_HEX_VALUES[ptr[i + 1]];
+  const byte lo = URL_HEX_VALUES[ptr[i + 2]];
+
+  return hi == 0xFF || lo == 0xFF ? -1 : int(hi << 4 | lo);
+}
+
+static void url_encode_bytes(const byte* ptr, const size_t size, std::string& result)
+{
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+  size_t n = size;
+  for (size_t i = 0; i < size; i++)
+  {
+    n += URL_UNRESERVED[ptr[i]] ? 0 : 2;
+  }
+
+  result.clear();
+  result.resize(n);
+
+  auto p = &result[0];
+
+  for (size_t i = 0; i < size; i++)
+  {
+    const byte c = ptr[i];
+    if (URL_UNRESERVED[c])
+    {
+      *p++ = char(c);
+    }
+    else
+    {
+      *p++ = '%';
+      *p++ = HEX_DIGITS[c >> 4];
+      *p++ = HEX_DIGITS[c & 0xF];
+    }
+  }
+}
+
+// Decodes into the output that could be the input itself (the output is never longer)
+
+static size_t url_decode_bytes(const byte* ptr, const size_t size, byte* out)
+{
+  size_t n = 0;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    const byte c = ptr[i];
+    const int v = c == '%' ? url_escape_at(ptr, size, i) : -1;
+
+    if (v >= 0)
+    {
+      out[n++] = byte(v);
+      i += 2;
+    }
+    else
+    {
+      out[n++] = c == '+' ? ' ' : c;
+    }
+  }
+
+  return n;
 }
 
-std::string vuapi format_date_time_A(const time_t t, const std::string format)
+static size_t url_decoded_size(const byte* ptr, const size_t size)
 {
-  std::string s;
-  s.clear();
+  size_t n = size;
 
-  std::unique_ptr<char[]> p(new char [MAXBYTE]);
-  if (p == nullptr)
+  for (size_t i = 0; i < size; i++)
   {
-    return s;
+    if (ptr[i] == '%' && url_escape_at(ptr, size, i) >= 0)
+    {
+      n -= 2;
+      i += 2;
+    }
   }
 
-  tm lt = {0};
+  return n;
+}
 
-  ZeroMemory(p.get(), MAX_SIZE);
+void vuapi url_encode_A(const std::string& text, std::string& result)
+{
+  url_encode_bytes(reinterpret_cast<const byte*>(text.data()), text.size(), result);
+}
 
-  #if defined(_MSC_VER) && (_MSC_VER > 1200) // Above VC++ 6.0
-  localtime_s(&lt, &t);
-  #else
-  memcpy((void*)&lt, localtime(&t), sizeof(tm));
-  #endif
+void vuapi url_encode_W(const std::wstring& text, std::wstring& result)
+{
+  std::string utf8, encoded;
+  utf16_to_utf8(text, utf8);
+  url_encode_bytes(reinterpret_cast<const byte*>(utf8.data()), utf8.size(), encoded);
+  result.assign(encoded.cbegin(), encoded.cend()); // ASCII
+}
 
-  strftime(p.get(), MAX_SIZE, format.c_str(), &lt);
+void vuapi url_decode_A(const std::string& text, std::string& result)
+{
+  const auto ptr = reinterpret_cast<const byte*>(text.data());
 
-  s.assign(p.get());
+  result.clear();
+  result.resize(url_decoded_size(ptr, text.size()));
 
-  return s;
+  if (!result.empty())
+  {
+    url_decode_bytes(ptr, text.size(), reinterpret_cast<byte*>(&result[0]));
+  }
 }
 
-std::wstring vuapi format_date_time_W(const time_t t, const std::wstring format)
+void vuapi url_decode_W(const std::wstring& text, std::wstring& result)
 {
-  std::wstring s;
-  s.clear();
+  std::string utf8;
+  utf16_to_utf8(text, utf8);
+  url_decode_in_place_A(utf8);
 
-  std::unique_ptr<wchar[]> p(new wchar [MAXBYTE]);
-  if (p == nullptr) return s;
+  if (!utf8_to_utf16(utf8, result)) // not UTF-8, the bytes are in the ANSI code page
+  {
+    result = to_string_W(utf8);
+  }
+}
 
-  tm lt = {0};
+void vuapi url_decode_in_place_A(std::string& text)
+{
+  if (!text.empty())
+  {
+    const auto ptr = reinterpret_cast<byte*>(&text[0]);
+    text.resize(url_decode_bytes(ptr, text.size(), ptr));
+  }
+}
 
-  ZeroMemory(p.get(), 2*MAXBYTE);
+void vuapi url_decode_in_place_W(std::wstring& text)
+{
+  std::wstring result;
+  url_decode_W(text, result);
+  text.swap(result);
+}
 
-  #if defined(_MSC_VER) && (_MSC_VER > 1200) // Above VC++ 6.0
-  localtime_s(&lt, &t);
-  #else
-  memcpy((void*)&lt, localtime(&t), sizeof(tm));
-  #endif
+/**
+ * Number Conversion
+ */
+
+static const byte NUMBER_DIGIT_VALUES[128] =
+{
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 99, 99, 99, 99, 99, 99,
+  99, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+  25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 99, 99, 99, 99, 99,
+  99, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+  25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 99, 99, 99, 99, 99,
+};
+
+static inline bool number_valid_base(const int base)
+{
+  return base >= 2 && base <= 36;
+}
+
+template <typename char_t>
+static size_t number_to_chars_integer(
+  char_t* ptr, const size_t size, const unsigned long long v, const bool negative, const int base)
+{
+  if (!number_valid_base(base))
+  {
+    return 0;
+  }
 
-  wcsftime(p.get(), 2*MAXBYTE, format.c_str(), &lt);
+  char scratch[72];
+  auto last  = scratch + sizeof(scratch);
+  auto first = format_unsigned(last, v, unsigned(base), false);
 
-  s.assign(p.get());
+  if (negative)
+  {
+    *--first = '-';
+  }
 
-  return s;
+  const auto n = size_t(last - first);
+  if (n > size)
+  {
+    return 0;
+  }
+
+  std::copy(first, last, ptr);
+
+  return n;
 }
 
-void vuapi hex_dump(const void* data, int size)
+static size_t number_to_chars_float(char* ptr, const size_t size, const float v)
+{
+  #ifdef VU_TO_CHARS
+  const auto result = std::to_chars(ptr, ptr + size, v);
+  return result.ec == std::errc() ? size_t(result.ptr - ptr) : 0;
+  #else // VU_TO_CHARS
+  int n = 0;
+  for (int precision = 6; precision <= 9; precision++)
+  {
+    n = _snprintf(ptr, size, "%.*g", precision, double(v));
+    if (n <= 0 || size_t(n) >= size || strtof(ptr, nullptr) == v)
+    {
+      break;
+    }
+  }
+  return n > 0 && size_t(n) < size ? size_t(n) : 0;
+  #endif // VU_TO_CHARS
+}
+
+// The wide conversions are done in ASCII then widened, the numbers are always in ASCII
+
+template <typename T>
+static size_t number_to_chars_widen(wchar* ptr, const size_t size, const T v)
+{
+  char scratch[72];
+  const auto n = number_to_chars(scratch, (std::min)(size, sizeof(scratch)), v);
+  std::copy(scratch, scratch + n, ptr);
+  return n;
+}
+
+size_t vuapi number_to_chars(char* ptr, const size_t size, const long long v, const int base)
+{
+  const auto u = static_cast<unsigned long long>(v);
+  return number_to_chars_integer(ptr, size, v < 0 ? 0 - u : u, v < 0, base);
+}
+
+size_t vuapi number_to_chars(char* ptr, const size_t size, const unsigned long long v, const int base)
+{
+  return number_to_chars_integer(ptr, size, v, false, base);
+}
+
+size_t vuapi number_to_chars(char* ptr, const size_t size, const double v)
+{
+  return format_double(ptr, size, v, 0, -1);
+}
+
+size_t vuapi number_to_chars(char* ptr, const size_t size, const float v)
+{
+  return number_to_chars_float(ptr, size, v);
+}
+
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const long long v, const int base)
+{
+  const auto u = static_cast<unsigned long long>(v);
+  return number_to_chars_integer(ptr, size, v < 0 ? 0 - u : u, v < 0, base);
+}
+
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const unsigned long long v, const int base)
+{
+  return number_to_chars_integer(ptr, size, v, false, base);
+}
+
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const double v)
 {
-  const int DEFAULT_DUMP_COLUMN = 16;
+  return number_to_chars_widen(ptr, size, v);
+}
+
+size_t vuapi number_to_chars(wchar* ptr, const size_t size, const float v)
+{
+  return number_to_chars_widen(ptr, size, v);
+}
 
-  int i = 0;
-  uchar buffer[DEFAULT_DUMP_COLUMN + 1], *ptr_data = (uchar*)data;
+// Parses the digits and the optional sign, the overflow is detected without a wider type
 
-  for (int i = 0; i < size; i++)
+template <typename char_t>
+static NumberResult number_from_chars_integer(
+  const char_t* ptr, const size_t size, const int base, unsigned long long& v, bool& negative)
+{
+  if (!number_valid_base(base))
   {
-    if (i % DEFAULT_DUMP_COLUMN == 0)
-    {
-      if (i != 0)
-      {
-        printf("  %s\n", buffer);
-      }
+    return NumberResult(0, number_error::NE_INVALID);
+  }
 
-      printf("  %04x ", i);
-    }
+  size_t i = 0;
+
+  negative = false;
+  if (i < size && (ptr[i] == '-' || ptr[i] == '+'))
+  {
+    negative = ptr[i] == '-';
+    i++;
+  }
 
-    if (i % DEFAULT_DUMP_COLUMN == 8) printf(" ");
+  const auto start = i;
+  const auto limit = ULLONG_MAX / unsigned(base);
 
-    printf(" %02x", ptr_data[i]);
+  unsigned long long result = 0;
+  bool overflow = false;
+
+  for (; i < size; i++)
+  {
+    const auto c = static_cast<typename std::make_unsigned<char_t>::type>(ptr[i]);
+    const unsigned digit = c < 128 ? NUMBER_DIGIT_VALUES[c] : 99;
+    if (digit >= unsigned(base))
+    {
+      break;
+    }
 
-    if (ptr_data[i] < 0x20 || ptr_data[i] > 0x7E)
+    if (result > limit || result * unsigned(base) > ULLONG_MAX - digit)
     {
-      buffer[i % DEFAULT_DUMP_COLUMN] = '.';
+      overflow = true;
     }
     else
     {
-      buffer[i % DEFAULT_DUMP_COLUMN] = ptr_data[i];
+      result = result * unsigned(base) + digit;
     }
+  }
 
-    buffer[(i % DEFAULT_DUMP_COLUMN) + 1] = '\0';
+  if (i == start)
+  {
+    return NumberResult(0, number_error::NE_INVALID);
   }
 
-  while (i % DEFAULT_DUMP_COLUMN != 0)
+  if (overflow)
   {
-    printf("   ");
-    i++;
+    return NumberResult(i, number_error::NE_OVERFLOW);
   }
 
-  printf("  %s\n", buffer);
+  v = result;
+
+  return NumberResult(i);
 }
 
-std::string vuapi format_bytes_A(long long bytes, data_unit_type dut, int digits)
+template <typename char_t>
+static NumberResult number_from_chars_signed(const char_t* ptr, const size_t size, long long& v, const int base)
 {
-  std::string result = "";
+  unsigned long long u = 0;
+  bool negative = false;
 
-  if (bytes < 0 || digits < 0)
+  auto result = number_from_chars_integer(ptr, size, base, u, negative);
+  if (!result.ok())
   {
     return result;
   }
 
-  // Max positive number of long long is 2*63 ~ 9{18}.
-  // So log(9{18}, 1000-1024) ~ 6-7 array index.
-  static const char* SIUnits[]  = { "B", "KB", "MB", "GB", "TB", "PB", "EB" };
-  static const char* IECUnits[] = { "B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB" };
-  static const auto  Units = dut == data_unit_type::IEC ? IECUnits : SIUnits;
-
-  const auto log2l = [](long double v) -> long double
+  const auto max = static_cast<unsigned long long>(LLONG_MAX);
+  if (u > max + (negative ? 1 : 0))
   {
-    const long double M_LOG2E = 1.44269504088896340736;
-    return logl(v) * M_LOG2E;
-  };
+    result.error = number_error::NE_OVERFLOW;
+    return result;
+  }
 
-  const auto logn = [&](long double v, long double n) -> long double
-  {
-    return log2l(v) / log2l(n);
-  };
+  v = negative ? static_cast<long long>(0 - u) : static_cast<long long>(u);
 
-  int idx = 0;
+  return result;
+}
 
-  if (bytes > 0)
+template <typename char_t>
+static NumberResult number_from_chars_unsigned(
+  const char_t* ptr, const size_t size, unsigned long long& v, const int base)
+{
+  if (size != 0 && ptr[0] == '-')
   {
-    idx = (int)logn(static_cast<long double>(bytes), static_cast<long double>(dut));
-
-    std::string fmt = "%0.";
-    fmt += std::to_string(digits);
-    fmt += "f %s";
-
-    result = format_A(fmt, float(bytes / powl(static_cast<long double>(dut), idx)), Units[idx]);
+    return NumberResult(0, number_error::NE_INVALID);
   }
 
-  return result;
+  bool negative = false;
+  return number_from_chars_integer(ptr, size, base, v, negative);
 }
 
-std::wstring vuapi format_bytes_W(long long bytes, data_unit_type dut, int digits)
-{
-  return to_string_W(format_bytes_A(bytes, dut, digits));
-}
+// The number of the leading characters that can be a part of a floating-point number (no hex)
 
-std::string vuapi to_hex_string_A(const byte* ptr, const size_t size)
+template <typename char_t>
+static size_t number_floating_span(const char_t* ptr, const size_t size)
 {
-  std::stringstream ss;
+  static const char chars[] = "0123456789+-.eEiInNfFaAtTyY";
 
-  for (size_t i = 0; i < size; i++)
+  size_t i = 0;
+  for (; i < size; i++)
   {
-    ss << std::hex << std::setfill('0') << std::setw(2) << int(ptr[i]);
+    if (ptr[i] == 0 || ptr[i] > 0x7F || strchr(chars, int(ptr[i])) == nullptr)
+    {
+      break;
+    }
   }
 
-  return ss.str();
+  return i;
 }
 
-std::wstring vuapi to_hex_string_W(const byte* ptr, const size_t size)
+static inline void number_strtod(const char* ptr, char** end, double& v)
 {
-  auto s = to_hex_string_A(ptr, size);
-  return to_string_W(s);
+  v = strtod(ptr, end);
 }
 
-bool vuapi to_hex_bytes_A(const std::string& text, std::vector<byte>& bytes)
+static inline void number_strtod(const char* ptr, char** end, float& v)
 {
-  bytes.clear();
+  v = strtof(ptr, end);
+}
 
-  auto s = trim_string_A(text);
-  s = replace_string_A(s, " ", "");
+template <typename T>
+static NumberResult number_from_chars_floating(const char* ptr, const size_t size, T& v)
+{
+  size_t i = 0;
+  if (i < size && ptr[i] == '+')
+  {
+    i++;
+    if (i < size && ptr[i] == '-')
+    {
+      return NumberResult(0, number_error::NE_INVALID);
+    }
+  }
 
-  const size_t byte_width = 2;
+  T number = 0;
 
-  if (s.size() % byte_width != 0)
+  #ifdef VU_TO_CHARS
+  const auto result = std::from_chars(ptr + i, ptr + size, number);
+  if (result.ec == std::errc::invalid_argument)
   {
-    throw "invalid hex string";
+    return NumberResult(0, number_error::NE_INVALID);
   }
 
-  bytes.reserve(s.size() / byte_width);
+  const auto position = size_t(result.ptr - ptr);
+  if (result.ec == std::errc::result_out_of_range)
+  {
+    return NumberResult(position, number_error::NE_OVERFLOW);
+  }
+  #else // VU_TO_CHARS
+  // strtod needs a null-terminated string, so the candidate characters are copied
 
-  for (size_t i = 0; i < s.size(); i += byte_width)
+  const auto n = number_floating_span(ptr + i, size - i);
+
+  char stack[128];
+  std::string heap;
+
+  char* buffer = stack;
+  if (n >= sizeof(stack))
   {
-    const std::string e = s.substr(i, byte_width);
-    if (!isxdigit(e[0]) || !isxdigit(e[1]))
-    {
-      throw "invalid hex string";
-    }
-    
-    bytes.push_back((byte)strtoul(e.c_str(), nullptr, 16));
+    heap.assign(ptr + i, n);
+    buffer = &heap[0];
+  }
+  else
+  {
+    memcpy(stack, ptr + i, n);
+    stack[n] = '\0';
   }
 
-  return true;
+  char* end = nullptr;
+  errno = 0;
+  number_strtod(buffer, &end, number);
+
+  if (end == buffer)
+  {
+    return NumberResult(0, number_error::NE_INVALID);
+  }
+
+  // the subnormal numbers are also ERANGE, but they are representable
+
+  const auto position = i + size_t(end - buffer);
+  if (errno == ERANGE && (std::isinf(number) || number == T(0)))
+  {
+    return NumberResult(position, number_error::NE_OVERFLOW);
+  }
+  #endif // VU_TO_CHARS
+
+  v = number;
+
+  return NumberResult(position);
 }
 
-bool vuapi to_hex_bytes_W(const std::wstring& text, std::vector<byte>& bytes)
+template <typename T>
+static NumberResult number_from_chars_narrow(const wchar* ptr, const size_t size, T& v)
 {
-  const auto s = to_string_A(text);
-  return to_hex_bytes_A(s, bytes);
+  const auto n = number_floating_span(ptr, size);
+
+  char stack[128];
+  std::string heap;
+
+  char* buffer = stack;
+  if (n > sizeof(stack))
+  {
+    heap.resize(n);
+    buffer = &heap[0];
+  }
+
+  std::transform(ptr, ptr + n, buffer, [](const wchar c) -> char { return char(c); });
+
+  return number_from_chars_floating(buffer, n, v);
 }
 
-void vuapi url_encode_A(const std::string& text, std::string& result)
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, long long& v, const int base)
 {
-  auto s = to_string_W(text);
-  std::wstring res = L"";
-  url_encode_W(s, res);
-  result = to_string_A(res);
+  return number_from_chars_signed(ptr, size, v, base);
 }
 
-void vuapi url_encode_W(const std::wstring& text, std::wstring& result)
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, unsigned long long& v, const int base)
 {
-  result.clear();
+  return number_from_chars_unsigned(ptr, size, v, base);
+}
 
-  for (const auto& c : text)
-  {
-    // uncomment this if you want to encode spaces with +
-    // if (c==' ')
-    // {
-    //   result += '+';
-    // }
-    // else
-    if (iswalnum(c) || c == L'-' || c == L'_' || c == L'.' || c == L'~')
-    {
-      result += c;
-    }
-    else
-    {
-      wchar_t s[10] = {0};
-      #ifdef __MINGW32__
-      _itow_s(c, s, ARRAYSIZE(s), 16);
-      #else // _MSC_VER
-      _itow_s(c, s, 16);
-      #endif
-      result += c < 16 ? L"%0" : L"%";
-      result += s;
-    }
-  }
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, double& v)
+{
+  return number_from_chars_floating(ptr, size, v);
 }
 
-void vuapi url_decode_A(const std::string& text, std::string& result)
+NumberResult vuapi number_from_chars(const char* ptr, const size_t size, float& v)
 {
-  auto s = to_string_W(text);
-  std::wstring res = L"";
-  url_decode_W(s, res);
-  result = to_string_A(res);
+  return number_from_chars_floating(ptr, size, v);
 }
 
-void vuapi url_decode_W(const std::wstring& text, std::wstring& result)
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, long long& v, const int base)
 {
-  result.clear();
+  return number_from_chars_signed(ptr, size, v, base);
+}
 
-  for (size_t i = 0; i < text.length(); i++)
-  {
-    if (text[i] != L'%')
-    {
-      result += text[i] == L'+' ? L' ' : text[i];
-    }
-    else
-    {
-      int v = 0;
-      swscanf_s(text.substr(i + 1, 2).c_str(), L"%x", &v);
-      result += wchar_t(v);
-      i += 2;
-    }
-  }
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, unsigned long long& v, const int base)
+{
+  return number_from_chars_unsigned(ptr, size, v, base);
+}
+
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, double& v)
+{
+  return number_from_chars_narrow(ptr, size, v);
+}
+
+NumberResult vuapi number_from_chars(const wchar* ptr, const size_t size, float& v)
+{
+  return number_from_chars_narrow(ptr, size, v);
 }
 
 /**
  * FundamentalA
  */
 
+// Parses the number at the beginning of the data like atoi/atof (0 if there is no number)
+
+template <typename T, typename char_t>
+static T fundamental_to_number(const std::basic_string<char_t>& data)
+{
+  static const char_t spaces[] = { ' ', '\t', '\n', '\r', '\f', '\v', '\0' };
+
+  const StringViewT<char_t> view(data);
+
+  const auto pos = view.find_first_not_of(spaces);
+  if (pos == StringViewT<char_t>::npos)
+  {
+    return T(0);
+  }
+
+  typename NumberTypeT<T>::type v = 0;
+  number_from_chars(view.data() + pos, view.size() - pos, v);
+
+  return T(v);
+}
+
 FundamentalA::FundamentalA()
 {
-  m_data.clear();
 }
 
 FundamentalA::~FundamentalA()
 {
 }
 
-std::stringstream& FundamentalA::data()
+std::string& FundamentalA::data()
 {
   return m_data;
 }
 
 std::string FundamentalA::to_string() const
 {
-  return m_data.str();
+  return m_data;
 }
 
 bool FundamentalA::to_boolean() const
@@ -683,41 +2200,44 @@ bool FundamentalA::to_boolean() const
 
 int FundamentalA::to_integer() const
 {
-  return atoi(m_data.str().c_str());
+  return fundamental_to_number<int>(m_data);
 }
 
 long FundamentalA::to_long() const
 {
-  return atol(m_data.str().c_str());
+  return fundamental_to_number<long>(m_data);
 }
 
 float FundamentalA::to_float() const
 {
-  return float(to_double());
+  return fundamental_to_number<float>(m_data);
 }
 
 double FundamentalA::to_double() const
 {
-  return atof(m_data.str().c_str());
+  return fundamental_to_number<double>(m_data);
 }
 
+/**
+ * FundamentalW
+ */
+
 FundamentalW::FundamentalW()
 {
-  m_data.clear();
 }
 
 FundamentalW::~FundamentalW()
 {
 }
 
-std::wstringstream& FundamentalW::data()
+std::wstring& FundamentalW::data()
 {
   return m_data;
 }
 
 std::wstring FundamentalW::to_string() const
 {
-  return m_data.str();
+  return m_data;
 }
 
 bool FundamentalW::to_boolean() const
@@ -727,22 +2247,22 @@ bool FundamentalW::to_boolean() const
 
 int FundamentalW::to_integer() const
 {
-  return atoi(to_string_A(m_data.str()).c_str());
+  return fundamental_to_number<int>(m_data);
 }
 
 long FundamentalW::to_long() const
 {
-  return atol(to_string_A(m_data.str()).c_str());
+  return fundamental_to_number<long>(m_data);
 }
 
 float FundamentalW::to_float() const
 {
-  return float(to_double());
+  return fundamental_to_number<float>(m_data);
 }
 
 double FundamentalW::to_double() const
 {
-  return atof(to_string_A(m_data.str()).c_str());
+  return fundamental_to_number<double>(m_data);
 }
 
 #ifdef _MSC_VER
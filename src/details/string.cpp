@@ -5,10 +5,15 @@
  */
 
 #include "Vutils.h"
+#include "strcase.h"
 
-#include <csignal>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VU_STRING_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace vu
 {
 
@@ -20,169 +25,561 @@ namespace vu
 #pragma warning(disable: 26812)
 #endif // _MSC_VER
 
-#ifndef CHAR_BIT
-#define CHAR_BIT      8    // number of bits in a char
-#define SCHAR_MIN   (-128) // minimum signed char value
-#define SCHAR_MAX     127  // maximum signed char value
-#define UCHAR_MAX     255  // maximum unsigned char value
-#endif
+/* ---------------------------------------------- String View Working ---------------------------------------------- */
+
+/**
+ * The index of the lowest set bit of a non-zero mask
+ */
 
-encoding_type vuapi determine_encoding_type(const void* data, const size_t size)
+static inline uint32 lowest_bit_index(uint32 mask)
 {
-  if (data == nullptr || size == 0) return encoding_type::ET_UNKNOWN;
+  uint32 result = 0;
+
+  while ((mask & 1) == 0)
+  {
+    mask >>= 1;
+    result++;
+  }
+
+  return result;
+}
 
-  auto p = (uchar*)data;
+#ifdef VU_STRING_SSE2
 
-  if (size == 1)
+static inline __m128i fold_ascii_epi8(const __m128i v)
+{
+  const __m128i upper = _mm_and_si128(
+    _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+  return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static inline __m128i fold_ascii_epi16(const __m128i v)
+{
+  const __m128i upper = _mm_and_si128(
+    _mm_cmpgt_epi16(v, _mm_set1_epi16('A' - 1)), _mm_cmplt_epi16(v, _mm_set1_epi16('Z' + 1)));
+  return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+}
+
+#endif // VU_STRING_SSE2
+
+bool vuapi equal_ignore_case(const char* left, const char* right, const size_t size)
+{
+  if (left == right || size == 0)
   {
-    /* UTF-8 */
-    if (p[0] >= SCHAR_MIN && p[0] <= SCHAR_MAX) return encoding_type::ET_UTF8_BOM;
+    return true;
   }
 
-  signal(SIGSEGV, [](int signal)
+  if (left == nullptr || right == nullptr)
   {
-    throw signal;
-  });
+    return false;
+  }
 
-  try
+  size_t i = 0;
+
+#ifdef VU_STRING_SSE2
+  for (; i + 16 <= size; i += 16)
   {
-    /* UTF-8 BOM */
-    if (p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF)
+    const __m128i l = fold_ascii_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i)));
+    const __m128i r = fold_ascii_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF)
     {
-      return encoding_type::ET_UTF8_BOM;
+      return false;
     }
+  }
+#endif // VU_STRING_SSE2
 
-    /* UTF-32 LE BOM */
-    if (p[0] == 0xFF && p[1] == 0xFE && p[2] == 0x00 && p[3] == 0x00)
+  for (; i < size; i++)
+  {
+    if (fold_case(left[i]) != fold_case(right[i]))
     {
-      return encoding_type::ET_UTF32_LE_BOM;
+      return false;
     }
+  }
+
+  return true;
+}
+
+bool vuapi equal_ignore_case(const wchar* left, const wchar* right, const size_t size)
+{
+  if (left == right || size == 0)
+  {
+    return true;
+  }
+
+  if (left == nullptr || right == nullptr)
+  {
+    return false;
+  }
+
+  size_t i = 0;
 
-    /* UTF-32 BE BOM */
-    if (p[0] == 0x00 && p[1] == 0x00 && p[2] == 0xFE && p[3] == 0xFF)
+#ifdef VU_STRING_SSE2
+  if (sizeof(wchar) == 2)
+  {
+    for (; i + 8 <= size; i += 8)
     {
-      return encoding_type::ET_UTF32_BE_BOM;
+      const __m128i l = fold_ascii_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i)));
+      const __m128i r = fold_ascii_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i)));
+
+      // the lanes that are still different after the ASCII folding are folded one by one
+
+      uint32 mask = ~uint32(_mm_movemask_epi8(_mm_cmpeq_epi16(l, r))) & 0xFFFF;
+      while (mask != 0)
+      {
+        const auto j = i + lowest_bit_index(mask) / 2;
+        if (fold_case(left[j]) != fold_case(right[j]))
+        {
+          return false;
+        }
+
+        mask &= ~(3u << ((j - i) * 2));
+      }
     }
+  }
+#endif // VU_STRING_SSE2
 
-    /* UTF-16 LE BOM */
-    if (p[0] == 0xFF && p[1] == 0xFE)
+  for (; i < size; i++)
+  {
+    if (left[i] != right[i] && fold_case(left[i]) != fold_case(right[i]))
     {
-      return encoding_type::ET_UTF16_LE_BOM;
+      return false;
     }
+  }
+
+  return true;
+}
+
+const char* vuapi find_ignore_case(
+  const char* text, const size_t text_size, const char* test, const size_t test_size)
+{
+  if (text == nullptr || test_size > text_size)
+  {
+    return nullptr;
+  }
 
-    /* UTF-16 BE BOM */
-    if (p[0] == 0xFE && p[1] == 0xFF)
+  if (test_size == 0)
+  {
+    return text;
+  }
+
+  if (test == nullptr)
+  {
+    return nullptr;
+  }
+
+  // the candidates are found by the first character (both of its cases), then the rest is compared
+
+  const char first = fold_case(test[0]);
+  const size_t n = text_size - test_size + 1;
+
+  size_t i = 0;
+
+#ifdef VU_STRING_SSE2
+  const __m128i lower = _mm_set1_epi8(first);
+  const __m128i upper = _mm_set1_epi8(unfold_case(first));
+
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+    uint32 mask = uint32(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lower), _mm_cmpeq_epi8(v, upper))));
+
+    for (; mask != 0; mask &= mask - 1)
     {
-      return encoding_type::ET_UTF16_BE_BOM;
+      const auto p = text + i + lowest_bit_index(mask);
+      if (equal_ignore_case(p + 1, test + 1, test_size - 1))
+      {
+        return p;
+      }
     }
+  }
+#endif // VU_STRING_SSE2
 
-    /* UTF-16 LE */
-    if ((p[0] >= SCHAR_MIN && p[0] <= SCHAR_MAX) && p[1] == 0x00)
+  for (; i < n; i++)
+  {
+    if (fold_case(text[i]) == first && equal_ignore_case(text + i + 1, test + 1, test_size - 1))
     {
-      return encoding_type::ET_UTF16_LE;
+      return text + i;
     }
+  }
+
+  return nullptr;
+}
+
+const wchar* vuapi find_ignore_case(
+  const wchar* text, const size_t text_size, const wchar* test, const size_t test_size)
+{
+  if (text == nullptr || test_size > text_size)
+  {
+    return nullptr;
+  }
 
-    /* UTF-16 BE */
-    if ((p[1] >= SCHAR_MIN && p[1] <= SCHAR_MAX) && p[0] == 0x00)
+  if (test_size == 0)
+  {
+    return text;
+  }
+
+  if (test == nullptr)
+  {
+    return nullptr;
+  }
+
+  const wchar first = fold_case(test[0]);
+  const size_t n = text_size - test_size + 1;
+
+  size_t i = 0;
+
+#ifdef VU_STRING_SSE2
+  if (sizeof(wchar) == 2)
+  {
+    // the non-ASCII lanes are always the candidates since they could be folded to an ASCII letter
+
+    const wchar other = first < 0x80 ? wchar(unfold_case(char(first))) : wchar(towupper(first));
+    const __m128i lower = _mm_set1_epi16(short(first));
+    const __m128i upper = _mm_set1_epi16(short(other));
+    const __m128i ascii = _mm_set1_epi16(short(0xFF80));
+
+    for (; i + 8 <= n; i += 8)
     {
-      return encoding_type::ET_UTF16_BE;
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+      const __m128i non_ascii = _mm_xor_si128(
+        _mm_cmpeq_epi16(_mm_and_si128(v, ascii), _mm_setzero_si128()), _mm_set1_epi16(-1));
+      uint32 mask = uint32(_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, lower), _mm_cmpeq_epi16(v, upper)), non_ascii)));
+
+      while (mask != 0)
+      {
+        const auto j = lowest_bit_index(mask) / 2;
+        const auto p = text + i + j;
+        if (fold_case(*p) == first && equal_ignore_case(p + 1, test + 1, test_size - 1))
+        {
+          return p;
+        }
+
+        mask &= ~(3u << (j * 2));
+      }
     }
+  }
+#endif // VU_STRING_SSE2
 
-    /* UTF-8 */
-    if ((p[0] >= SCHAR_MIN && p[0] <= SCHAR_MAX) && (p[1] >= SCHAR_MIN && p[1] <= SCHAR_MAX))
+  for (; i < n; i++)
+  {
+    if (fold_case(text[i]) == first && equal_ignore_case(text + i + 1, test + 1, test_size - 1))
     {
-      return encoding_type::ET_UTF8;
+      return text + i;
     }
   }
-  catch (int)
+
+  return nullptr;
+}
+
+template <class string_view_t>
+static bool equal_T(const string_view_t& left, const string_view_t& right, bool ignore_case)
+{
+  if (left.size() != right.size())
   {
-    return encoding_type::ET_UNKNOWN;
+    return false;
   }
 
-  return encoding_type::ET_UNKNOWN;
+  return ignore_case ? equal_ignore_case(left.data(), right.data(), left.size()) : left == right;
 }
 
-/* ------------------------------------------------ String Working ------------------------------------------------- */
+template <class string_view_t>
+static size_t find_T(const string_view_t& text, const string_view_t& test, bool ignore_case)
+{
+  if (!ignore_case)
+  {
+    return text.find(test);
+  }
 
-std::string vuapi lower_string_A(const std::string& string)
+  const auto p = find_ignore_case(text.data(), text.size(), test.data(), test.size());
+  return p == nullptr ? string_view_t::npos : size_t(p - text.data());
+}
+
+const char* vuapi find_char(const char* ptr, const size_t size, const char c)
 {
-  std::string s(string);
-  std::transform(s.begin(), s.end(), s.begin(), tolower);
-  return s;
+  if (ptr == nullptr)
+  {
+    return nullptr;
+  }
+
+  size_t i = 0;
+
+#ifdef VU_STRING_SSE2
+  const __m128i needle = _mm_set1_epi8(c);
+
+  for (; i + 16 <= size; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+    const uint32 mask = uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+    if (mask != 0)
+    {
+      return ptr + i + lowest_bit_index(mask);
+    }
+  }
+#endif // VU_STRING_SSE2
+
+  for (; i < size; i++)
+  {
+    if (ptr[i] == c)
+    {
+      return ptr + i;
+    }
+  }
+
+  return nullptr;
 }
 
-std::wstring vuapi lower_string_W(const std::wstring& string)
+const wchar* vuapi find_char(const wchar* ptr, const size_t size, const wchar c)
 {
-  std::wstring s(string);
-  std::transform(s.begin(), s.end(), s.begin(), tolower);
-  return s;
+  if (ptr == nullptr)
+  {
+    return nullptr;
+  }
+
+  size_t i = 0;
+
+#ifdef VU_STRING_SSE2
+  if (sizeof(wchar) == 2)
+  {
+    const __m128i needle = _mm_set1_epi16(short(c));
+
+    for (; i + 8 <= size; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+      const uint32 mask = uint32(_mm_movemask_epi8(_mm_cmpeq_epi16(v, needle)));
+      if (mask != 0)
+      {
+        return ptr + i + lowest_bit_index(mask) / 2;
+      }
+    }
+  }
+#endif // VU_STRING_SSE2
+
+  for (; i < size; i++)
+  {
+    if (ptr[i] == c)
+    {
+      return ptr + i;
+    }
+  }
+
+  return nullptr;
 }
 
-std::string vuapi upper_string_A(const std::string& string)
+template <class string_view_t>
+static void split_string_view_T(
+  const string_view_t& string,
+  const string_view_t& separator,
+  std::vector<string_view_t>& parts,
+  bool remove_empty)
 {
-  std::string s(string);
-  std::transform(s.begin(), s.end(), s.begin(), toupper);
-  return s;
+  parts.clear();
+
+  const auto type = separator.size() == 1 ? split_type::ST_CHAR : split_type::ST_STRING;
+  TokenizerT<typename string_view_t::value_type> tokenizer(string, separator, type, remove_empty);
+
+  for (string_view_t token; tokenizer.next(token);)
+  {
+    parts.push_back(token);
+  }
 }
 
-std::wstring vuapi upper_string_W(const std::wstring& string)
+void vuapi split_string_view_A(
+  const StringViewA& string, const StringViewA& separator, std::vector<StringViewA>& parts, bool remove_empty)
 {
-  std::wstring s(string);
-  std::transform(s.begin(), s.end(), s.begin(), toupper);
-  return s;
+  split_string_view_T(string, separator, parts, remove_empty);
+}
+
+void vuapi split_string_view_W(
+  const StringViewW& string, const StringViewW& separator, std::vector<StringViewW>& parts, bool remove_empty)
+{
+  split_string_view_T(string, separator, parts, remove_empty);
 }
 
-std::string vuapi to_string_A(const std::wstring& string)
+template <class string_view_t, class std_string_t>
+static void join_string_view_T(
+  const std::vector<string_view_t>& parts, const string_view_t& separator, std_string_t& result)
 {
-  std::string s;
-  s.clear();
+  result.clear();
 
-  if (string.empty())
+  if (parts.empty())
   {
-    return s;
+    return;
   }
 
-  int N = (int)string.length() + 1;
+  size_t size = separator.size() * (parts.size() - 1);
+  for (const auto& e : parts)
+  {
+    size += e.size();
+  }
 
-  std::unique_ptr<char[]> p(new char [N]);
-  if (p == nullptr)
+  result.reserve(size);
+
+  for (size_t i = 0; i < parts.size(); i++)
+  {
+    if (i != 0)
+    {
+      result.append(separator.data(), separator.size());
+    }
+
+    result.append(parts[i].data(), parts[i].size());
+  }
+}
+
+void vuapi join_string_view_A(
+  const std::vector<StringViewA>& parts, const StringViewA& separator, std::string& result)
+{
+  join_string_view_T(parts, separator, result);
+}
+
+void vuapi join_string_view_W(
+  const std::vector<StringViewW>& parts, const StringViewW& separator, std::wstring& result)
+{
+  join_string_view_T(parts, separator, result);
+}
+
+template <class string_view_t>
+static string_view_t trim_string_view_T(
+  const string_view_t& string, const trim_type& type, const string_view_t& chars)
+{
+  auto result = string;
+
+  if (type == trim_type::TS_LEFT || type == trim_type::TS_BOTH)
   {
-    return s;
+    const auto pos = result.find_first_not_of(chars);
+    result.remove_prefix(pos == string_view_t::npos ? result.size() : pos);
   }
 
-  ZeroMemory(p.get(), N);
+  if (type == trim_type::TS_RIGHT || type == trim_type::TS_BOTH)
+  {
+    const auto pos = result.find_last_not_of(chars);
+    result = result.substr(0, pos == string_view_t::npos ? 0 : pos + 1);
+  }
 
-  WideCharToMultiByte(CP_ACP, WC_COMPOSITECHECK, string.c_str(), -1, p.get(), N, NULL, NULL);
+  return result;
+}
 
-  s.assign(p.get());
+StringViewA vuapi trim_string_view_A(const StringViewA& string, const trim_type& type, const StringViewA& chars)
+{
+  return trim_string_view_T(string, type, chars);
+}
 
-  return s;
+StringViewW vuapi trim_string_view_W(const StringViewW& string, const trim_type& type, const StringViewW& chars)
+{
+  return trim_string_view_T(string, type, chars);
 }
 
-std::wstring vuapi to_string_W(const std::string& string)
+template <class string_view_t, class std_string_t>
+static void replace_string_view_T(
+  const string_view_t& text, const string_view_t& from, const string_view_t& to, std_string_t& result)
 {
-  std::wstring s;
-  s.clear();
+  result.clear();
 
-  if (string.empty())
+  if (from.empty())
   {
-    return s;
+    result.assign(text.data(), text.size());
+    return;
   }
 
-  int N = (int)string.length() + 1;
+  // count the occurrences to build the result with the exact size
 
-  std::unique_ptr<wchar[]> p(new wchar [N]);
-  if (p == nullptr)
+  size_t count = 0;
+  for (size_t pos = 0; (pos = text.find(from, pos)) != string_view_t::npos; pos += from.size())
   {
-    s.clear();
+    count++;
   }
 
-  ZeroMemory(p.get(), 2*N);
+  result.reserve(text.size() - count * from.size() + count * to.size());
 
-  MultiByteToWideChar(CP_ACP, 0, string.c_str(), -1, p.get(), 2*N);
+  size_t start = 0;
+  for (size_t pos = 0; (pos = text.find(from, start)) != string_view_t::npos; start = pos + from.size())
+  {
+    result.append(text.data() + start, pos - start);
+    result.append(to.data(), to.size());
+  }
+
+  result.append(text.data() + start, text.size() - start);
+}
 
-  s.assign(p.get());
+void vuapi replace_string_view_A(
+  const StringViewA& text, const StringViewA& from, const StringViewA& to, std::string& result)
+{
+  replace_string_view_T(text, from, to, result);
+}
 
+void vuapi replace_string_view_W(
+  const StringViewW& text, const StringViewW& from, const StringViewW& to, std::wstring& result)
+{
+  replace_string_view_T(text, from, to, result);
+}
+
+bool vuapi starts_with_view_A(const StringViewA& text, const StringViewA& with, bool ignore_case)
+{
+  return text.size() >= with.size() && equal_T(text.substr(0, with.size()), with, ignore_case);
+}
+
+bool vuapi starts_with_view_W(const StringViewW& text, const StringViewW& with, bool ignore_case)
+{
+  return text.size() >= with.size() && equal_T(text.substr(0, with.size()), with, ignore_case);
+}
+
+bool vuapi ends_with_view_A(const StringViewA& text, const StringViewA& with, bool ignore_case)
+{
+  return text.size() >= with.size() && equal_T(text.substr(text.size() - with.size()), with, ignore_case);
+}
+
+bool vuapi ends_with_view_W(const StringViewW& text, const StringViewW& with, bool ignore_case)
+{
+  return text.size() >= with.size() && equal_T(text.substr(text.size() - with.size()), with, ignore_case);
+}
+
+bool vuapi contains_string_view_A(const StringViewA& text, const StringViewA& test, bool ignore_case)
+{
+  return find_T(text, test, ignore_case) != StringViewA::npos;
+}
+
+bool vuapi contains_string_view_W(const StringViewW& text, const StringViewW& test, bool ignore_case)
+{
+  return find_T(text, test, ignore_case) != StringViewW::npos;
+}
+
+bool vuapi compare_string_view_A(const StringViewA& vl, const StringViewA& vr, bool ignore_case)
+{
+  return equal_T(vl, vr, ignore_case);
+}
+
+bool vuapi compare_string_view_W(const StringViewW& vl, const StringViewW& vr, bool ignore_case)
+{
+  return equal_T(vl, vr, ignore_case);
+}
+
+/* ------------------------------------------------ String Working ------------------------------------------------- */
+
+std::string vuapi lower_string_A(const std::string& string)
+{
+  std::string s(string);
+  std::transform(s.begin(), s.end(), s.begin(), tolower);
+  return s;
+}
+
+std::wstring vuapi lower_string_W(const std::wstring& string)
+{
+  std::wstring s(string);
+  std::transform(s.begin(), s.end(), s.begin(), tolower);
+  return s;
+}
+
+std::string vuapi upper_string_A(const std::string& string)
+{
+  std::string s(string);
+  std::transform(s.begin(), s.end(), s.begin(), toupper);
+  return s;
+}
+
+std::wstring vuapi upper_string_W(const std::wstring& string)
+{
+  std::wstring s(string);
+  std::transform(s.begin(), s.end(), s.begin(), toupper);
   return s;
 }
 
@@ -190,30 +587,19 @@ template <class std_string_t>
 std::vector<std_string_t> split_string_T(
   const std_string_t& string, const std_string_t& separator, bool remove_empty)
 {
-  std::vector<std_string_t> l;
-  l.clear();
+  typedef StringViewT<typename std_string_t::value_type> string_view_t;
 
-  if (string.empty())
-  {
-    return l;
-  }
+  std::vector<string_view_t> parts;
+  split_string_view_T<string_view_t>(string, separator, parts, remove_empty);
 
-  std_string_t s(string), sep(separator), sub;
-  ulongptr start, end;
+  std::vector<std_string_t> l;
+  l.reserve(parts.size());
 
-  start = 0;
-  end = s.find(sep);
-  while (end != std_string_t::npos)
+  for (const auto& e : parts)
   {
-    sub = s.substr(start, end - start);
-    if (!sub.empty() || !remove_empty) l.push_back(std_string_t(sub.c_str()));
-    start = end + sep.length();
-    end = s.find(sep, start);
+    l.push_back(e.str());
   }
 
-  sub = s.substr(start, end);
-  if (!sub.empty() || !remove_empty) l.push_back(std_string_t(sub.c_str()));
-
   return l;
 }
 
@@ -232,29 +618,12 @@ std::vector<std::wstring> vuapi split_string_W(
 template <class std_string_t>
 std_string_t vuapi join_string_T(const std::vector<std_string_t> parts, const std_string_t& separator)
 {
-  if (parts.empty())
-  {
-    return std_string_t();
-  }
+  typedef StringViewT<typename std_string_t::value_type> string_view_t;
 
-  if (parts.size() == 1)
-  {
-    return parts[0];
-  }
+  std::vector<string_view_t> views(parts.cbegin(), parts.cend());
 
   std_string_t result;
-
-  size_t num = parts.size();
-
-  for (size_t i = 0; i < num; i++)
-  {
-    result += parts[i];
-
-    if (i < num - 1)
-    {
-      result += separator;
-    }
-  }
+  join_string_view_T<string_view_t>(views, separator, result);
 
   return result;
 }
@@ -393,187 +762,241 @@ std::wstring vuapi load_rs_string_W(const uint id, const std::wstring& module_na
   return result;
 }
 
+std::string vuapi trim_string_A(
+  const std::string& string, const trim_type& type, const std::string& chars)
+{
+  return trim_string_view_A(string, type, chars).str();
+}
+
+std::wstring vuapi trim_string_W(
+  const std::wstring& string, const trim_type& type, const std::wstring& chars)
+{
+  return trim_string_view_W(string, type, chars).str();
+}
+
+std::string vuapi replace_string_A(
+  const std::string& text, const std::string& from, const std::string& to)
+{
+  std::string result;
+  replace_string_view_A(text, from, to, result);
+  return result;
+}
+
+std::wstring vuapi replace_string_W(
+  const std::wstring& text, const std::wstring& from, const std::wstring& to)
+{
+  std::wstring result;
+  replace_string_view_W(text, from, to, result);
+  return result;
+}
+
+/**
+ * The needles are dispatched by the low byte of their first character, the needles of a bucket are
+ * sorted by their lengths (descending) so the longest needle is matched at a position.
+ */
+
 template <class std_string_t>
-std_string_t TrimStringT(
-  const std_string_t& std_string,
-  const trim_type& trim,
-  const std_string_t& trim_chars
-)
+class ReplacementTableT
 {
-  std_string_t s = std_string;
+public:
+  typedef typename std_string_t::value_type char_t;
+  typedef typename std::make_unsigned<char_t>::type uchar_t;
+  typedef std::pair<const std_string_t*, const std_string_t*> pattern_t;
 
-  switch (trim)
+  ReplacementTableT(const std::map<std_string_t, std_string_t>& replacements)
   {
-  case trim_type::TS_LEFT:
-    s.erase(0, s.find_first_not_of(trim_chars));
-    break;
+    for (const auto& e : replacements)
+    {
+      if (!e.first.empty())
+      {
+        m_buckets[bucket(e.first[0])].push_back(pattern_t(&e.first, &e.second));
+      }
+    }
 
-  case trim_type::TS_RIGHT:
-    s.erase(s.find_last_not_of(trim_chars) + 1);
-    break;
+    for (auto& bucket : m_buckets)
+    {
+      std::sort(bucket.begin(), bucket.end(), [](const pattern_t& l, const pattern_t& r) -> bool
+      {
+        return l.first->size() > r.first->size();
+      });
+    }
+  }
 
-  case trim_type::TS_BOTH:
-    s.erase(0, s.find_first_not_of(trim_chars));
-    s.erase(s.find_last_not_of(trim_chars) + 1);
-    break;
+  const pattern_t* match(const char_t* ptr, const size_t size) const
+  {
+    for (const auto& e : m_buckets[bucket(ptr[0])])
+    {
+      const auto& needle = *e.first;
+      if (needle.size() <= size && std::char_traits<char_t>::compare(ptr, needle.data(), needle.size()) == 0)
+      {
+        return &e;
+      }
+    }
 
-  default:
-    break;
+    return nullptr;
   }
 
-  return s;
-}
-
-std::string vuapi trim_string_A(
-  const std::string& string, const trim_type& type, const std::string& chars)
-{
-  return TrimStringT<std::string>(string, type, chars);
-}
+private:
+  static size_t bucket(const char_t c)
+  {
+    return size_t(uchar_t(c)) & 0xFF;
+  }
 
-std::wstring vuapi trim_string_W(
-  const std::wstring& string, const trim_type& type, const std::wstring& chars)
-{
-  return TrimStringT<std::wstring>(string, type, chars);
-}
+private:
+  std::vector<pattern_t> m_buckets[256];
+};
 
 template <class std_string_t>
-std_string_t replace_string_T(
-  const std_string_t& string, const std_string_t& from, const std_string_t& to)
+std_string_t replace_all_T(const std_string_t& text, const std::map<std_string_t, std_string_t>& replacements)
 {
-  std_string_t result = string;
+  typedef ReplacementTableT<std_string_t> table_t;
+
+  const table_t table(replacements);
+
+  // the matching pass, the matches are recorded and the size of the result is computed
+
+  std::vector<std::pair<size_t, const typename table_t::pattern_t*>> matches;
+  size_t size = text.size();
+
+  for (size_t i = 0; i < text.size();)
+  {
+    const auto pattern = table.match(text.data() + i, text.size() - i);
+    if (pattern == nullptr)
+    {
+      i++;
+      continue;
+    }
+
+    matches.push_back(std::make_pair(i, pattern));
+    size = size - pattern->first->size() + pattern->second->size();
+    i += pattern->first->size();
+  }
+
+  if (matches.empty())
+  {
+    return text;
+  }
+
+  // the building pass, the result is allocated once
+
+  std_string_t result;
+  result.reserve(size);
 
   size_t start = 0;
-  while ((start = result.find(from, start)) != std_string_t::npos)
+  for (const auto& e : matches)
   {
-    result.erase(start, from.length());
-    result.insert(start, to);
-    start += to.length();
+    result.append(text, start, e.first - start);
+    result.append(*e.second->second);
+    start = e.first + e.second->first->size();
   }
 
+  result.append(text, start, std_string_t::npos);
+
   return result;
 }
 
-std::string vuapi replace_string_A(
-  const std::string& text, const std::string& from, const std::string& to)
+std::string vuapi replace_all_A(
+  const std::string& text, const std::map<std::string, std::string>& replacements)
 {
-  return replace_string_T<std::string>(text, from, to);
+  return replace_all_T(text, replacements);
 }
 
-std::wstring vuapi replace_string_W(
-  const std::wstring& text, const std::wstring& from, const std::wstring& to)
+std::wstring vuapi replace_all_W(
+  const std::wstring& text, const std::map<std::wstring, std::wstring>& replacements)
 {
-  return replace_string_T<std::wstring>(text, from, to);
+  return replace_all_T(text, replacements);
 }
 
 template <class std_string_t>
-static bool starts_with_T(const std_string_t& text, const std_string_t& with)
+bool replace_all_in_place_T(std_string_t& text, const std::map<std_string_t, std_string_t>& replacements)
 {
-  return\
-    text.length() >= with.length() &&
-    memcmp(text.c_str(), with.c_str(), sizeof(typename std_string_t::value_type) * with.length()) == 0;
-}
+  for (const auto& e : replacements)
+  {
+    if (e.second.size() > e.first.size() && !e.first.empty())
+    {
+      return false; // the result could be longer than the text
+    }
+  }
 
-bool vuapi starts_with_A(const std::string& text, const std::string& with, bool ignore_case)
-{
-  if (ignore_case)
+  const ReplacementTableT<std_string_t> table(replacements);
+
+  // the result is written behind the reading position, since no replacement is longer than its needle
+
+  auto ptr = &text[0];
+  const auto size = text.size();
+
+  size_t w = 0;
+
+  for (size_t r = 0; r < size;)
   {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(with);
-    return starts_with_T<std::string>(v1, v2);
+    const auto pattern = table.match(ptr + r, size - r);
+    if (pattern == nullptr)
+    {
+      ptr[w++] = ptr[r++];
+      continue;
+    }
+
+    const auto& replacement = *pattern->second;
+    std::char_traits<typename std_string_t::value_type>::copy(ptr + w, replacement.data(), replacement.size());
+    w += replacement.size();
+    r += pattern->first->size();
   }
 
-  return starts_with_T<std::string>(text, with);
+  text.resize(w);
+
+  return true;
 }
 
-bool vuapi starts_with_W(const std::wstring& text, const std::wstring& with, bool ignore_case)
+bool vuapi replace_all_in_place_A(
+  std::string& text, const std::map<std::string, std::string>& replacements)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(with);
-    return starts_with_T<std::wstring>(v1, v2);
-  }
+  return replace_all_in_place_T(text, replacements);
+}
 
-  return starts_with_T<std::wstring>(text, with);
+bool vuapi replace_all_in_place_W(
+  std::wstring& text, const std::map<std::wstring, std::wstring>& replacements)
+{
+  return replace_all_in_place_T(text, replacements);
 }
 
-template <class std_string_t>
-static bool ends_with_T(const std_string_t& text, const std_string_t& with)
+bool vuapi starts_with_A(const std::string& text, const std::string& with, bool ignore_case)
 {
-  return text.length() >= with.length() &&
-    std::equal(text.cend() - with.length(), text.cend(), with.cbegin());
+  return starts_with_view_A(text, with, ignore_case);
 }
 
-bool vuapi ends_with_A(const std::string& text, const std::string& with, bool ignore_case)
+bool vuapi starts_with_W(const std::wstring& text, const std::wstring& with, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(with);
-    return ends_with_T<std::string>(v1, v2);
-  }
+  return starts_with_view_W(text, with, ignore_case);
+}
 
-  return ends_with_T<std::string>(text, with);
+bool vuapi ends_with_A(const std::string& text, const std::string& with, bool ignore_case)
+{
+  return ends_with_view_A(text, with, ignore_case);
 }
 
 bool vuapi ends_with_W(const std::wstring& text, const std::wstring& with, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(with);
-    return ends_with_T<std::wstring>(v1, v2);
-  }
-
-  return ends_with_T<std::wstring>(text, with);
+  return ends_with_view_W(text, with, ignore_case);
 }
 
 bool vuapi contains_string_A(const std::string& text, const std::string& test, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_A(text);
-    const auto v2 = lower_string_A(test);
-    return v1.find(v2) != std::string::npos;
-  }
-
-  return text.find(test) != std::string::npos;
+  return contains_string_view_A(text, test, ignore_case);
 }
 
 bool vuapi contains_string_W(const std::wstring& text, const std::wstring& test, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_W(text);
-    const auto v2 = lower_string_W(test);
-    return v1.find(v2) != std::string::npos;
-  }
-
-  return text.find(test) != std::wstring::npos;
+  return contains_string_view_W(text, test, ignore_case);
 }
 
 bool vuapi compare_string_A(const std::string& vl, const std::string& vr, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_A(vl);
-    const auto v2 = lower_string_A(vr);
-    return v1 == v2;
-  }
-
-  return vl == vr;
+  return compare_string_view_A(vl, vr, ignore_case);
 }
 
 bool vuapi compare_string_W(const std::wstring& vl, const std::wstring& vr, bool ignore_case)
 {
-  if (ignore_case)
-  {
-    const auto v1 = lower_string_W(vl);
-    const auto v2 = lower_string_W(vr);
-    return v1 == v2;
-  }
-
-  return vl == vr;
+  return compare_string_view_W(vl, vr, ignore_case);
 }
 
 std::string vuapi regex_replace_string_A(
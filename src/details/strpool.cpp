@@ -0,0 +1,159 @@
+/**
+ * @file   strpool.cpp
+ * @author Vic P.
+ * @brief  Implementation for String Pool
+ */
+
+#include "Vutils.h"
+#include "strcase.h"
+
+namespace vu
+{
+
+/**
+ * StringPoolT
+ * The strings are stored in the fixed-size chunks that are never moved, so a string of a handle is
+ * read without the lock. The lookup table is keyed by the views of the stored strings.
+ * The empty string (the handle 0) is not stored, so the chunks are only allocated by the first
+ * interned string and an unused pool is cheap (eg. the name pools of a PE file).
+ */
+
+template <typename char_t>
+const typename StringPoolT<char_t>::handle_t StringPoolT<char_t>::INVALID_HANDLE;
+
+template <typename char_t>
+size_t StringPoolT<char_t>::Hasher::operator()(const string_view_t& v) const
+{
+  // FNV-1a, the characters are folded the same way as equal_ignore_case
+
+  uint64 hash = 14695981039346656037ULL;
+
+  for (const auto c : v)
+  {
+    hash ^= uint64(ignore_case ? fold_case(c) : c);
+    hash *= 1099511628211ULL;
+  }
+
+  return size_t(hash);
+}
+
+template <typename char_t>
+bool StringPoolT<char_t>::Equaler::operator()(const string_view_t& l, const string_view_t& r) const
+{
+  if (l.size() != r.size())
+  {
+    return false;
+  }
+
+  return ignore_case ? equal_ignore_case(l.data(), r.data(), l.size()) : l == r;
+}
+
+template <typename char_t>
+StringPoolT<char_t>::StringPoolT(const bool ignore_case)
+  : m_ignore_case(ignore_case)
+  , m_size(1) // the handle 0
+  , m_handles(0, Hasher(ignore_case), Equaler(ignore_case))
+{
+}
+
+template <typename char_t>
+StringPoolT<char_t>::~StringPoolT()
+{
+}
+
+template <typename char_t>
+typename StringPoolT<char_t>::handle_t StringPoolT<char_t>::intern(const string_view_t& string)
+{
+  if (string.empty())
+  {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_handles.find(string);
+  if (it != m_handles.end())
+  {
+    return it->second;
+  }
+
+  const auto handle = m_size;
+  if (handle / CHUNK_SIZE >= MAX_CHUNKS) // the chunk table is fixed, so the lock-free get() is safe
+  {
+    return INVALID_HANDLE;
+  }
+
+  if (m_chunks == nullptr)
+  {
+    m_chunks.reset(new std::unique_ptr<std_string_t[]>[MAX_CHUNKS]);
+  }
+
+  auto& chunk = m_chunks[handle / CHUNK_SIZE];
+  if (chunk == nullptr)
+  {
+    chunk.reset(new std_string_t[CHUNK_SIZE]);
+  }
+
+  auto& stored = chunk[handle % CHUNK_SIZE];
+  stored.assign(string.data(), string.size());
+
+  m_handles.insert(std::make_pair(string_view_t(stored), handle));
+  m_size++;
+
+  return handle;
+}
+
+template <typename char_t>
+typename StringPoolT<char_t>::handle_t StringPoolT<char_t>::find(const string_view_t& string) const
+{
+  if (string.empty())
+  {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lg(m_mutex);
+
+  auto it = m_handles.find(string);
+  return it != m_handles.end() ? it->second : INVALID_HANDLE;
+}
+
+template <typename char_t>
+const typename StringPoolT<char_t>::std_string_t& StringPoolT<char_t>::get(const handle_t handle) const
+{
+  if (handle == 0)
+  {
+    return m_empty;
+  }
+
+  assert(handle < MAX_CHUNKS * CHUNK_SIZE && m_chunks != nullptr && m_chunks[handle / CHUNK_SIZE] != nullptr);
+  return m_chunks[handle / CHUNK_SIZE][handle % CHUNK_SIZE];
+}
+
+template <typename char_t>
+size_t StringPoolT<char_t>::size() const
+{
+  std::lock_guard<std::mutex> lg(m_mutex);
+  return m_size;
+}
+
+template <typename char_t>
+bool StringPoolT<char_t>::ignore_case() const
+{
+  return m_ignore_case;
+}
+
+template <typename char_t>
+StringPoolT<char_t>& StringPoolT<char_t>::global(const bool ignore_case)
+{
+  // the function-local statics, so the pools are ready for the other static objects
+
+  static StringPoolT pool(false);
+  static StringPoolT pool_ignore_case(true);
+
+  return ignore_case ? pool_ignore_case : pool;
+}
+
+template class StringPoolT<char>;
+template class StringPoolT<wchar>;
+
+} // namespace vu
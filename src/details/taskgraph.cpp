@@ -0,0 +1,565 @@
+/**
+ * @file   taskgraph.cpp
+ * @author Vic P.
+ * @brief  Implementation for Task Graph
+ */
+
+#include "Vutils.h"
+
+#include <stdexcept>
+
+namespace vu
+{
+
+typedef TaskGraph::node_t node_t;
+
+const node_t TaskGraph::INVALID_NODE;
+
+/**
+ * TaskGraphNode
+ */
+
+struct TaskGraphNode
+{
+  std::string name;
+  fn_task_t fn;
+  TaskGraph::fn_node_t fn_dynamic;
+  std::vector<node_t> successors;
+  size_t n_predecessors;
+
+  std::atomic<size_t> n_waiting; // the predecessors that are not done yet in this run
+  std::atomic<size_t> n_pending; // the task itself and its sub-tasks that are not done yet
+
+  bool started;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+
+  TaskGraphNode(const std::string& name) : name(name), n_predecessors(0), n_waiting(0), n_pending(0), started(false) {}
+};
+
+/**
+ * TaskGraphImpl
+ */
+
+class TaskGraphImpl
+{
+public:
+  TaskGraphImpl() : m_timing(false), m_timed(false), m_running(false), m_cancelled(false), m_remaining(0), m_ptr_pool(nullptr), m_sorted(true) {}
+
+  virtual ~TaskGraphImpl()
+  {
+    assert(!m_running.load() && "the task graph is destroyed while running");
+  }
+
+  node_t add(const std::string& name, fn_task_t&& fn, TaskGraph::fn_node_t&& fn_dynamic)
+  {
+    assert(!m_running.load());
+
+    std::unique_ptr<TaskGraphNode> ptr_node(new TaskGraphNode(name));
+    ptr_node->fn = std::move(fn);
+    ptr_node->fn_dynamic = std::move(fn_dynamic);
+
+    m_nodes.push_back(std::move(ptr_node));
+    m_sorted = false;
+    m_timed = false;
+
+    return m_nodes.size() - 1;
+  }
+
+  void precede(node_t node, node_t successor)
+  {
+    assert(!m_running.load());
+    assert(node < m_nodes.size() && successor < m_nodes.size());
+
+    m_nodes[node]->successors.push_back(successor);
+    m_nodes[successor]->n_predecessors++;
+
+    m_sorted = false;
+    m_timed = false;
+  }
+
+  void clear()
+  {
+    assert(!m_running.load());
+
+    m_nodes.clear();
+    m_order.clear();
+    m_roots.clear();
+    m_sorted = true;
+    m_timed = false;
+  }
+
+  size_t size() const
+  {
+    return m_nodes.size();
+  }
+
+  const std::string& name(node_t node) const
+  {
+    assert(node < m_nodes.size());
+    return m_nodes[node]->name;
+  }
+
+  bool acyclic()
+  {
+    this->sort();
+    return m_order.size() == m_nodes.size();
+  }
+
+  bool running() const
+  {
+    return m_running.load();
+  }
+
+  void enable_timing(bool state)
+  {
+    assert(!m_running.load());
+    m_timing = state;
+  }
+
+  TaskFutureT<void> run_async(ThreadPool& pool)
+  {
+    std::shared_ptr<TaskStateT<void>> ptr_state(new TaskStateT<void>(&pool));
+
+    if (!this->acyclic())
+    {
+      ptr_state->set_exception(std::make_exception_ptr(std::logic_error("the task graph has a cycle")));
+      return TaskFutureT<void>(ptr_state);
+    }
+
+    if (m_running.exchange(true))
+    {
+      ptr_state->set_exception(std::make_exception_ptr(std::logic_error("the task graph is already running")));
+      return TaskFutureT<void>(ptr_state);
+    }
+
+    if (m_nodes.empty())
+    {
+      m_running.store(false);
+      ptr_state->set_value();
+      return TaskFutureT<void>(ptr_state);
+    }
+
+    for (auto& ptr_node : m_nodes)
+    {
+      ptr_node->n_waiting.store(ptr_node->n_predecessors, std::memory_order_relaxed);
+      ptr_node->n_pending.store(1, std::memory_order_relaxed);
+      ptr_node->started = false;
+    }
+
+    m_timed = false;
+    m_cancelled.store(false, std::memory_order_relaxed);
+    m_ptr_exception = nullptr;
+    m_ptr_pool = &pool;
+    m_ptr_state = ptr_state;
+    m_remaining.store(m_nodes.size());
+    m_started = std::chrono::steady_clock::now();
+
+    // the roots are copied since the graph could be completed by the workers before the loop ends
+
+    const auto roots = m_roots;
+
+    for (auto node : roots)
+    {
+      pool.add_task([this, node]() { this->execute(node); });
+    }
+
+    return TaskFutureT<void>(ptr_state);
+  }
+
+  void spawn(node_t node, fn_task_t&& fn)
+  {
+    assert(m_running.load());
+
+    // the spawning task still holds a pending count of the node, so the node can't be done here
+
+    m_nodes[node]->n_pending.fetch_add(1, std::memory_order_relaxed);
+
+    fn_task_t task(std::move(fn));
+
+    m_ptr_pool->add_task([this, node, task]()
+    {
+      if (!m_cancelled.load(std::memory_order_relaxed))
+      {
+        try
+        {
+          task();
+        }
+        catch (...)
+        {
+          this->fail(std::current_exception());
+        }
+      }
+
+      const node_t next = this->finish(node);
+      if (next != TaskGraph::INVALID_NODE)
+      {
+        this->execute(next);
+      }
+    });
+  }
+
+  std::vector<TaskGraph::Timing> timings() const
+  {
+    std::vector<TaskGraph::Timing> result;
+
+    if (!m_timed)
+    {
+      return result;
+    }
+
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+      const auto& node = *m_nodes[i];
+      if (!node.started)
+      {
+        continue;
+      }
+
+      TaskGraph::Timing timing;
+      timing.node = i;
+      timing.name = node.name;
+      timing.start = std::chrono::duration_cast<std::chrono::nanoseconds>(node.start - m_started);
+      timing.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(node.end - node.start);
+      result.push_back(timing);
+    }
+
+    return result;
+  }
+
+  std::vector<node_t> critical_path(std::chrono::nanoseconds* ptr_length) const
+  {
+    std::vector<node_t> result;
+
+    if (ptr_length != nullptr)
+    {
+      *ptr_length = std::chrono::nanoseconds::zero();
+    }
+
+    if (!m_timed || m_nodes.empty())
+    {
+      return result;
+    }
+
+    // the longest path by the durations, in the topological order so the predecessors go first
+
+    std::vector<std::chrono::nanoseconds> lengths(m_nodes.size(), std::chrono::nanoseconds::zero());
+    std::vector<node_t> previous(m_nodes.size(), TaskGraph::INVALID_NODE);
+
+    node_t last = TaskGraph::INVALID_NODE;
+
+    for (auto i : m_order)
+    {
+      const auto& node = *m_nodes[i];
+
+      if (node.started)
+      {
+        lengths[i] += std::chrono::duration_cast<std::chrono::nanoseconds>(node.end - node.start);
+      }
+
+      if (last == TaskGraph::INVALID_NODE || lengths[i] > lengths[last])
+      {
+        last = i;
+      }
+
+      for (auto s : node.successors)
+      {
+        if (previous[s] == TaskGraph::INVALID_NODE || lengths[i] > lengths[s])
+        {
+          lengths[s] = lengths[i];
+          previous[s] = i;
+        }
+      }
+    }
+
+    for (auto i = last; i != TaskGraph::INVALID_NODE; i = previous[i])
+    {
+      result.push_back(i);
+    }
+
+    std::reverse(result.begin(), result.end());
+
+    if (ptr_length != nullptr)
+    {
+      *ptr_length = lengths[last];
+    }
+
+    return result;
+  }
+
+private:
+  void sort()
+  {
+    if (m_sorted)
+    {
+      return;
+    }
+
+    // Kahn's algorithm, the nodes of a cycle are never reached
+
+    const size_t n = m_nodes.size();
+
+    std::vector<size_t> n_waiting(n);
+    m_order.clear();
+    m_order.reserve(n);
+    m_roots.clear();
+
+    for (size_t i = 0; i < n; i++)
+    {
+      n_waiting[i] = m_nodes[i]->n_predecessors;
+      if (n_waiting[i] == 0)
+      {
+        m_order.push_back(i);
+        m_roots.push_back(i);
+      }
+    }
+
+    for (size_t k = 0; k < m_order.size(); k++)
+    {
+      for (auto s : m_nodes[m_order[k]]->successors)
+      {
+        if (--n_waiting[s] == 0)
+        {
+          m_order.push_back(s);
+        }
+      }
+    }
+
+    m_sorted = true;
+  }
+
+  void execute(node_t node)
+  {
+    // the first successor that gets ready is run right here instead of going through the pool
+
+    while (node != TaskGraph::INVALID_NODE)
+    {
+      auto& task = *m_nodes[node];
+
+      if (!m_cancelled.load(std::memory_order_relaxed))
+      {
+        task.started = true;
+
+        if (m_timing)
+        {
+          task.start = std::chrono::steady_clock::now();
+        }
+
+        try
+        {
+          if (task.fn_dynamic)
+          {
+            TaskGraph::Context context(*this, node);
+            task.fn_dynamic(context);
+          }
+          else if (task.fn)
+          {
+            task.fn();
+          }
+        }
+        catch (...)
+        {
+          this->fail(std::current_exception());
+        }
+      }
+
+      node = this->finish(node);
+    }
+  }
+
+  node_t finish(node_t node)
+  {
+    auto& task = *m_nodes[node];
+
+    if (task.n_pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+      return TaskGraph::INVALID_NODE;
+    }
+
+    if (m_timing && task.started)
+    {
+      task.end = std::chrono::steady_clock::now();
+    }
+
+    node_t next = TaskGraph::INVALID_NODE;
+
+    for (auto s : task.successors)
+    {
+      if (m_nodes[s]->n_waiting.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      {
+        continue;
+      }
+
+      if (next == TaskGraph::INVALID_NODE)
+      {
+        next = s;
+      }
+      else
+      {
+        m_ptr_pool->add_task([this, s]() { this->execute(s); });
+      }
+    }
+
+    if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      this->complete(); // the graph may be destroyed after this, so it must be the last access
+    }
+
+    return next;
+  }
+
+  void fail(std::exception_ptr ptr_exception)
+  {
+    if (!m_cancelled.exchange(true))
+    {
+      m_ptr_exception = ptr_exception;
+    }
+  }
+
+  void complete()
+  {
+    auto ptr_state = std::move(m_ptr_state);
+    auto ptr_exception = m_ptr_exception;
+
+    m_timed = m_timing;
+    m_ptr_pool = nullptr;
+    m_running.store(false);
+
+    if (ptr_exception != nullptr)
+    {
+      ptr_state->set_exception(ptr_exception);
+    }
+    else
+    {
+      ptr_state->set_value();
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<TaskGraphNode>> m_nodes;
+
+  bool m_timing;
+  bool m_timed;
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_cancelled;
+  std::atomic<size_t> m_remaining;
+  std::exception_ptr m_ptr_exception;
+
+  ThreadPool* m_ptr_pool;
+  std::shared_ptr<TaskStateT<void>> m_ptr_state;
+  std::chrono::steady_clock::time_point m_started;
+
+  bool m_sorted;
+  std::vector<node_t> m_order;
+  std::vector<node_t> m_roots;
+};
+
+/**
+ * TaskGraph::Context
+ */
+
+TaskGraph::Context::Context(TaskGraphImpl& graph, node_t node) : m_ptr_graph(&graph), m_node(node)
+{
+}
+
+node_t TaskGraph::Context::node() const
+{
+  return m_node;
+}
+
+void TaskGraph::Context::spawn(fn_task_t&& fn)
+{
+  m_ptr_graph->spawn(m_node, std::move(fn));
+}
+
+/**
+ * TaskGraph
+ */
+
+TaskGraph::TaskGraph() : m_ptr_impl(new TaskGraphImpl)
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+  delete m_ptr_impl;
+}
+
+node_t TaskGraph::add(const std::string& name, fn_task_t fn)
+{
+  return m_ptr_impl->add(name, std::move(fn), fn_node_t());
+}
+
+node_t TaskGraph::add_dynamic(const std::string& name, fn_node_t fn)
+{
+  return m_ptr_impl->add(name, fn_task_t(), std::move(fn));
+}
+
+void TaskGraph::precede(node_t node, node_t successor)
+{
+  m_ptr_impl->precede(node, successor);
+}
+
+void TaskGraph::succeed(node_t node, node_t predecessor)
+{
+  m_ptr_impl->precede(predecessor, node);
+}
+
+void TaskGraph::clear()
+{
+  m_ptr_impl->clear();
+}
+
+size_t TaskGraph::size() const
+{
+  return m_ptr_impl->size();
+}
+
+const std::string& TaskGraph::name(node_t node) const
+{
+  return m_ptr_impl->name(node);
+}
+
+bool TaskGraph::acyclic() const
+{
+  return m_ptr_impl->acyclic();
+}
+
+bool TaskGraph::running() const
+{
+  return m_ptr_impl->running();
+}
+
+bool TaskGraph::run(ThreadPool* ptr_pool)
+{
+  if (!m_ptr_impl->acyclic())
+  {
+    return false;
+  }
+
+  this->run_async(ptr_pool).get();
+
+  return true;
+}
+
+TaskFutureT<void> TaskGraph::run_async(ThreadPool* ptr_pool)
+{
+  return m_ptr_impl->run_async(ptr_pool != nullptr ? *ptr_pool : ThreadPool::global());
+}
+
+void TaskGraph::enable_timing(bool state)
+{
+  m_ptr_impl->enable_timing(state);
+}
+
+std::vector<TaskGraph::Timing> TaskGraph::timings() const
+{
+  return m_ptr_impl->timings();
+}
+
+std::vector<node_t> TaskGraph::critical_path(std::chrono::nanoseconds* ptr_length) const
+{
+  return m_ptr_impl->critical_path(ptr_length);
+}
+
+} // namespace vu
@@ -6,6 +6,7 @@
 
 #include "Vutils.h"
 #include "defs.h"
+#include "threadpool.h"
 
 #include VU_3RD_INCL(TP11/include/threadpool11/threadpool11.h)
 
@@ -14,14 +15,271 @@ using namespace threadpool11;
 namespace vu
 {
 
-ThreadPool::ThreadPool(size_t n_threads)
+/**
+ * ThreadPoolCounters
+ */
+
+ThreadPoolCounters::ThreadPoolCounters(const bool shared)
+  : tasks_submitted(0), tasks_completed(0), steals(0), idle_time(0), shared(shared)
+{
+  for (size_t i = 0; i < ThreadPoolStatistics::NUM_BUCKETS; i++)
+  {
+    queue_wait_histogram[i].store(0, std::memory_order_relaxed);
+    run_time_histogram[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void ThreadPoolCounters::collect(ThreadPoolStatistics& stats) const
+{
+  stats.tasks_submitted += tasks_submitted.load(std::memory_order_relaxed);
+  stats.tasks_completed += tasks_completed.load(std::memory_order_relaxed);
+  stats.steals += steals.load(std::memory_order_relaxed);
+
+  for (size_t i = 0; i < ThreadPoolStatistics::NUM_BUCKETS; i++)
+  {
+    stats.queue_wait_histogram[i] += queue_wait_histogram[i].load(std::memory_order_relaxed);
+    stats.run_time_histogram[i] += run_time_histogram[i].load(std::memory_order_relaxed);
+  }
+}
+
+int64 ThreadPoolCounters::now()
+{
+  const auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+}
+
+/**
+ * ThreadPoolStatistics
+ */
+
+const size_t ThreadPoolStatistics::NUM_BUCKETS;
+
+ThreadPoolStatistics::ThreadPoolStatistics() : tasks_submitted(0), tasks_completed(0), steals(0)
+{
+  memset(queue_wait_histogram, 0, sizeof(queue_wait_histogram));
+  memset(run_time_histogram, 0, sizeof(run_time_histogram));
+}
+
+uint64 ThreadPoolStatistics::tasks_pending() const
+{
+  return tasks_submitted > tasks_completed ? tasks_submitted - tasks_completed : 0;
+}
+
+std::chrono::nanoseconds ThreadPoolStatistics::percentile(const uint64 (&histogram)[NUM_BUCKETS], double percent)
+{
+  uint64 total = 0;
+
+  for (size_t i = 0; i < NUM_BUCKETS; i++)
+  {
+    total += histogram[i];
+  }
+
+  if (total == 0)
+  {
+    return std::chrono::nanoseconds::zero();
+  }
+
+  const auto target = uint64(std::ceil(double(total) * (std::min)((std::max)(percent, 0.), 100.) / 100.));
+
+  uint64 count = 0;
+  size_t i = 0;
+
+  for (; i < NUM_BUCKETS - 1; i++)
+  {
+    count += histogram[i];
+    if (count >= target && count != 0)
+    {
+      break;
+    }
+  }
+
+  return std::chrono::nanoseconds(int64(1) << (i + 1));
+}
+
+/**
+ * SharedQueuePool
+ * The threadpool11 backend. Its workers are not known, so its counters are shared by all of them.
+ */
+
+class SharedQueuePool : public ThreadPoolImpl
+{
+public:
+  SharedQueuePool(const size_t n_threads) : m_pool(n_threads), m_counters(true), m_timing(false) {}
+
+  virtual void add_task(fn_task_t&& fn, size_t numa_node)
+  {
+    m_counters.add(m_counters.tasks_submitted);
+
+    const auto enqueued = m_timing.load(std::memory_order_relaxed) ? ThreadPoolCounters::now() : 0;
+
+    m_pool.postWork(Worker::WorkType(CountedTask(std::move(fn), m_counters, enqueued)));
+  }
+
+  virtual void wait_all()
+  {
+    m_pool.waitAll();
+  }
+
+  virtual bool run_pending_task()
+  {
+    return false;
+  }
+
+  virtual bool in_worker_thread() const
+  {
+    return false; // not known by threadpool11
+  }
+
+  virtual size_t worker_index() const
+  {
+    return size_t(-1);
+  }
+
+  virtual size_t local_task_count() const
+  {
+    return m_pool.getWorkQueueCount();
+  }
+
+  virtual size_t numa_node_count() const
+  {
+    return 1;
+  }
+
+  virtual size_t numa_node() const
+  {
+    return size_t(-1);
+  }
+
+  virtual size_t worker_count() const
+  {
+    return m_pool.getWorkerCount();
+  }
+
+  virtual size_t work_queue_count() const
+  {
+    return m_pool.getWorkQueueCount();
+  }
+
+  virtual size_t active_worker_count() const
+  {
+    return m_pool.getActiveWorkerCount();
+  }
+
+  virtual size_t inactive_worker_count() const
+  {
+    return m_pool.getInactiveWorkerCount();
+  }
+
+  virtual void statistics(ThreadPoolStatistics& stats) const
+  {
+    m_counters.collect(stats);
+  }
+
+  virtual void enable_timing(bool state)
+  {
+    m_timing.store(state, std::memory_order_relaxed);
+  }
+
+private:
+  struct CountedTask
+  {
+    fn_task_t fn;
+    ThreadPoolCounters* ptr_counters;
+    int64 enqueued;
+
+    CountedTask(fn_task_t&& fn, ThreadPoolCounters& counters, const int64 enqueued)
+      : fn(std::move(fn)), ptr_counters(&counters), enqueued(enqueued) {}
+
+    CountedTask(const CountedTask& right)
+      : fn(right.fn), ptr_counters(right.ptr_counters), enqueued(right.enqueued) {}
+
+    CountedTask(CountedTask&& right)
+      : fn(std::move(right.fn)), ptr_counters(right.ptr_counters), enqueued(right.enqueued) {}
+
+    void operator()()
+    {
+      auto& counters = *ptr_counters;
+
+      if (enqueued != 0)
+      {
+        const auto started = ThreadPoolCounters::now();
+        counters.add_time(counters.queue_wait_histogram, started - enqueued);
+        fn();
+        counters.add_time(counters.run_time_histogram, ThreadPoolCounters::now() - started);
+      }
+      else
+      {
+        fn();
+      }
+
+      counters.add(counters.tasks_completed);
+    }
+  };
+
+  mutable Pool m_pool;
+  ThreadPoolCounters m_counters;
+  std::atomic<bool> m_timing;
+};
+
+ThreadPoolImpl* create_shared_queue_pool(const size_t n_threads)
 {
-  if (n_threads == MAX_NTHREADS)
+  return new SharedQueuePool(n_threads);
+}
+
+/**
+ * ThreadPool
+ */
+
+ThreadPoolOptions::ThreadPoolOptions(
+  size_t n_threads, thread_pool_type type, thread_pool_affinity affinity, bool numa_sub_pools)
+  : n_threads(n_threads), type(type), affinity(affinity), numa_sub_pools(numa_sub_pools)
+{
+}
+
+ThreadPool::ThreadPool(size_t n_threads, thread_pool_type type) : m_type(type), m_ptr_impl(nullptr)
+{
+  this->initialize(ThreadPoolOptions(n_threads, type));
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options) : m_type(options.type), m_ptr_impl(nullptr)
+{
+  this->initialize(options);
+}
+
+void ThreadPool::initialize(ThreadPoolOptions options)
+{
+  if (options.n_threads == size_t(MAX_NTHREADS) || options.n_threads == 0)
   {
-    n_threads = std::thread::hardware_concurrency();
+    options.n_threads = (std::max)(std::thread::hardware_concurrency(), 1U);
+
+    // hardware_concurrency() counts the processor group of the process only, a pool that places
+    // its workers by itself can use the processors of all groups
+
+    if (options.type == thread_pool_type::TP_WORK_STEALING &&
+       (options.affinity != thread_pool_affinity::TA_NONE || options.numa_sub_pools))
+    {
+      size_t n_processors = 0;
+
+      for (const auto& node : get_numa_nodes())
+      {
+        for (auto mask = node.processors.mask; mask != 0; mask &= mask - 1)
+        {
+          n_processors++;
+        }
+      }
+
+      options.n_threads = (std::max)(options.n_threads, n_processors);
+    }
   }
 
-  m_ptr_impl = new Pool(n_threads);
+  if (m_type == thread_pool_type::TP_SHARED_QUEUE)
+  {
+    m_ptr_impl = create_shared_queue_pool(options.n_threads);
+  }
+  else
+  {
+    m_ptr_impl = create_work_stealing_pool(options);
+  }
 }
 
 ThreadPool::~ThreadPool()
@@ -29,34 +287,101 @@ ThreadPool::~ThreadPool()
   delete m_ptr_impl;
 }
 
+thread_pool_type ThreadPool::type() const
+{
+  return m_type;
+}
+
 void ThreadPool::add_task(fn_task_t&& fn)
 {
-  m_ptr_impl->postWork(static_cast<Worker::WorkType>(fn));
+  m_ptr_impl->add_task(std::move(fn), size_t(ANY_NUMA_NODE));
+}
+
+void ThreadPool::add_task(fn_task_t&& fn, size_t numa_node)
+{
+  m_ptr_impl->add_task(std::move(fn), numa_node);
 }
 
 void ThreadPool::launch()
 {
-  m_ptr_impl->waitAll();
+  m_ptr_impl->wait_all();
+}
+
+bool ThreadPool::run_pending_task()
+{
+  return m_ptr_impl->run_pending_task();
+}
+
+bool ThreadPool::in_worker_thread() const
+{
+  return m_ptr_impl->in_worker_thread();
+}
+
+size_t ThreadPool::worker_index() const
+{
+  return m_ptr_impl->worker_index();
+}
+
+size_t ThreadPool::local_task_count() const
+{
+  return m_ptr_impl->local_task_count();
+}
+
+static std::once_flag g_global_thread_pool_flag;
+static ThreadPool* g_ptr_global_thread_pool = nullptr;
+
+ThreadPool& ThreadPool::global()
+{
+  // never destroyed, joining the workers while the process is exiting (eg. in DllMain) could hang
+
+  std::call_once(g_global_thread_pool_flag, []()
+  {
+    g_ptr_global_thread_pool = new ThreadPool();
+  });
+
+  return *g_ptr_global_thread_pool;
+}
+
+size_t ThreadPool::numa_node_count() const
+{
+  return m_ptr_impl->numa_node_count();
+}
+
+size_t ThreadPool::numa_node() const
+{
+  return m_ptr_impl->numa_node();
 }
 
 size_t ThreadPool::worker_count() const
 {
-  return m_ptr_impl->getWorkerCount();
+  return m_ptr_impl->worker_count();
 }
 
 size_t ThreadPool::work_queue_count() const
 {
-  return m_ptr_impl->getWorkQueueCount();
+  return m_ptr_impl->work_queue_count();
 }
 
 size_t ThreadPool::active_worker_count() const
 {
-  return m_ptr_impl->getActiveWorkerCount();
+  return m_ptr_impl->active_worker_count();
 }
 
 size_t ThreadPool::inactive_worker_count() const
 {
-  return m_ptr_impl->getInactiveWorkerCount();
+  return m_ptr_impl->inactive_worker_count();
+}
+
+ThreadPoolStatistics ThreadPool::statistics() const
+{
+  ThreadPoolStatistics result;
+  m_ptr_impl->statistics(result);
+  return result;
+}
+
+void ThreadPool::enable_timing(bool state)
+{
+  m_ptr_impl->enable_timing(state);
 }
 
-} // namespace vu
\ No newline at end of file
+} // namespace vu
@@ -0,0 +1,143 @@
+/**
+ * @file   threadpool.h
+ * @author Vic P.
+ * @brief  Header for Thread Pool
+ */
+
+#pragma once
+
+#include "Vutils.h"
+
+namespace vu
+{
+
+/**
+ * ThreadPoolImpl
+ * The scheduler behind a ThreadPool, one per thread_pool_type.
+ */
+
+class ThreadPoolImpl
+{
+public:
+  virtual ~ThreadPoolImpl() {}
+
+  virtual void add_task(fn_task_t&& fn, size_t numa_node) = 0;
+  virtual void wait_all() = 0;
+
+  virtual bool run_pending_task() = 0;
+  virtual bool in_worker_thread() const = 0;
+  virtual size_t worker_index() const = 0;
+  virtual size_t local_task_count() const = 0;
+
+  virtual size_t numa_node_count() const = 0;
+  virtual size_t numa_node() const = 0;
+
+  virtual size_t worker_count() const = 0;
+  virtual size_t work_queue_count() const = 0;
+  virtual size_t active_worker_count() const = 0;
+  virtual size_t inactive_worker_count() const = 0;
+
+  virtual void statistics(ThreadPoolStatistics& stats) const = 0;
+  virtual void enable_timing(bool state) = 0;
+};
+
+/**
+ * ThreadPoolCounters
+ * The counters of a worker. They are written only by the worker so a relaxed load and store is
+ * enough to update them, the counters that are shared by the threads outside of the pool use
+ * an atomic add instead.
+ */
+
+struct ThreadPoolCounters
+{
+  std::atomic<uint64> tasks_submitted;
+  char padding[64]; // the submitters' and the runners' side on different cache lines
+  std::atomic<uint64> tasks_completed;
+  std::atomic<uint64> steals;
+  std::atomic<uint64> idle_time; // ns
+  std::atomic<uint64> queue_wait_histogram[ThreadPoolStatistics::NUM_BUCKETS];
+  std::atomic<uint64> run_time_histogram[ThreadPoolStatistics::NUM_BUCKETS];
+  bool shared;
+
+  ThreadPoolCounters(const bool shared = false);
+
+  void add(std::atomic<uint64>& counter, const uint64 value = 1)
+  {
+    if (shared)
+    {
+      counter.fetch_add(value, std::memory_order_relaxed);
+    }
+    else
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+  }
+
+  void add_time(std::atomic<uint64>* histogram, const int64 ns)
+  {
+    this->add(histogram[time_bucket(ns)]);
+  }
+
+  /**
+   * Adds the counters to the totals and the histograms of the snapshot.
+   */
+  void collect(ThreadPoolStatistics& stats) const;
+
+  static size_t time_bucket(const int64 ns)
+  {
+    auto v = ns > 0 ? uint64(ns) : 0; // floor(log2(v)) by halves
+
+    size_t i = 0;
+
+    for (size_t shift = 32; shift != 0; shift /= 2)
+    {
+      if ((v >> shift) != 0)
+      {
+        v >>= shift;
+        i += shift;
+      }
+    }
+
+    return (std::min)(i, ThreadPoolStatistics::NUM_BUCKETS - 1);
+  }
+
+  static int64 now(); // ns
+
+private:
+  ThreadPoolCounters(const ThreadPoolCounters&);
+  ThreadPoolCounters& operator=(const ThreadPoolCounters&);
+};
+
+ThreadPoolImpl* create_shared_queue_pool(const size_t n_threads);
+ThreadPoolImpl* create_work_stealing_pool(const ThreadPoolOptions& options);
+
+/**
+ * ProcessorSet
+ * A set of logical processors in a processor group, as GROUP_AFFINITY.
+ */
+
+struct ProcessorSet
+{
+  ushort group;
+  ulongptr mask;
+};
+
+struct NumaNodeInfo
+{
+  ulong id;
+  ProcessorSet processors;
+};
+
+/**
+ * Gets the NUMA nodes that have any processor, there is at least one node.
+ */
+std::vector<NumaNodeInfo> get_numa_nodes();
+
+/**
+ * Gets the NUMA node of the processor that runs the calling thread.
+ */
+ulong get_current_numa_node();
+
+bool set_current_thread_affinity(const ProcessorSet& processors);
+
+} // namespace vu
@@ -0,0 +1,907 @@
+/**
+ * @file   unicode.cpp
+ * @author Vic P.
+ * @brief  Implementation for Unicode Transcoding
+ */
+
+#include "Vutils.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VU_UNICODE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define VU_UNICODE_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace vu
+{
+
+/**
+ * The ASCII blocks, 16 bytes or 16 UTF-16 code units at once
+ */
+
+static inline bool is_ascii_block(const byte* p)
+{
+#ifdef VU_UNICODE_SSE2
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm_movemask_epi8(v) == 0;
+#else
+  uint64 v[2];
+  memcpy(v, p, sizeof(v));
+  return ((v[0] | v[1]) & 0x8080808080808080ULL) == 0;
+#endif
+}
+
+template <typename unit_t>
+static inline bool is_ascii_block(const unit_t* p)
+{
+#ifdef VU_UNICODE_SSE2
+  if (sizeof(unit_t) == 2)
+  {
+    const __m128i mask = _mm_set1_epi16(short(0xFF80));
+    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+    const __m128i v  = _mm_and_si128(_mm_or_si128(v0, v1), mask);
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128())) == 0xFFFF;
+  }
+#endif
+
+  uint32 v = 0;
+  for (size_t i = 0; i < 16; i++)
+  {
+    v |= uint32(p[i]);
+  }
+
+  return v < 0x80;
+}
+
+template <typename unit_t>
+static inline void widen_ascii_block(const byte* p, unit_t* d)
+{
+#ifdef VU_UNICODE_SSE2
+  if (sizeof(unit_t) == 2)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+    return;
+  }
+#endif
+
+  for (size_t i = 0; i < 16; i++)
+  {
+    d[i] = unit_t(p[i]);
+  }
+}
+
+template <typename unit_t>
+static inline void narrow_ascii_block(const unit_t* p, char* d)
+{
+#ifdef VU_UNICODE_SSE2
+  if (sizeof(unit_t) == 2)
+  {
+    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_packus_epi16(v0, v1));
+    return;
+  }
+#endif
+
+  for (size_t i = 0; i < 16; i++)
+  {
+    d[i] = char(p[i]);
+  }
+}
+
+/**
+ * The code points
+ */
+
+static const uint32 MAX_CODE_POINT = 0x10FFFF;
+
+static inline bool is_surrogate(const uint32 cp)
+{
+  return cp >= 0xD800 && cp <= 0xDFFF;
+}
+
+// Decodes an UTF-8 sequence, returns its length or 0 if it's ill-formed (truncated, overlong, surrogate, out of range)
+
+static inline size_t utf8_decode(const byte* p, const byte* e, uint32& cp)
+{
+  const uint32 c = p[0];
+
+  if (c < 0x80)
+  {
+    cp = c;
+    return 1;
+  }
+
+  if (c < 0xC2) // a continuation byte or an overlong 2-byte form
+  {
+    return 0;
+  }
+
+  if (c < 0xE0)
+  {
+    if (e - p < 2 || (p[1] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+
+    cp = ((c & 0x1F) << 6) | (p[1] & 0x3F);
+    return 2;
+  }
+
+  if (c < 0xF0)
+  {
+    if (e - p < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+
+    cp = ((c & 0x0F) << 12) | (uint32(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+    return cp < 0x800 || is_surrogate(cp) ? 0 : 3;
+  }
+
+  if (c < 0xF5)
+  {
+    if (e - p < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+
+    cp = ((c & 0x07) << 18) | (uint32(p[1] & 0x3F) << 12) | (uint32(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+    return cp < 0x10000 || cp > MAX_CODE_POINT ? 0 : 4;
+  }
+
+  return 0;
+}
+
+static inline size_t utf8_length(const uint32 cp)
+{
+  return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+static inline char* utf8_encode(char* d, const uint32 cp)
+{
+  if (cp < 0x80)
+  {
+    *d++ = char(cp);
+  }
+  else if (cp < 0x800)
+  {
+    *d++ = char(0xC0 | (cp >> 6));
+    *d++ = char(0x80 | (cp & 0x3F));
+  }
+  else if (cp < 0x10000)
+  {
+    *d++ = char(0xE0 | (cp >> 12));
+    *d++ = char(0x80 | ((cp >> 6) & 0x3F));
+    *d++ = char(0x80 | (cp & 0x3F));
+  }
+  else
+  {
+    *d++ = char(0xF0 | (cp >> 18));
+    *d++ = char(0x80 | ((cp >> 12) & 0x3F));
+    *d++ = char(0x80 | ((cp >> 6) & 0x3F));
+    *d++ = char(0x80 | (cp & 0x3F));
+  }
+
+  return d;
+}
+
+// Decodes an UTF-16 (surrogate pair) or an UTF-32 code point, returns its length in units or 0 if it's ill-formed
+
+template <typename unit_t>
+static inline size_t utfx_decode(const unit_t* p, const unit_t* e, uint32& cp)
+{
+  const uint32 c = sizeof(unit_t) == 2 ? uint32(p[0]) & 0xFFFF : uint32(p[0]);
+
+  if (sizeof(unit_t) == 2 && c >= 0xD800 && c <= 0xDBFF)
+  {
+    if (e - p < 2)
+    {
+      return 0;
+    }
+
+    const uint32 c2 = uint32(p[1]) & 0xFFFF;
+    if (c2 < 0xDC00 || c2 > 0xDFFF)
+    {
+      return 0;
+    }
+
+    cp = 0x10000 + ((c - 0xD800) << 10) + (c2 - 0xDC00);
+    return 2;
+  }
+
+  if (is_surrogate(c) || c > MAX_CODE_POINT)
+  {
+    return 0;
+  }
+
+  cp = c;
+  return 1;
+}
+
+template <typename unit_t>
+static inline size_t utfx_length(const uint32 cp)
+{
+  return sizeof(unit_t) == 2 && cp >= 0x10000 ? 2 : 1;
+}
+
+template <typename unit_t>
+static inline unit_t* utfx_encode(unit_t* d, uint32 cp)
+{
+  if (sizeof(unit_t) == 2 && cp >= 0x10000)
+  {
+    cp -= 0x10000;
+    *d++ = unit_t(0xD800 + (cp >> 10));
+    *d++ = unit_t(0xDC00 + (cp & 0x3FF));
+  }
+  else
+  {
+    *d++ = unit_t(cp);
+  }
+
+  return d;
+}
+
+/**
+ * The transcoders, the first pass validates & computes the exact output size,
+ * the second pass writes the output in place. The ASCII runs are processed by blocks.
+ */
+
+template <typename unit_t, typename std_string_t>
+static bool utf8_to_utfx_T(const void* ptr, const size_t size, std_string_t& result)
+{
+  result.clear();
+
+  const auto b = static_cast<const byte*>(ptr);
+  const auto e = b + size;
+
+  size_t length = 0;
+  uint32 cp = 0;
+
+  for (auto p = b; p < e;)
+  {
+    if (e - p >= 16 && is_ascii_block(p))
+    {
+      p += 16;
+      length += 16;
+      continue;
+    }
+
+    const auto n = utf8_decode(p, e, cp);
+    if (n == 0)
+    {
+      return false;
+    }
+
+    p += n;
+    length += utfx_length<unit_t>(cp);
+  }
+
+  if (length == 0)
+  {
+    return true;
+  }
+
+  result.resize(length);
+
+  auto d = &result[0];
+
+  for (auto p = b; p < e;)
+  {
+    if (e - p >= 16 && is_ascii_block(p))
+    {
+      widen_ascii_block(p, d);
+      p += 16;
+      d += 16;
+      continue;
+    }
+
+    p += utf8_decode(p, e, cp);
+    d = utfx_encode(d, cp);
+  }
+
+  return true;
+}
+
+template <typename unit_t>
+static bool utfx_to_utf8_T(const unit_t* ptr, const size_t size, std::string& result)
+{
+  result.clear();
+
+  const auto e = ptr + size;
+
+  size_t length = 0;
+  uint32 cp = 0;
+
+  for (auto p = ptr; p < e;)
+  {
+    if (e - p >= 16 && is_ascii_block(p))
+    {
+      p += 16;
+      length += 16;
+      continue;
+    }
+
+    const auto n = utfx_decode(p, e, cp);
+    if (n == 0)
+    {
+      return false;
+    }
+
+    p += n;
+    length += utf8_length(cp);
+  }
+
+  if (length == 0)
+  {
+    return true;
+  }
+
+  result.resize(length);
+
+  auto d = &result[0];
+
+  for (auto p = ptr; p < e;)
+  {
+    if (e - p >= 16 && is_ascii_block(p))
+    {
+      narrow_ascii_block(p, d);
+      p += 16;
+      d += 16;
+      continue;
+    }
+
+    p += utfx_decode(p, e, cp);
+    d = utf8_encode(d, cp);
+  }
+
+  return true;
+}
+
+template <typename from_t, typename to_t, typename std_string_t>
+static bool utfx_to_utfx_T(const from_t* ptr, const size_t size, std_string_t& result)
+{
+  result.clear();
+
+  const auto e = ptr + size;
+
+  size_t length = 0;
+  uint32 cp = 0;
+
+  for (auto p = ptr; p < e;)
+  {
+    const auto n = utfx_decode(p, e, cp);
+    if (n == 0)
+    {
+      return false;
+    }
+
+    p += n;
+    length += utfx_length<to_t>(cp);
+  }
+
+  if (length == 0)
+  {
+    return true;
+  }
+
+  result.resize(length);
+
+  auto d = &result[0];
+
+  for (auto p = ptr; p < e;)
+  {
+    p += utfx_decode(p, e, cp);
+    d = utfx_encode(d, cp);
+  }
+
+  return true;
+}
+
+/**
+ * The UTF-8 validation
+ * The vectorized one is the lookup algorithm of simdjson (https://arxiv.org/abs/2010.03090).
+ * A block is checked with its 3 previous bytes, the error bits of the 2 first bytes of each sequence
+ * are looked up by their nibbles, the 3rd & 4th continuation bytes are checked by the lead bytes.
+ */
+
+#ifndef VU_UNICODE_SSSE3
+
+static bool utf8_validate_scalar(const byte* ptr, const size_t size)
+{
+  const auto e = ptr + size;
+
+  uint32 cp = 0;
+
+  for (auto p = ptr; p < e;)
+  {
+    if (e - p >= 16 && is_ascii_block(p))
+    {
+      p += 16;
+      continue;
+    }
+
+    const auto n = utf8_decode(p, e, cp);
+    if (n == 0)
+    {
+      return false;
+    }
+
+    p += n;
+  }
+
+  return true;
+}
+
+#else  // VU_UNICODE_SSSE3
+
+static const byte TOO_SHORT      = 1 << 0; // 11______ 0_______ or 11______ 11______
+static const byte TOO_LONG       = 1 << 1; // 0_______ 10______
+static const byte OVERLONG_3     = 1 << 2; // 11100000 100_____
+static const byte TOO_LARGE      = 1 << 3; // 11110100 1001____ or 11110100 101_____ or 11110101+
+static const byte SURROGATE      = 1 << 4; // 11101101 101_____
+static const byte OVERLONG_2     = 1 << 5; // 1100000_ 10______
+static const byte TOO_LARGE_1000 = 1 << 6; // 11110101+ 1000____
+static const byte OVERLONG_4     = 1 << 6; // 11110000 1000____
+static const byte TWO_CONTS      = 1 << 7; // 10______ 10______
+static const byte CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+static inline __m128i utf8_lookup(const __m128i& table, const __m128i& nibbles)
+{
+  return _mm_shuffle_epi8(table, nibbles);
+}
+
+static inline __m128i utf8_high_nibbles(const __m128i& v)
+{
+  return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+static inline __m128i utf8_check_block(const __m128i& input, const __m128i& prev_input)
+{
+  const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+
+  const __m128i byte_1_high = utf8_lookup(_mm_setr_epi8(
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    char(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4)), utf8_high_nibbles(prev1));
+
+  const __m128i byte_1_low = utf8_lookup(_mm_setr_epi8(
+    char(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+    char(CARRY | OVERLONG_2),
+    char(CARRY),
+    char(CARRY),
+    char(CARRY | TOO_LARGE),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    char(CARRY | TOO_LARGE | TOO_LARGE_1000)), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+
+  const __m128i byte_2_high = utf8_lookup(_mm_setr_epi8(
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    char(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+    char(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+    char(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE),
+    char(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE),
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT), utf8_high_nibbles(input));
+
+  const __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  // the 3rd & 4th bytes of the sequences must be the continuation bytes (TWO_CONTS is expected)
+
+  const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+  const __m128i is_third_byte  = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xE0 - 0x80)));
+  const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xF0 - 0x80)));
+  const __m128i must_23_80 = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(char(0x80)));
+
+  return _mm_xor_si128(must_23_80, special_cases);
+}
+
+static inline __m128i utf8_is_incomplete(const __m128i& input)
+{
+  // a lead byte in the last 3 bytes which needs more bytes than the remaining
+
+  const __m128i max_value = _mm_setr_epi8(
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+  return _mm_subs_epu8(input, max_value);
+}
+
+static bool utf8_validate_ssse3(const byte* ptr, const size_t size)
+{
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+
+  size_t i = 0;
+
+  for (; i + 16 <= size; i += 16)
+  {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+
+    if (_mm_movemask_epi8(input) == 0)
+    {
+      error = _mm_or_si128(error, prev_incomplete);
+    }
+    else
+    {
+      error = _mm_or_si128(error, utf8_check_block(input, prev_input));
+      prev_incomplete = utf8_is_incomplete(input);
+    }
+
+    prev_input = input;
+  }
+
+  // the tail is padded by zeros (ASCII), so a truncated sequence at the end is an error
+
+  byte tail[16] = { 0 };
+  memcpy(tail, ptr + i, size - i);
+
+  const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+  error = _mm_or_si128(error, utf8_check_block(input, prev_input));
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif // VU_UNICODE_SSSE3
+
+/**
+ * Unicode Transcoding
+ */
+
+bool vuapi is_ascii(const void* ptr, const size_t size)
+{
+  if (ptr == nullptr)
+  {
+    return size == 0;
+  }
+
+  const auto b = static_cast<const byte*>(ptr);
+
+  size_t i = 0;
+
+  for (; i + 16 <= size; i += 16)
+  {
+    if (!is_ascii_block(b + i))
+    {
+      return false;
+    }
+  }
+
+  for (; i < size; i++)
+  {
+    if (b[i] >= 0x80)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool vuapi utf8_validate(const void* ptr, const size_t size)
+{
+  if (ptr == nullptr)
+  {
+    return size == 0;
+  }
+
+#ifdef VU_UNICODE_SSSE3
+  return utf8_validate_ssse3(static_cast<const byte*>(ptr), size);
+#else  // VU_UNICODE_SSSE3
+  return utf8_validate_scalar(static_cast<const byte*>(ptr), size);
+#endif // VU_UNICODE_SSSE3
+}
+
+bool vuapi utf8_to_utf16(const std::string& text, std::wstring& result)
+{
+  return utf8_to_utfx_T<wchar>(text.data(), text.size(), result);
+}
+
+bool vuapi utf16_to_utf8(const std::wstring& text, std::string& result)
+{
+  return utfx_to_utf8_T(text.data(), text.size(), result);
+}
+
+bool vuapi utf8_to_utf32(const std::string& text, std::u32string& result)
+{
+  return utf8_to_utfx_T<char32_t>(text.data(), text.size(), result);
+}
+
+bool vuapi utf32_to_utf8(const std::u32string& text, std::string& result)
+{
+  return utfx_to_utf8_T(text.data(), text.size(), result);
+}
+
+bool vuapi utf16_to_utf32(const std::wstring& text, std::u32string& result)
+{
+  return utfx_to_utfx_T<wchar, char32_t>(text.data(), text.size(), result);
+}
+
+bool vuapi utf32_to_utf16(const std::u32string& text, std::wstring& result)
+{
+  return utfx_to_utfx_T<char32_t, wchar>(text.data(), text.size(), result);
+}
+
+/**
+ * Encoding Detection
+ */
+
+static inline size_t count_bits(uint32 v)
+{
+  v = v - ((v >> 1) & 0x55555555);
+  v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+  return size_t((((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+}
+
+// Counts the null bytes at the even & the odd offsets
+
+static void count_null_bytes(const byte* ptr, const size_t size, size_t& even, size_t& odd)
+{
+  even = 0;
+  odd  = 0;
+
+  size_t i = 0;
+
+#ifdef VU_UNICODE_SSE2
+  for (; i + 16 <= size; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+    const uint32 mask = uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+    even += count_bits(mask & 0x5555);
+    odd  += count_bits(mask & 0xAAAA);
+  }
+#endif // VU_UNICODE_SSE2
+
+  for (; i < size; i++)
+  {
+    if (ptr[i] == 0)
+    {
+      (i % 2 == 0 ? even : odd)++;
+    }
+  }
+}
+
+// The size without the sequence which is cut at the end of the prefix
+
+static size_t utf8_complete_size(const byte* ptr, const size_t size)
+{
+  size_t i = size;
+  while (i > 0 && size - i < 3 && (ptr[i - 1] & 0xC0) == 0x80)
+  {
+    i--;
+  }
+
+  if (i == 0)
+  {
+    return size;
+  }
+
+  const byte lead = ptr[i - 1];
+  const size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+
+  return size - (i - 1) < length ? i - 1 : size;
+}
+
+EncodingDetection vuapi detect_encoding(const void* data, const size_t size, const size_t max_scan_size)
+{
+  EncodingDetection result;
+
+  if (data == nullptr || size == 0)
+  {
+    return result;
+  }
+
+  const auto p = static_cast<const byte*>(data);
+
+  // the BOMs (UTF-32 LE before UTF-16 LE, they have the same first 2 bytes)
+
+  struct BOM
+  {
+    encoding_type type;
+    size_t size;
+    byte bytes[4];
+  };
+
+  static const BOM boms[] =
+  {
+    { encoding_type::ET_UTF32_LE_BOM, 4, { 0xFF, 0xFE, 0x00, 0x00 } },
+    { encoding_type::ET_UTF32_BE_BOM, 4, { 0x00, 0x00, 0xFE, 0xFF } },
+    { encoding_type::ET_UTF8_BOM,     3, { 0xEF, 0xBB, 0xBF } },
+    { encoding_type::ET_UTF16_LE_BOM, 2, { 0xFF, 0xFE } },
+    { encoding_type::ET_UTF16_BE_BOM, 2, { 0xFE, 0xFF } },
+  };
+
+  for (const auto& bom : boms)
+  {
+    if (size >= bom.size && memcmp(p, bom.bytes, bom.size) == 0)
+    {
+      result.type = bom.type;
+      result.confidence = 1.F;
+      result.bom_size = bom.size;
+      return result;
+    }
+  }
+
+  const auto n = max_scan_size == 0 ? size : (std::min)(size, max_scan_size);
+
+  // the UTF-16 without BOM, the high bytes of the Latin characters are nulls,
+  // so most of the nulls are on one side (the odd offsets for LE, the even offsets for BE)
+
+  size_t even = 0, odd = 0;
+  count_null_bytes(p, n, even, odd);
+
+  const auto pairs = n / 2;
+  if (pairs != 0)
+  {
+    const float even_ratio = float(even) / float(pairs);
+    const float odd_ratio  = float(odd)  / float(pairs);
+
+    if (odd_ratio >= 0.3F && even_ratio * 10.F <= odd_ratio)
+    {
+      result.type = encoding_type::ET_UTF16_LE;
+      result.confidence = (std::min)(1.F, odd_ratio - even_ratio);
+      return result;
+    }
+
+    if (even_ratio >= 0.3F && odd_ratio * 10.F <= even_ratio)
+    {
+      result.type = encoding_type::ET_UTF16_BE;
+      result.confidence = (std::min)(1.F, even_ratio - odd_ratio);
+      return result;
+    }
+  }
+
+  // the text has no null byte, a few are tolerated, more are the binary data
+
+  const float null_ratio = float(even + odd) / float(n);
+  if (null_ratio > 0.01F)
+  {
+    return result;
+  }
+
+  // the valid UTF-8 (ASCII included) or the ANSI
+
+  const auto m = n == size ? n : utf8_complete_size(p, n);
+
+  result.type = encoding_type::ET_UTF8;
+  result.confidence = (utf8_validate(p, m) ? 1.F : 0.5F) - null_ratio;
+
+  return result;
+}
+
+encoding_type vuapi determine_encoding_type(const void* data, const size_t size)
+{
+  return detect_encoding(data, size).type;
+}
+
+/**
+ * ANSI <-> UTF-16
+ * The ASCII text is the same in all ANSI code pages so it's converted directly,
+ * the others are converted by the own transcoder if the ANSI code page is UTF-8 else by Windows.
+ */
+
+std::string vuapi to_string_A(const std::wstring& string)
+{
+  std::string s;
+
+  if (string.empty())
+  {
+    return s;
+  }
+
+  const auto ptr = string.data();
+  const auto size = string.size();
+
+  size_t i = 0;
+  while (i + 16 <= size && is_ascii_block(ptr + i))
+  {
+    i += 16;
+  }
+
+  while (i < size && ptr[i] < 0x80)
+  {
+    i++;
+  }
+
+  if (i == size)
+  {
+    s.resize(size);
+
+    size_t j = 0;
+    for (; j + 16 <= size; j += 16)
+    {
+      narrow_ascii_block(ptr + j, &s[j]);
+    }
+
+    for (; j < size; j++)
+    {
+      s[j] = char(ptr[j]);
+    }
+
+    return s;
+  }
+
+  if (GetACP() == CP_UTF8 && utf16_to_utf8(string, s))
+  {
+    return s;
+  }
+
+  const auto n = WideCharToMultiByte(CP_ACP, WC_COMPOSITECHECK, ptr, int(size), nullptr, 0, nullptr, nullptr);
+  if (n <= 0)
+  {
+    return s;
+  }
+
+  s.resize(n);
+  WideCharToMultiByte(CP_ACP, WC_COMPOSITECHECK, ptr, int(size), &s[0], n, nullptr, nullptr);
+
+  return s;
+}
+
+std::wstring vuapi to_string_W(const std::string& string)
+{
+  std::wstring s;
+
+  if (string.empty())
+  {
+    return s;
+  }
+
+  const auto ptr = reinterpret_cast<const byte*>(string.data());
+  const auto size = string.size();
+
+  if (is_ascii(ptr, size))
+  {
+    s.resize(size);
+
+    size_t j = 0;
+    for (; j + 16 <= size; j += 16)
+    {
+      widen_ascii_block(ptr + j, &s[j]);
+    }
+
+    for (; j < size; j++)
+    {
+      s[j] = wchar(ptr[j]);
+    }
+
+    return s;
+  }
+
+  if (GetACP() == CP_UTF8 && utf8_to_utf16(string, s))
+  {
+    return s;
+  }
+
+  const auto n = MultiByteToWideChar(CP_ACP, 0, string.data(), int(size), nullptr, 0);
+  if (n <= 0)
+  {
+    return s;
+  }
+
+  s.resize(n);
+  MultiByteToWideChar(CP_ACP, 0, string.data(), int(size), &s[0], n);
+
+  return s;
+}
+
+} // namespace vu
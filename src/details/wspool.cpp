@@ -0,0 +1,936 @@
+/**
+ * @file   wspool.cpp
+ * @author Vic P.
+ * @brief  Implementation for Work-Stealing Thread Pool
+ */
+
+#include "Vutils.h"
+#include "threadpool.h"
+
+#include <condition_variable>
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define VU_THREAD_LOCAL __declspec(thread)
+#else
+#define VU_THREAD_LOCAL thread_local
+#endif
+
+namespace vu
+{
+
+struct WSTask
+{
+  fn_task_t fn;
+  std::atomic<WSTask*> ptr_next; // for the injection queue
+  int64 enqueued; // ns, zero if the timing is disabled
+
+  WSTask() : enqueued(0) {}
+  WSTask(fn_task_t&& fn) : fn(std::move(fn)), enqueued(0) {}
+};
+
+/**
+ * WSDeque
+ * The Chase-Lev work-stealing deque (Le et al., Correct and Efficient Work-Stealing for Weak
+ * Memory Models). The owner pushes and pops at the bottom, the thieves steal from the top.
+ * The array grows when it's full, the old arrays are kept until the deque is destroyed because
+ * a thief may still be reading from them.
+ */
+
+class WSDeque
+{
+public:
+  enum steal_result
+  {
+    SR_EMPTY,
+    SR_ABORT, // lost the race to the owner or to another thief, the deque may not be empty
+    SR_OK,
+  };
+
+  WSDeque(const size_t capacity = 1024) : m_top(0), m_bottom(0)
+  {
+    m_ptr_array.store(new Array(capacity), std::memory_order_relaxed);
+  }
+
+  ~WSDeque()
+  {
+    delete m_ptr_array.load(std::memory_order_relaxed);
+
+    for (auto ptr : m_garbage)
+    {
+      delete ptr;
+    }
+  }
+
+  // owner only
+
+  void push(WSTask* ptr_task)
+  {
+    const auto b = m_bottom.load(std::memory_order_relaxed);
+    const auto t = m_top.load(std::memory_order_acquire);
+    auto ptr_array = m_ptr_array.load(std::memory_order_relaxed);
+
+    if (b - t > int64(ptr_array->capacity) - 1)
+    {
+      ptr_array = this->grow(ptr_array, t, b);
+    }
+
+    ptr_array->put(b, ptr_task);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // owner only
+
+  WSTask* pop()
+  {
+    if (m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed))
+    {
+      return nullptr; // nothing to pop, skip the fence
+    }
+
+    const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+    auto ptr_array = m_ptr_array.load(std::memory_order_relaxed);
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) // empty
+    {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    auto ptr_task = ptr_array->get(b);
+
+    if (t == b) // the last one, race against the thieves
+    {
+      if (!m_top.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      {
+        ptr_task = nullptr;
+      }
+
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return ptr_task;
+  }
+
+  // any thread
+
+  steal_result steal(WSTask*& ptr_task)
+  {
+    auto t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto b = m_bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+    {
+      return SR_EMPTY;
+    }
+
+    auto ptr_array = m_ptr_array.load(std::memory_order_acquire);
+    ptr_task = ptr_array->get(t);
+
+    if (!m_top.compare_exchange_strong(
+      t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+      return SR_ABORT;
+    }
+
+    return SR_OK;
+  }
+
+  size_t size() const
+  {
+    const auto b = m_bottom.load(std::memory_order_relaxed);
+    const auto t = m_top.load(std::memory_order_relaxed);
+    return b > t ? size_t(b - t) : 0;
+  }
+
+private:
+  struct Array
+  {
+    size_t capacity; // power of 2
+    std::atomic<WSTask*>* ptr_items;
+
+    Array(const size_t capacity) : capacity(capacity), ptr_items(new std::atomic<WSTask*>[capacity]) {}
+    ~Array() { delete[] ptr_items; }
+
+    WSTask* get(const int64 i) const
+    {
+      return ptr_items[size_t(i) & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void put(const int64 i, WSTask* ptr_task)
+    {
+      ptr_items[size_t(i) & (capacity - 1)].store(ptr_task, std::memory_order_relaxed);
+    }
+  };
+
+  Array* grow(Array* ptr_array, const int64 t, const int64 b)
+  {
+    auto ptr_new_array = new Array(2 * ptr_array->capacity);
+
+    for (auto i = t; i < b; i++)
+    {
+      ptr_new_array->put(i, ptr_array->get(i));
+    }
+
+    m_garbage.push_back(ptr_array);
+    m_ptr_array.store(ptr_new_array, std::memory_order_release);
+
+    return ptr_new_array;
+  }
+
+private:
+  WSDeque(const WSDeque&);
+  WSDeque& operator=(const WSDeque&);
+
+private:
+  std::atomic<int64> m_top;
+  char m_padding[64]; // keep the thieves' and the owner's index on different cache lines
+  std::atomic<int64> m_bottom;
+  std::atomic<Array*> m_ptr_array;
+  std::vector<Array*> m_garbage;
+};
+
+/**
+ * WSInjectionQueue
+ * The queue of the tasks that are added by the threads outside of the pool. It's the intrusive
+ * MPSC queue of D. Vyukov, so a push is a single exchange without any lock and the queue has no
+ * bound. The workers take turns as the consumer by a try-lock, a worker that misses the turn goes
+ * on to steal instead of waiting.
+ */
+
+class WSInjectionQueue
+{
+public:
+  WSInjectionQueue() : m_ptr_head(&m_stub), m_pushed(0), m_ptr_tail(&m_stub), m_consuming(false), m_popped(0)
+  {
+    m_stub.ptr_next.store(nullptr, std::memory_order_relaxed);
+  }
+
+  void push(WSTask* ptr_task)
+  {
+    m_pushed.fetch_add(1, std::memory_order_relaxed);
+    this->link(ptr_task);
+  }
+
+  WSTask* pop()
+  {
+    if (this->empty() || m_consuming.exchange(true, std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+
+    auto ptr_task = this->unlink();
+    if (ptr_task != nullptr)
+    {
+      m_popped.store(m_popped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    m_consuming.store(false, std::memory_order_release);
+
+    return ptr_task;
+  }
+
+  // by the counters, the head can't tell it since the stub is linked again behind the last task
+  // while new tasks may already be queued after it. A push is counted before it's linked, so a
+  // push in flight makes the queue not empty (but pop() may still miss it for a moment).
+
+  bool empty() const
+  {
+    return this->size() == 0;
+  }
+
+  size_t size() const
+  {
+    const auto popped = m_popped.load(std::memory_order_relaxed);
+    const auto pushed = m_pushed.load(std::memory_order_relaxed);
+    return pushed > popped ? pushed - popped : 0;
+  }
+
+private:
+  void link(WSTask* ptr_task)
+  {
+    ptr_task->ptr_next.store(nullptr, std::memory_order_relaxed);
+    auto ptr_prev = m_ptr_head.exchange(ptr_task, std::memory_order_acq_rel);
+    ptr_prev->ptr_next.store(ptr_task, std::memory_order_release);
+  }
+
+  WSTask* unlink()
+  {
+    auto ptr_tail = m_ptr_tail;
+    auto ptr_next = ptr_tail->ptr_next.load(std::memory_order_acquire);
+
+    if (ptr_tail == &m_stub)
+    {
+      if (ptr_next == nullptr)
+      {
+        return nullptr;
+      }
+
+      m_ptr_tail = ptr_tail = ptr_next;
+      ptr_next = ptr_next->ptr_next.load(std::memory_order_acquire);
+    }
+
+    if (ptr_next != nullptr)
+    {
+      m_ptr_tail = ptr_next;
+      return ptr_tail;
+    }
+
+    if (ptr_tail != m_ptr_head.load(std::memory_order_acquire))
+    {
+      return nullptr; // a push is in flight
+    }
+
+    this->link(&m_stub);
+
+    ptr_next = ptr_tail->ptr_next.load(std::memory_order_acquire);
+    if (ptr_next != nullptr)
+    {
+      m_ptr_tail = ptr_next;
+      return ptr_tail;
+    }
+
+    return nullptr;
+  }
+
+private:
+  WSInjectionQueue(const WSInjectionQueue&);
+  WSInjectionQueue& operator=(const WSInjectionQueue&);
+
+private:
+  WSTask m_stub;
+  std::atomic<WSTask*> m_ptr_head;
+  std::atomic<size_t> m_pushed;
+  char m_padding[64]; // keep the producers' and the consumer's side on different cache lines
+  WSTask* m_ptr_tail;
+  std::atomic<bool> m_consuming;
+  std::atomic<size_t> m_popped;
+};
+
+/**
+ * WorkStealingPool
+ * Each worker runs its own deque first (LIFO), then the injection queue, then tries to steal from
+ * random victims. A worker that finds nothing spins for a while before it sleeps. The submitters
+ * wake a sleeper only when there is one, so the hot path has no lock.
+ * With the NUMA sub-pools there is an injection queue per node, a worker looks in its own node
+ * (the injection queue then the deques of its workers) before it looks in the other nodes.
+ */
+
+class WorkStealingPool;
+
+static VU_THREAD_LOCAL WorkStealingPool* t_ptr_ws_pool = nullptr;
+static VU_THREAD_LOCAL size_t t_ws_worker_index = 0;
+static VU_THREAD_LOCAL uint32 t_ws_seed = 0;
+
+class WorkStealingPool : public ThreadPoolImpl
+{
+public:
+  static const int SPIN_ROUNDS = 64;
+
+  WorkStealingPool(const ThreadPoolOptions& options)
+    : m_numa_sub_pools(options.numa_sub_pools)
+    , m_external_counters(true), m_timing(false), m_pending(0), m_sleepers(0), m_stopping(false), m_epoch(0)
+  {
+    const bool placed = options.affinity != thread_pool_affinity::TA_NONE || options.numa_sub_pools;
+
+    std::vector<NumaNodeInfo> numa_nodes;
+
+    if (placed)
+    {
+      numa_nodes = get_numa_nodes();
+    }
+
+    if (m_numa_sub_pools)
+    {
+      for (const auto& e : numa_nodes)
+      {
+        m_nodes.push_back(std::unique_ptr<NodeData>(new NodeData(e.id)));
+      }
+    }
+    else
+    {
+      m_nodes.push_back(std::unique_ptr<NodeData>(new NodeData(0)));
+    }
+
+    // the workers are placed on the nodes in turn, and on the processors of each node in turn
+
+    for (size_t i = 0; i < options.n_threads; i++)
+    {
+      std::unique_ptr<WorkerData> ptr_worker(new WorkerData(uint32(i)));
+
+      if (placed)
+      {
+        const auto& numa_node = numa_nodes[i % numa_nodes.size()];
+
+        ptr_worker->pinned = true;
+        ptr_worker->affinity = numa_node.processors;
+
+        if (options.affinity == thread_pool_affinity::TA_CORE)
+        {
+          ptr_worker->affinity.mask = nth_processor(numa_node.processors.mask, i / numa_nodes.size());
+        }
+
+        if (m_numa_sub_pools)
+        {
+          ptr_worker->node = i % numa_nodes.size();
+        }
+      }
+
+      m_nodes[ptr_worker->node]->workers.push_back(i);
+      m_workers.push_back(std::move(ptr_worker));
+    }
+
+    for (size_t i = 0; i < options.n_threads; i++)
+    {
+      m_workers[i]->thread = std::thread(&WorkStealingPool::worker_main, this, i);
+    }
+  }
+
+  // it must not be destroyed by one of its own tasks, the worker would have to join itself
+
+  virtual ~WorkStealingPool()
+  {
+    assert(t_ptr_ws_pool != this && "Destroying the pool inside a task of the same pool");
+
+    this->wait_all();
+
+    {
+      std::lock_guard<std::mutex> lg(m_sleep_mutex);
+      m_stopping.store(true, std::memory_order_relaxed);
+      m_epoch++;
+    }
+
+    m_sleep_cv.notify_all();
+
+    for (auto& e : m_workers)
+    {
+      e->thread.join();
+    }
+
+    // the remaining tasks (if any) are dropped
+
+    WSTask* ptr_task = nullptr;
+
+    for (auto& e : m_nodes)
+    {
+      while ((ptr_task = e->injection.pop()) != nullptr)
+      {
+        delete ptr_task;
+      }
+    }
+
+    for (auto& e : m_workers)
+    {
+      while ((ptr_task = e->deque.pop()) != nullptr)
+      {
+        delete ptr_task;
+      }
+    }
+  }
+
+  virtual void add_task(fn_task_t&& fn, size_t numa_node)
+  {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    auto ptr_task = new WSTask(std::move(fn));
+
+    if (m_timing.load(std::memory_order_relaxed))
+    {
+      ptr_task->enqueued = ThreadPoolCounters::now();
+    }
+
+    if (t_ptr_ws_pool == this)
+    {
+      auto& worker = *m_workers[t_ws_worker_index];
+      worker.counters.add(worker.counters.tasks_submitted);
+
+      if (numa_node == size_t(ANY_NUMA_NODE) || m_nodes.size() == 1 || m_nodes[worker.node]->id == numa_node)
+      {
+        worker.deque.push(ptr_task);
+      }
+      else
+      {
+        m_nodes[this->submission_node(numa_node)]->injection.push(ptr_task);
+      }
+    }
+    else
+    {
+      m_external_counters.add(m_external_counters.tasks_submitted);
+      m_nodes[this->submission_node(numa_node)]->injection.push(ptr_task);
+    }
+
+    // pairs with the fence in sleep() so either the sleeper sees the task or we see the sleeper
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_sleepers.load(std::memory_order_relaxed) != 0)
+    {
+      {
+        std::lock_guard<std::mutex> lg(m_sleep_mutex);
+        m_epoch++;
+      }
+
+      m_sleep_cv.notify_one();
+    }
+  }
+
+  virtual void wait_all()
+  {
+    assert(t_ptr_ws_pool != this && "Waiting for all tasks inside a task of the same pool");
+
+    std::unique_lock<std::mutex> lk(m_done_mutex);
+    m_done_cv.wait(lk, [this]() { return m_pending.load(std::memory_order_acquire) == 0; });
+  }
+
+  virtual bool run_pending_task()
+  {
+    if (t_ptr_ws_pool == this)
+    {
+      auto ptr_task = this->find_task(t_ws_worker_index);
+      if (ptr_task == nullptr)
+      {
+        return false;
+      }
+
+      this->run(ptr_task, m_workers[t_ws_worker_index]->counters);
+
+      return true;
+    }
+
+    if (t_ws_seed == 0)
+    {
+      t_ws_seed = uint32(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    }
+
+    const auto first = this->submission_node(size_t(ANY_NUMA_NODE));
+    auto ptr_task = this->find_shared_task(first, m_workers.size(), t_ws_seed, m_external_counters);
+
+    if (ptr_task == nullptr)
+    {
+      return false;
+    }
+
+    this->run(ptr_task, m_external_counters);
+
+    return true;
+  }
+
+  virtual bool in_worker_thread() const
+  {
+    return t_ptr_ws_pool == this;
+  }
+
+  virtual size_t worker_index() const
+  {
+    return t_ptr_ws_pool == this ? t_ws_worker_index : size_t(-1);
+  }
+
+  virtual size_t local_task_count() const
+  {
+    return t_ptr_ws_pool == this ? m_workers[t_ws_worker_index]->deque.size() : this->injection_size();
+  }
+
+  virtual size_t numa_node_count() const
+  {
+    return m_nodes.size();
+  }
+
+  virtual size_t numa_node() const
+  {
+    if (!m_numa_sub_pools || t_ptr_ws_pool != this)
+    {
+      return size_t(-1);
+    }
+
+    return m_nodes[m_workers[t_ws_worker_index]->node]->id;
+  }
+
+  virtual size_t worker_count() const
+  {
+    return m_workers.size();
+  }
+
+  virtual size_t work_queue_count() const
+  {
+    size_t result = this->injection_size();
+
+    for (const auto& e : m_workers)
+    {
+      result += e->deque.size();
+    }
+
+    return result;
+  }
+
+  virtual size_t active_worker_count() const
+  {
+    size_t result = 0;
+
+    for (const auto& e : m_workers)
+    {
+      result += e->active.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+
+    return result;
+  }
+
+  virtual size_t inactive_worker_count() const
+  {
+    return m_workers.size() - this->active_worker_count();
+  }
+
+  virtual void statistics(ThreadPoolStatistics& stats) const
+  {
+    stats.workers.reserve(m_workers.size());
+
+    for (const auto& e : m_workers)
+    {
+      const auto& counters = e->counters;
+
+      ThreadPoolStatistics::Worker worker;
+      worker.tasks_submitted = counters.tasks_submitted.load(std::memory_order_relaxed);
+      worker.tasks_completed = counters.tasks_completed.load(std::memory_order_relaxed);
+      worker.steals = counters.steals.load(std::memory_order_relaxed);
+      worker.idle_time = std::chrono::nanoseconds(int64(counters.idle_time.load(std::memory_order_relaxed)));
+      stats.workers.push_back(worker);
+
+      counters.collect(stats);
+    }
+
+    m_external_counters.collect(stats);
+  }
+
+  virtual void enable_timing(bool state)
+  {
+    m_timing.store(state, std::memory_order_relaxed);
+  }
+
+private:
+  struct WorkerData
+  {
+    WSDeque deque;
+    std::thread thread;
+    std::atomic<bool> active;
+    uint32 seed;
+    size_t node; // the index of its sub-pool
+    bool pinned;
+    ProcessorSet affinity;
+    char padding[64]; // the counters are written by this worker only, keep them off the deque's lines
+    ThreadPoolCounters counters;
+
+    WorkerData(const uint32 index) : active(false), seed(2654435761U * (index + 1)), node(0), pinned(false)
+    {
+      affinity.group = 0;
+      affinity.mask  = 0;
+    }
+  };
+
+  struct NodeData
+  {
+    ulong id; // the NUMA node number of the system
+    WSInjectionQueue injection;
+    std::vector<size_t> workers;
+
+    NodeData(const ulong id) : id(id) {}
+  };
+
+  static ulongptr nth_processor(const ulongptr mask, size_t n)
+  {
+    size_t count = 0;
+
+    for (auto bits = mask; bits != 0; bits &= bits - 1)
+    {
+      count++;
+    }
+
+    n %= count;
+
+    for (auto bits = mask; bits != 0; bits &= bits - 1)
+    {
+      if (n-- == 0)
+      {
+        return bits & (~bits + 1); // the lowest bit
+      }
+    }
+
+    return mask;
+  }
+
+  // the sub-pool of the hinted node, else of the node that runs the calling thread
+
+  size_t submission_node(const size_t numa_node) const
+  {
+    if (m_nodes.size() == 1)
+    {
+      return 0;
+    }
+
+    if (numa_node != size_t(ANY_NUMA_NODE))
+    {
+      for (size_t i = 0; i < m_nodes.size(); i++)
+      {
+        if (m_nodes[i]->id == numa_node)
+        {
+          return i;
+        }
+      }
+    }
+
+    const auto current = get_current_numa_node();
+
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+      if (m_nodes[i]->id == current)
+      {
+        return i;
+      }
+    }
+
+    return 0;
+  }
+
+  bool injection_empty() const
+  {
+    for (const auto& e : m_nodes)
+    {
+      if (!e->injection.empty())
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  size_t injection_size() const
+  {
+    size_t result = 0;
+
+    for (const auto& e : m_nodes)
+    {
+      result += e->injection.size();
+    }
+
+    return result;
+  }
+
+  void worker_main(const size_t index)
+  {
+    t_ptr_ws_pool = this;
+    t_ws_worker_index = index;
+    m_workers[index]->active.store(true, std::memory_order_relaxed);
+
+    auto& worker = *m_workers[index];
+
+    if (worker.pinned)
+    {
+      set_current_thread_affinity(worker.affinity);
+    }
+
+    for (;;)
+    {
+      auto ptr_task = this->find_task(index);
+
+      for (int i = 0; ptr_task == nullptr && i < SPIN_ROUNDS; i++)
+      {
+        std::this_thread::yield();
+        ptr_task = this->find_task(index);
+      }
+
+      // the idle time is counted from the end of the spinning, the clock is read only when
+      // the worker goes to sleep so the spinning between the short bursts costs nothing
+
+      if (ptr_task == nullptr)
+      {
+        const auto idle_started = ThreadPoolCounters::now();
+
+        worker.active.store(false, std::memory_order_relaxed);
+        ptr_task = this->sleep(index);
+        worker.active.store(true, std::memory_order_relaxed);
+
+        worker.counters.add(worker.counters.idle_time, uint64(ThreadPoolCounters::now() - idle_started));
+      }
+
+      if (ptr_task == nullptr) // stopping
+      {
+        break;
+      }
+
+      this->run(ptr_task, worker.counters);
+    }
+
+    t_ptr_ws_pool = nullptr;
+  }
+
+  WSTask* find_task(const size_t index)
+  {
+    auto& worker = *m_workers[index];
+
+    auto ptr_task = worker.deque.pop();
+    if (ptr_task != nullptr)
+    {
+      return ptr_task;
+    }
+
+    return this->find_shared_task(worker.node, index, worker.seed, worker.counters);
+  }
+
+  // the injection queue then the deques of each node, starting at the node `first`
+
+  WSTask* find_shared_task(const size_t first, const size_t index, uint32& seed, ThreadPoolCounters& counters)
+  {
+    const auto n = m_nodes.size();
+
+    for (size_t i = 0; i < n; i++)
+    {
+      auto& node = *m_nodes[(first + i) % n];
+
+      auto ptr_task = node.injection.pop();
+      if (ptr_task == nullptr)
+      {
+        ptr_task = this->steal_task(node.workers, index, seed, counters);
+      }
+
+      if (ptr_task != nullptr)
+      {
+        return ptr_task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  // steal from the victims except the worker `index`, starting at a random victim
+
+  WSTask* steal_task(const std::vector<size_t>& victims, const size_t index, uint32& seed, ThreadPoolCounters& counters)
+  {
+    WSTask* ptr_task = nullptr;
+
+    const auto n = victims.size();
+    if (n == 0 || (n == 1 && victims[0] == index))
+    {
+      return nullptr;
+    }
+
+    auto& x = seed; // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    const size_t start = x % n;
+
+    for (size_t i = 0; i < n; i++)
+    {
+      const auto victim = victims[(start + i) % n];
+      if (victim == index)
+      {
+        continue;
+      }
+
+      WSDeque::steal_result result;
+
+      do
+      {
+        result = m_workers[victim]->deque.steal(ptr_task);
+      } while (result == WSDeque::SR_ABORT);
+
+      if (result == WSDeque::SR_OK)
+      {
+        counters.add(counters.steals);
+        return ptr_task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  WSTask* sleep(const size_t index)
+  {
+    std::unique_lock<std::mutex> lk(m_sleep_mutex);
+
+    while (!m_stopping.load(std::memory_order_relaxed))
+    {
+      m_sleepers.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      auto ptr_task = this->find_task(index);
+      if (ptr_task == nullptr && this->injection_empty())
+      {
+        const auto epoch = m_epoch;
+        m_sleep_cv.wait(lk, [&]() { return m_epoch != epoch; });
+      }
+
+      m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+      if (ptr_task != nullptr)
+      {
+        return ptr_task;
+      }
+
+      lk.unlock();
+      ptr_task = this->find_task(index);
+      lk.lock();
+
+      if (ptr_task != nullptr)
+      {
+        return ptr_task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  void run(WSTask* ptr_task, ThreadPoolCounters& counters)
+  {
+    if (ptr_task->enqueued != 0)
+    {
+      const auto started = ThreadPoolCounters::now();
+      counters.add_time(counters.queue_wait_histogram, started - ptr_task->enqueued);
+      ptr_task->fn();
+      counters.add_time(counters.run_time_histogram, ThreadPoolCounters::now() - started);
+    }
+    else
+    {
+      ptr_task->fn();
+    }
+
+    delete ptr_task;
+    counters.add(counters.tasks_completed);
+
+    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      std::lock_guard<std::mutex> lg(m_done_mutex);
+      m_done_cv.notify_all();
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<WorkerData>> m_workers;
+  std::vector<std::unique_ptr<NodeData>> m_nodes;
+  bool m_numa_sub_pools;
+  ThreadPoolCounters m_external_counters; // of the threads outside of the pool
+  std::atomic<bool> m_timing;
+
+  std::atomic<size_t> m_pending;
+  std::atomic<size_t> m_sleepers;
+  std::atomic<bool> m_stopping;
+
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_sleep_cv;
+  size_t m_epoch;
+
+  std::mutex m_done_mutex;
+  std::condition_variable m_done_cv;
+};
+
+ThreadPoolImpl* create_work_stealing_pool(const ThreadPoolOptions& options)
+{
+  return new WorkStealingPool(options);
+}
+
+} // namespace vu